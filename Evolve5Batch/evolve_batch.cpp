@@ -13,6 +13,8 @@
  *
  * 'k'		KFORTH Interpreter Mode
  *
+ * 'kb'		KFORTH microbenchmarks
+ *
  * '='		Compare two sim files (used for debugging)
  *
  * 'rc'		Pick Random Creature (output in ASCII format)
@@ -20,6 +22,15 @@
  * '1s'		Simulate until 1 strain left. print strain that wins and
  *		in how many steps. Also write results to another file.
  *
+ * 'tour'	Tournament, play every pair of seed programs against each other
+ *
+ * 'prof'	Profile KFORTH opcodes while simulating
+ *
+ * 'bench'	Run the built-in benchmarks
+
+ *
+ * 'kc'		KFORTH compiler benchmark
+ *
  * --------------------------------------------------------------------------------------
  * SIMULATING:
  *	evolve_batch s 24h infile.evolve outfile.evolve		<- hours
@@ -29,6 +40,38 @@
  *
  * It is okay for infile and outfile to be the same filename.
  *
+ * An optional metrics file can follow the output file (for 's' and 'sf'):
+ *
+ *	evolve_batch s 24h infile.evolve outfile.evolve metrics.txt
+ *
+ * Each time a status line is printed (and after each checkpoint is written)
+ * a line of name=value pairs is appended to metrics.txt. It says how many
+ * nanoseconds were spent in each phase: executing instructions,
+ * Kill_Dead_Cells, Kill_Organism, mutating offspring, and reading/writing
+ * the simulation file. On Linux, cycles, last level cache misses and branch
+ * misses are given for each phase too, when perf_event_open() allows it.
+ * All values are totals since the program started.
+ *
+ * --------------------------------------------------------------------------------------
+ * STOP AND TRIGGER CONDITIONS ('s' and 'sf'):
+ *	evolve_batch sf 1h in.txt out.txt --stop-if "NUM-ORGANISMS 0 ="
+ *	evolve_batch sf 1h in.txt out.txt --check-every 100000 --checkpoint-if "1 STRAIN-POP 0 ="
+ *	evolve_batch s 1000000u in.txt out.txt --dump-if "NUM-CELLS 30 >"
+ *
+ * The conditions are find expressions (see organism_finder.cpp), checked every
+ * N steps (--check-every N, default 10000). Besides the find instructions they
+ * can use STEP, MEGA-STEP, UNIVERSE-AGE, NUM-ORGANISMS, STRAIN-POP, NUM-STRAINS
+ * and TOTAL-ENERGY.
+ *
+ *	--stop-if "expr"		the expression is true for the universe: write the
+ *					checkpoint and quit (before the time-spec is up)
+ *	--checkpoint-if "expr"	the expression becomes true for the universe: write a
+ *					checkpoint (only again after it has been false)
+ *	--dump-if "expr"		print every organism the expression is true for (in
+ *					the same format as 'rc'), at every check
+ *
+ * For example "NUM-STRAINS 1 =" (one strain is left) or "MAX-NUM-CELLS 50 >".
+ *
  * --------------------------------------------------------------------------------------
  * TERRAIN
  *	I used evolve_batch to house the interface to image2terrain(). It reads
@@ -62,6 +105,19 @@
  * For example:
  *		{ 100 400 + print }	; will print 500 to stdout
  *
+ * --------------------------------------------------------------------------------------
+ * KFORTH MICROBENCHMARKS:
+ *	evolve_batch kb				<- time every CORE instruction, and the vision/movement instructions
+ *	evolve_batch kb myprogram.kf		<- time myprogram.kf (CORE instructions only)
+ *	evolve_batch kb myprogram.kf u		<- time myprogram.kf as an organism in a small canned universe
+ *
+ * Prints one line per benchmark, for example:
+ *
+ *	op=+ set=core in=2 out=1 ns=3.10 net_ns=0.85 ci95=0.02 trials=11 iterations=2097152
+ *
+ * 'ns' is the median time per instruction, 'ci95' is the 95% confidence
+ * interval of the mean, and 'net_ns' is 'ns' minus the time of 'nop'.
+ *
  * ----------------------------------------------------------------------
  * PICK RANDOM CREATURE:
  *	evolve_batch rc somefile.evolve 350 350	100 <- will pick random creature near (350,350)
@@ -70,16 +126,21 @@
  * Extracts a random creature from the simulation file and prints out its data.
  *
  * You can pick a creature from the entire file, or from a smaller region
+ * (a square with sides of 2*radius+1, the radius defaults to 100). Every
+ * organism with a cell in the region is equally likely to be picked, no
+ * matter how many cells it has.
  *
  * The creature DNA is written to stdout
  * (meta data for creature is stored as comments)
  *
  * ----------------------------------------------------------------------
  * SIMULATE UNTIL ONE STRAIN LEFT
- *	evolve_batch 1s infile.evolve  outfile.evolve
+ *	evolve_batch 1s infile.evolve  outfile.evolve [5000000u]
  *
  * Simulate steps until the simulation consist of just 1 strain. Print out
  * the strain and the number of steps it took for this state to be reached.
+ * The optional step limit stops the simulation after 5000000 steps, like
+ * a 'tour' match.
  *
  * Output:
  *	2 120592
@@ -89,6 +150,86 @@
  * Special conditions:
  *	0 0	if no creatures alive to start with
  *	s 0	if only 1 strain to start with 's' is that strain
+ *	-1 n	if the last strains all died out together after n steps,
+ *		or no strain had won when the step limit n was reached
+ *
+ * The universe at the end is written to outfile.evolve.
+ *
+ * ----------------------------------------------------------------------
+ * TOURNAMENT
+ *	evolve_batch tour template.evolve 5000000u 4 a.kf b.kf c.kf
+ *
+ * Plays every pair of seed programs against each other, 4 times each,
+ * like '1s' does, and prints a win matrix. A match ends when one strain is
+ * left, or after 5000000 steps (a draw).
+ *
+ * template.evolve supplies everything else: the size of the universe,
+ * the simulation options, the barriers, and the strain 0 settings (strain
+ * options, mutation options, instruction set, and the population and energy
+ * of its strain 0 organisms). Both players get the strain 0 settings.
+ * Match 'k' of a pair uses the template's seed plus 'k', and the
+ * players swap starting places on odd 'k'.
+ *
+ * Seed files are compiled once. The universes are made in memory and
+ * the matches run on all cores. Nothing is written to disk.
+ *
+ * Output (one line per match, then the matrix):
+ *	match a.kf b.kf seed=0 winner=a.kf steps=1203311
+ *	...
+ *	       a.kf   b.kf   c.kf  wins
+ *	a.kf      -      3      4     7
+ *	b.kf      1      -      2     3
+ *	c.kf      0      1      -     1
+ *	draws 1
+ *
+ * Row 'a.kf' column 'b.kf' is the number of times a.kf beat b.kf.
+ *
+ * ----------------------------------------------------------------------
+ * PROFILE KFORTH OPCODES
+ *	evolve_batch prof 1000000u infile.evolve
+ *
+ * Simulate for <time-spec> (same as 's' mode) and print, for each enabled
+ * strain, how many times each opcode ran, how many cpu ticks it used,
+ * and how many times it was skipped because the data stack had too
+ * few arguments. The simulation file is not modified.
+ *
+ * The profiler must be compiled in, by building with -DKFORTH_PROFILER.
+ *
+ * ----------------------------------------------------------------------
+ * BENCHMARKS
+ *	evolve_batch bench			<- scratch files go in the current directory
+ *	evolve_batch bench /tmp
+ *
+ * Creates a fixed set of universes (fixed seeds; sparse and dense; one
+ * and several strains), simulates each one for a fixed number of steps,
+ * then writes and reads it as a checkpoint. One line per case is printed:
+ *
+ *	bench=sparse-1 width=700 height=600 strains=1 steps=20000000 seconds=1.520
+ *		steps_per_sec=1315789 instructions_per_sec=1298000 births_per_sec=410.5
+ *		peak_rss_kb=10240 checkpoint_bytes=345678 write_mb_per_sec=55.10
+ *		read_mb_per_sec=40.22 organisms=120 check_sum=4711
+ *
+ * (all on one line). peak_rss_kb is for the whole process so far. Save the
+ * output and compare later runs on the same machine against it. 'organisms'
+ * and 'check_sum' should never change unless the simulation rules change.
+ *
+ * ----------------------------------------------------------------------
+ * COMPILER BENCHMARK
+ *	evolve_batch kc /Applications/Evolve.app/Contents/Resources
+ *
+ * Compiles the default seed files (the ones the application's first time
+ * strain profiles use: seed.kf, shoot3.kf, utank.kf, ...) found in the
+ * given directory. Each seed is compiled over and over for 1 second with its
+ * profile's instruction set, then all of them are compiled again from
+ * several threads at once:
+ *
+ *	profile="Default" seed=.../seed.kf bytes=1234 instructions=200 blocks=9
+ *		programs=81000 seconds=1.000 programs_per_sec=81000 mb_per_sec=95.31
+ *	...
+ *	threads=8 seeds=8 programs=128000 seconds=0.410 programs_per_sec=312195 mismatches=0
+ *
+ * 'mismatches' counts programs from the threads that were not the same as
+ * the program compiled by itself. It should always be 0.
  *
  */
 
@@ -104,6 +245,13 @@
 #include <errno.h>
 #include <string.h>
 #include <time.h>
+#include <stdarg.h>
+#include <thread>
+#include <atomic>
+
+#ifndef __windows__
+#include <sys/resource.h>
+#endif
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -113,7 +261,11 @@
 #define CALLOC(n,s)	calloc(n,s)
 #define REALLOC(p,s)	realloc(p,s)
 #define FREE(x)		free(x)
+#ifdef __windows__
 #define STRDUP(x)	_strdup(x)
+#else
+#define STRDUP(x)	strdup(x)
+#endif
 
 /*
  * Return a timestamp in seconds, the
@@ -131,6 +283,23 @@ static long time_stamp(void)
 #endif
 }
 
+/*
+ * Return a timestamp in seconds with sub-second
+ * resolution, for measuring short intervals.
+ *
+ */
+static double wall_clock(void)
+{
+#ifdef __windows__
+	return (double) GetTickCount() / 1000.0;
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec + (double) ts.tv_nsec / 1.0e9;
+#endif
+}
+
 static void time_stamp_str(char* timebuf)
 {
 	time_t curtime;
@@ -166,39 +335,34 @@ extern "C" {
 
 //////////////////////////////////////////////////////////////////////
 
-/*
- * Compute a wacky checksum value for a universe
- * Allows us to compare files to ensure they are
- * the same.
- */
-static int check_sum(UNIVERSE *u)
+static void check_sum_rows(UNIVERSE *u, int y1, int y2, void *acc, void *arg)
 {
 	int x, y;
 	UNIVERSE_GRID ugrid;
 	int i, d;
-	KFORTH_INTEGER value;
+	int value;
+	uint32_t *sum;
 
-	ASSERT( u != NULL );
+	sum = (uint32_t *) acc;
 
-	value = 0;
-	for(x=0; x < u->width; x++) {
-		for(y=0; y < u->height; y++) {
+	for(y=y1; y < y2; y++) {
+		for(x=0; x < u->width; x++) {
 			Universe_Query(u, x, y, &ugrid);
 			switch(ugrid.type) {
 			case GT_BLANK:
-				value += (x+y) * 5;
+				value = (x+y) * 5;
 				break;
 
 			case GT_BARRIER:
-				value += (x+y) * 12;
+				value = (x+y) * 12;
 				break;
 
 			case GT_ORGANIC:
-				value += (x+y) * 7 + ugrid.u.energy;
+				value = (x+y) * 7 + ugrid.u.energy;
 				break;
 
 			case GT_CELL:
-				value += (x+y) * ugrid.u.cell->organism->energy;
+				value = (x+y) * ugrid.u.cell->organism->energy;
 				i = 7;
 				for(d=0; d < ugrid.u.cell->kfm.dsp; d++) {
 					value += ugrid.u.cell->kfm.data_stack[d] * i;
@@ -207,17 +371,43 @@ static int check_sum(UNIVERSE *u)
 				break;
 
 			case GT_SPORE:
-				value += (x+y) * ugrid.u.spore->energy;
+				value = (x+y) * ugrid.u.spore->energy;
 				break;
 
 			default:
 				ASSERT(0);
 			}
 
-			value = value & 0x00FFFFFF;
+			*sum += (uint32_t) value;
 		}
 	}
+}
+
+static void check_sum_merge(void *acc, void *part, void *arg)
+{
+	*(uint32_t *) acc += *(uint32_t *) part;
+}
+
+/*
+ * Compute a wacky checksum value for a universe
+ * Allows us to compare files to ensure they are
+ * the same.
+ *
+ * The checksum is the sum of a value for each square, kept in a
+ * KFORTH_INTEGER. Only the low bits of the sum survive, so the
+ * squares can be added up in any order (and in parallel).
+ */
+static int check_sum(UNIVERSE *u)
+{
+	uint32_t sum;
+	KFORTH_INTEGER value;
+
+	ASSERT( u != NULL );
+
+	sum = 0;
+	Grid_Reduce(u, check_sum_rows, check_sum_merge, &sum, sizeof(sum), NULL);
 
+	value = (KFORTH_INTEGER) sum;
 	value = value & 0x00FFFFFF;
 
 	return (int)value;
@@ -282,11 +472,17 @@ static void usage(const char *s)
 	printf("\n");
 	printf("Usage:\n");
 
-	printf("       evolve_batch s <time-spec> <infile.evolve> <outfile.evolve>\n");
+	printf("       evolve_batch s <time-spec> <infile.evolve> <outfile.evolve> [metrics.txt] [--verify-every N] [conditions]\n");
 	printf("\n");
 
-	printf("       evolve_batch sf <time-spec> <infile.evolve> <outfile.evolve>\n");
+	printf("       evolve_batch sf <time-spec> <infile.evolve> <outfile.evolve> [metrics.txt] [--verify-every N] [--delta N]\n");
 	printf("            (simulate forever, check-pointing every <time-spec> intervals)\n");
+	printf("            (--verify-every N prints the universe hash every N steps)\n");
+	printf("            (--delta N makes every Nth checkpoint a full one, the others only have changed tiles, N <= %d)\n", EVOLVE_MAX_DELTA_EVERY);
+	printf("\n");
+
+	printf("            conditions: [--check-every N] [--stop-if \"expr\"] [--checkpoint-if \"expr\"] [--dump-if \"expr\"]\n");
+	printf("            (find expressions checked every N steps, to stop, checkpoint, or print matching organisms)\n");
 	printf("\n");
 
 	printf("       evolve_batch t <infile.png> min max <outfile.txt>\n");
@@ -302,10 +498,36 @@ static void usage(const char *s)
 	printf("       evolve_batch = <file1.evolve> <file2.evolve>\n");
 	printf("\n");
 
-	printf("       evolve_batch rc <file.evolve> [x y]\n");
+	printf("       evolve_batch rc <file.evolve> [x y [radius]]\n");
+	printf("            (print a random creature, optionally one near x y)\n");
+	printf("\n");
+
+	printf("       evolve_batch 1s <infile.evolve> <outfile.evolve> [<max-steps>u]\n");
+	printf("            (simulate until 1 strain is left, or for at most max-steps, print the strain and number of steps)\n");
+	printf("\n");
+
+	printf("       evolve_batch tour <template.evolve> <max-steps>u <N> <seed1.kf> <seed2.kf> ...\n");
+	printf("            (play every pair of seeds N times, print a win matrix)\n");
+	printf("\n");
+
+	printf("       evolve_batch kb [<kforth_file> [u]]\n");
+	printf("            (KFORTH microbenchmarks)\n");
+	printf("\n");
+
+	printf("       evolve_batch bench [scratch-dir]\n");
+	printf("            (run the built-in benchmarks)\n");
+	printf("\n");
+
+	printf("       evolve_batch kc <seed-dir>\n");
+	printf("            (KFORTH compiler benchmark, using the default seed files in <seed-dir>)\n");
+	printf("\n");
+
+	printf("       evolve_batch bisect <infile.evolve> <evolve_batch_a> <evolve_batch_b> <steps>u [scratch-dir]\n");
+	printf("            (find the first step where two builds of evolve_batch diverge)\n");
 	printf("\n");
 
-	printf("       evolve_batch 1s <infile.evolve> <outfile.evolve>\n");
+	printf("       evolve_batch prof <time-spec> <infile.evolve>\n");
+	printf("            (print per-opcode profile, needs a -DKFORTH_PROFILER build)\n");
 	printf("\n");
 	
 	printf("VERSION: %s\n", Evolve_Version());
@@ -395,7 +617,7 @@ static void kforth_interpreter(FILE *fp, const char *filename)
 	kfm = kforth_machine_make();
 
 	while( ! kforth_machine_terminated(kfm) ) {
-		kforth_machine_execute(kfops, kfp, kfm, NULL);
+		kforth_machine_run(kfops, kfp, kfm, NULL, 100000);
 	}
 
 	/*
@@ -410,228 +632,2205 @@ static void kforth_interpreter(FILE *fp, const char *filename)
 	kforth_ops_delete(kfops);
 }
 
-static void print_information(char *filename)
+/***********************************************************************
+ * KFORTH MICROBENCHMARKS
+ *
+ * Time single KFORTH instructions (or a whole snippet) by calling
+ * kforth_machine_execute() millions of times.
+ *
+ * Stock benchmarks: every instruction in kforth_ops_init() is run
+ * by itself from the program "main: { OP } b1: { nop nop nop }". Before
+ * each step the machine is put back to the same state: pc at OP, empty
+ * call stack, and OP's inputs (all 1's) on the data stack. So the time
+ * includes fetch, decode, the stack guard and the instruction itself,
+ * plus that small restore. The 'nop' row shows the fixed part, and
+ * 'net_ns' is a row's time minus the 'nop' time.
+ *
+ * The vision and movement cell instructions are run the same way, as
+ * cell instructions of an organism in a small canned universe (see
+ * kb_make_fixture). Their first argument flips sign on every step
+ * (1 0 OMOVE, -1 0 OMOVE, ...) so that moving instructions go back and
+ * forth instead of wandering off.
+ *
+ * Each benchmark is repeated KB_TRIALS times. The iteration count is
+ * doubled until one trial takes at least KB_TRIAL_SECONDS. We print the
+ * median, and the 95% confidence interval of the mean.
+ *
+ * Short trials are easily upset by an interrupt or a context switch. When
+ * the confidence interval is more than KB_CI95_LIMIT of the mean, the trials
+ * are made twice as long and repeated (up to KB_MAX_TRIAL_SECONDS per trial).
+ *
+ */
+#define KB_TRIALS			11
+#define KB_T95				2.228		/* student's t, 95% two sided, KB_TRIALS-1 degrees of freedom */
+#define KB_TRIAL_SECONDS	0.01
+#define KB_MAX_TRIAL_SECONDS	0.5
+#define KB_CI95_LIMIT		0.10		/* largest acceptable ci95, as a fraction of the mean */
+#define KB_MAX_ARGS			8
+
+typedef struct {
+	KFORTH_OPERATIONS	*kfops;
+	KFORTH_PROGRAM		*kfp;
+	KFORTH_MACHINE		*kfm;			// the machine being stepped
+	UNIVERSE			*u;				// canned universe, or NULL for core instructions
+	CELL				*cell;			// the cell being stepped, when 'u' is set
+	int					single;			// restore the machine before each step (otherwise run the snippet over and over)
+	int					nargs;
+	int					alternate;		// flip the sign of the first argument each step
+	LONG_LONG			steps;			// instructions executed
+} KB_RUN;
+
+typedef struct {
+	double	median;
+	double	mean;
+	double	ci95;
+	LONG_LONG	iterations;
+} KB_RESULT;
+
+static const char *kb_cell_opcodes[] = {
+	"LOOK", "NEAREST", "FARTHEST", "SIZE", "BIGGEST", "SMALLEST",
+	"TEMPERATURE", "HOTTEST", "COLDEST", "SMELL", "GPS",
+	"NEIGHBORS", "HAS-NEIGHBOR",
+	"OMOVE", "CMOVE", "ROTATE",
+	"nop",
+	NULL
+};
+
+/*
+ * Execute one instruction (single mode), or one instruction of the
+ * snippet, starting it over when it finishes.
+ */
+static inline void kb_step(KB_RUN *kr, LONG_LONG i)
 {
-	UNIVERSE *u;
-	char errbuf[1000];
+	KFORTH_MACHINE *kfm;
+	int a;
 
-	ASSERT( filename != NULL );
+	kfm = kr->kfm;
 
-	u = Universe_Read(filename, errbuf);
-	if( u == NULL ) {
-		usage(errbuf);
-		exit(1);
+	if( kr->u != NULL && kforth_machine_terminated(kfm) ) {
+		// the cell is started again below, so it no longer counts as dead
+		kr->cell->organism->ndead -= 1;
 	}
 
-	print_info(filename, u);
+	if( kr->single ) {
+		kfm->loc.cb = 0;
+		kfm->loc.pc = 0;
+		kfm->csp = 0;
+		for(a=0; a < kr->nargs; a++)
+			kfm->data_stack[a] = 1;
+		if( kr->alternate && kr->nargs > 0 ) {
+			kfm->data_stack[0] = (i & 1) ? -1 : 1;
+			for(a=1; a < kr->nargs; a++)
+				kfm->data_stack[a] = 0;
+		}
+		kfm->dsp = kr->nargs;
 
-	Universe_Delete(u);
+	} else if( kforth_machine_terminated(kfm) ) {
+		kforth_machine_reset(kfm);
+	}
+
+	if( kr->u != NULL ) {
+		kr->u->current_cell = kr->cell;
+		Universe_Execute_Cell(kr->u, kr->cell);
+	} else {
+		kforth_machine_execute(kr->kfops, kr->kfp, kfm, NULL);
+	}
+	kr->steps += 1;
 }
 
-enum { SM_TIME, SM_STEP, SM_AGE };
+static double kb_trial(KB_RUN *kr, LONG_LONG iterations)
+{
+	LONG_LONG i;
+	double t0;
+
+	t0 = wall_clock();
+	for(i=0; i < iterations; i++)
+		kb_step(kr, i);
+
+	return wall_clock() - t0;
+}
+
+static int kb_compare(const void *a, const void *b)
+{
+	double x = *(const double *) a;
+	double y = *(const double *) b;
+
+	return (x < y) ? -1 : (x > y) ? 1 : 0;
+}
 
 /*
- * Simulate about 1000 steps, then print status.
- * If 'end_step' >= 0, then stop simulating when we reach this step.
- *
+ * Measure nanoseconds per instruction for 'kr'.
  */
-static void simulate_chunk(UNIVERSE *u, int step_mode, LONG_LONG end_val)
+static void kb_measure(KB_RUN *kr, double trial_seconds, KB_RESULT *kbr)
 {
-	long long end_age;
-	long long start_births, start_deaths;
-	int oenergy = 0;
-	int ncells = 0;
-	ORGANISM *o;
+	double ns[KB_TRIALS];
+	double sum, var;
+	LONG_LONG iterations;
+	int t;
 
-	ASSERT( u != NULL );
-	
-	start_births = u->nborn;
-	start_deaths = u->ndie;
+	iterations = 1024;
+	while( kb_trial(kr, iterations) < trial_seconds )
+		iterations *= 2;
 
-	end_age = u->age + 1000;
-	while( u->age < end_age ) {
-		if( step_mode == SM_STEP ) {
-			if( u->step >= end_val )
-				break;
-		} else if( step_mode == SM_AGE ) {
-			if( u->age >= end_val )
-				break;
+	for(;;) {
+		sum = 0.0;
+		for(t=0; t < KB_TRIALS; t++) {
+			ns[t] = kb_trial(kr, iterations) * 1.0e9 / (double) iterations;
+			sum += ns[t];
 		}
-		Universe_Simulate(u);
-	}
-	
-	for(o=u->organisms; o; o=o->next) {
-		ncells += o->ncells;
-		oenergy += o->energy;
+
+		kbr->mean = sum / KB_TRIALS;
+
+		var = 0.0;
+		for(t=0; t < KB_TRIALS; t++)
+			var += (ns[t] - kbr->mean) * (ns[t] - kbr->mean);
+		var = var / (KB_TRIALS - 1);
+
+		kbr->ci95 = KB_T95 * sqrt(var / KB_TRIALS);
+
+		if( kbr->ci95 <= KB_CI95_LIMIT * kbr->mean )
+			break;
+
+		if( trial_seconds * 2 > KB_MAX_TRIAL_SECONDS )
+			break;
+
+		trial_seconds *= 2;
+		iterations *= 2;
 	}
 
-	printf("Age: %lld, Step: %lld, Organisms: %4d, Cells: %d, Energy: %d, Born: %lld, Died: %lld (%+lld)\n",
-					u->age, u->step, u->norganism, ncells, oenergy, u->nborn,
-		 			  	u->ndie, (u->ndie - start_deaths));
+	qsort(ns, KB_TRIALS, sizeof(double), kb_compare);
+	kbr->median = ns[KB_TRIALS/2];
+	kbr->iterations = iterations;
 }
 
-static void do_simulate(int forever, char *time_spec, char *in_filename, char *out_filename)
+/*
+ * A small universe for the cell instructions: strain 0 uses the
+ * EvolveOperations() instruction set, and the organism running
+ * 'program_text' sits at the center (32,32) of a 64x64 grid.
+ *
+ * Around it are a square of barrier at distance 12, a fixed scatter of
+ * organic, a second organism at (36,32) and an odor gradient. The squares
+ * next to the center are left blank so movement is never blocked.
+ *
+ */
+static UNIVERSE *kb_make_fixture(const char *program_text, CELL **cellp, char *errbuf)
 {
-	char errbuf[1000];
-	int value, tspec;
-	char unit;
-	const char *unit_desc;
-	int result;
 	UNIVERSE *u;
-	LONG_LONG start_val, end_val;
-	long start_seconds, end_seconds = 0, now;
-	int step_mode;
-	char nowbuf[100];
-	
+	ORGANISM *o, *o2;
+	int x, y, dx, dy, d;
+
+	u = Universe_Make(4242, 64, 64);
+
+	u->kfops[0] = *EvolveOperations();
+	kforth_mutate_options_defaults(&u->kfmo[0]);
+	StrainOptions_Init(&u->strop[0]);
+	u->strop[0].enabled = 1;
+	strcpy(u->strop[0].name, "kbench");
+	EvolveOperations_Specialize(&u->kfops[0], &u->strop[0]);
+
+	for(y=0; y < u->height; y++) {
+		for(x=0; x < u->width; x++) {
+			dx = x - 32;
+			dy = y - 32;
+			d = (abs(dx) > abs(dy)) ? abs(dx) : abs(dy);
+
+			Grid_SetOdor(u, x, y, (KFORTH_INTEGER) (x + y));
+
+			if( d == 12 ) {
+				Grid_SetBarrier(u, x, y);
+			} else if( d > 2 && d < 12 && (x*7 + y*13) % 11 == 0 ) {
+				Grid_SetOrganic(u, x, y, 100);
+			}
+		}
+	}
 
-	ASSERT( time_spec != NULL );
-	ASSERT( in_filename != NULL );
-	ASSERT( out_filename != NULL );
+	o2 = Organism_Make(36, 32, 0, 1000, &u->kfops[0], 0, "main: { }", errbuf);
+	if( o2 == NULL ) {
+		Universe_Delete(u);
+		return NULL;
+	}
+	Universe_PasteOrganism(u, o2);
 
-	tspec = atoi(time_spec);
+	o = Organism_Make(32, 32, 0, 1000000, &u->kfops[0], 0, program_text, errbuf);
+	if( o == NULL ) {
+		Universe_Delete(u);
+		return NULL;
+	}
+	Universe_PasteOrganism(u, o);
 
-	unit = time_spec[ strlen(time_spec)-1 ];
+	Universe_ClearSelectedOrganism(u);
 
-	switch( unit ) {
-	case 'h':
-		step_mode = SM_TIME;
-		unit_desc = "hours";
-		value = tspec * 60 * 60;
-		break;
+	*cellp = o->cells;
+	return u;
+}
 
-	case 'm':
-		step_mode = SM_TIME;
-		unit_desc = "minutes";
-		value = tspec * 60;
-		break;
+static void kb_print(const char *set, const char *name, int in, int out, KB_RESULT *kbr, double nop_ns)
+{
+	printf("op=%s set=%s in=%d out=%d ns=%.2f net_ns=%.2f ci95=%.2f trials=%d iterations=%lld\n",
+		name, set, in, out, kbr->median, kbr->median - nop_ns, kbr->ci95, KB_TRIALS, (long long) kbr->iterations);
+	fflush(stdout);
+}
 
-	case 's':
-		step_mode = SM_TIME;
-		unit_desc = "seconds";
-		value = tspec * 1;
-		break;
+/*
+ * Time opcode 'name' by itself, in the canned universe if 'want_universe'.
+ * Returns 0 if the opcode could not be compiled.
+ */
+static int kb_opcode(KFORTH_OPERATIONS *kfops, const char *name, int want_universe, KB_RESULT *kbr, int *in, int *out)
+{
+	char program_text[200];
+	char errbuf[1000];
+	KB_RUN kr;
+	KFORTH_OPERATION *kfop;
+	int opcode;
 
-	case 'u':
-		step_mode = SM_STEP;
-		unit_desc = "steps";
-		value = tspec * 1;
-		break;
+	opcode = kforth_ops_find(kfops, name);
+	if( opcode < 0 )
+		return 0;
 
-	case 'a':
-		step_mode = SM_AGE;
-		unit_desc = "ages";
-		value = tspec * 1;
-		break;
-		
-	default:
-		usage("Time spec unit must be 'h', 'm', 's', 'u' or 'a'.");
-		exit(1);
+	kfop = kforth_ops_get(kfops, opcode);
+	if( kfop->in > KB_MAX_ARGS )
+		return 0;
+
+	snprintf(program_text, sizeof(program_text), "main: { %s } b1: { nop nop nop }", name);
+
+	memset(&kr, 0, sizeof(kr));
+	kr.kfops = kfops;
+	kr.single = 1;
+	kr.nargs = kfop->in;
+
+	if( want_universe ) {
+		kr.u = kb_make_fixture(program_text, &kr.cell, errbuf);
+		if( kr.u == NULL )
+			return 0;
+		kr.kfm = &kr.cell->kfm;
+		kr.alternate = 1;
+	} else {
+		kr.kfp = kforth_compile(program_text, kfops, errbuf);
+		if( kr.kfp == NULL )
+			return 0;
+		kr.kfm = kforth_machine_make();
 	}
 
-	printf("Input:  %s\n", in_filename);
-	printf("Output: %s\n", out_filename);
-	if( forever ) {
-		printf("About to simulate universe for FOREVER.\n");
-		printf("Checkpoint interval is every %d %s.\n", tspec, unit_desc);
+	kb_measure(&kr, KB_TRIAL_SECONDS, kbr);
+	*in = kfop->in;
+	*out = kfop->out;
+
+	if( want_universe ) {
+		Universe_Delete(kr.u);
 	} else {
-		printf("About to simulate universe for %d %s...\n", tspec, unit_desc);
+		kforth_machine_delete(kr.kfm);
+		kforth_delete(kr.kfp);
 	}
 
-#if 0
-	/*
-	 * Test to make sure the output file can be created
-	 * It screws up my perl script so we dont do this test.
-	 */
+	return 1;
+}
+
+/*
+ * Run the stock microbenchmarks: every CORE instruction,
+ * then the vision and movement cell instructions.
+ */
+static void kforth_microbench_stock(void)
 {
-	FILE *fp;
-	fp = fopen(out_filename, "wb");
-	if( fp == NULL ) {
-		sprintf(errbuf, "unable to create/write to '%s'(%s)",
-					out_filename, strerror(errno));
-		usage(errbuf);
-		exit(1);
+	KFORTH_OPERATIONS *kfops;
+	KB_RESULT kbr;
+	double nop_ns;
+	int opcode, i, in, out;
+
+	kfops = kforth_ops_make();
+
+	nop_ns = 0.0;
+	if( kb_opcode(kfops, "nop", 0, &kbr, &in, &out) ) {
+		nop_ns = kbr.median;
 	}
-	fclose(fp);
-}
-#endif
 
-	/*
-	 * Okay here we go... Open input file for simulating
-	 *
-	 */
-	u = Universe_Read(in_filename, errbuf);
-	if( u == NULL ) {
-		usage(errbuf);
-		exit(1);
+	for(opcode=0; opcode < kfops->count; opcode++) {
+		if( ! kb_opcode(kfops, kfops->table[opcode].name, 0, &kbr, &in, &out) ) {
+			printf("op=%s set=core skipped=1\n", kfops->table[opcode].name);
+			continue;
+		}
+		kb_print("core", kfops->table[opcode].name, in, out, &kbr, nop_ns);
 	}
-	
-do {
-		
-	time_stamp_str(nowbuf);
 
-	printf("%s ---------- BEGIN ----------\n", nowbuf);
+	kforth_ops_delete(kfops);
 
-	if( step_mode == SM_STEP ) {
-		ASSERT( unit == 'u' );
+	kfops = EvolveOperations();
+
+	nop_ns = 0.0;
+	if( kb_opcode(kfops, "nop", 1, &kbr, &in, &out) ) {
+		nop_ns = kbr.median;
+	}
+
+	for(i=0; kb_cell_opcodes[i] != NULL; i++) {
+		if( ! kb_opcode(kfops, kb_cell_opcodes[i], 1, &kbr, &in, &out) ) {
+			printf("op=%s set=cell skipped=1\n", kb_cell_opcodes[i]);
+			continue;
+		}
+		kb_print("cell", kb_cell_opcodes[i], in, out, &kbr, nop_ns);
+	}
+}
+
+/*
+ * Time a whole snippet, run over and over. With 'want_universe' the snippet
+ * is the program of an organism in the canned universe and can use all
+ * the cell instructions, otherwise only the CORE instructions.
+ */
+static void kforth_microbench_snippet(FILE *fp, const char *filename, int want_universe)
+{
+	char program_text[100 * 1024];
+	char buf[1000];
+	char errbuf[1000];
+	KB_RUN kr;
+	KB_RESULT kbr;
+
+	program_text[0] = '\0';
+	while( fgets(buf, sizeof(buf), fp) != NULL ) {
+		strcat(program_text, buf);
+	}
+
+	memset(&kr, 0, sizeof(kr));
+	kr.single = 0;
+
+	if( want_universe ) {
+		kr.u = kb_make_fixture(program_text, &kr.cell, errbuf);
+		if( kr.u == NULL ) {
+			fprintf(stderr, "%s: %s\n", filename, errbuf);
+			exit(1);
+		}
+		kr.kfm = &kr.cell->kfm;
+	} else {
+		kr.kfops = kforth_ops_make();
+		kr.kfp = kforth_compile(program_text, kr.kfops, errbuf);
+		if( kr.kfp == NULL ) {
+			fprintf(stderr, "%s: %s\n", filename, errbuf);
+			exit(1);
+		}
+		kr.kfm = kforth_machine_make();
+	}
+
+	/*
+	 * longer trials, the snippet may take many steps per run
+	 */
+	kb_measure(&kr, KB_TRIAL_SECONDS * 4, &kbr);
+
+	printf("snippet=%s set=%s ns=%.2f ci95=%.2f trials=%d iterations=%lld\n",
+		filename, want_universe ? "cell" : "core",
+		kbr.median, kbr.ci95, KB_TRIALS, (long long) kbr.iterations);
+
+	if( want_universe ) {
+		Universe_Delete(kr.u);
+	} else {
+		kforth_machine_delete(kr.kfm);
+		kforth_delete(kr.kfp);
+		kforth_ops_delete(kr.kfops);
+	}
+}
+
+static void print_information(char *filename)
+{
+	UNIVERSE *u;
+	char errbuf[1000];
+
+	ASSERT( filename != NULL );
+
+	u = Universe_Read(filename, errbuf);
+	if( u == NULL ) {
+		usage(errbuf);
+		exit(1);
+	}
+
+	print_info(filename, u);
+
+	Universe_Delete(u);
+}
+
+enum { SM_TIME, SM_STEP, SM_AGE };
+
+/*
+ * Append one line of phase timings to the metrics file. The values
+ * are totals since the simulation started, as name=value pairs:
+ *
+ *	step=3000 age=1000 execute_calls=1 execute_ns=1500000 execute_cycles=... kill_dead_cells_calls=...
+ *
+ */
+static void write_metrics(FILE *fp, UNIVERSE *u)
+{
+	PHASE_TIMER *pt;
+	int phase, i;
+
+	ASSERT( fp != NULL );
+	ASSERT( u != NULL );
+	ASSERT( u->phase_timer != NULL );
+
+	pt = u->phase_timer;
+
+	fprintf(fp, "step=%lld age=%lld", (long long) u->step, (long long) u->age);
+
+	for(phase=0; phase < PHASE_COUNT; phase++) {
+		fprintf(fp, " %s_calls=%lld %s_ns=%lld",
+				Phase_Timer_Name(phase), (long long) pt->calls[phase],
+				Phase_Timer_Name(phase), (long long) pt->nsec[phase]);
+
+		if( pt->have_counters ) {
+			for(i=0; i < PHASE_NCOUNTERS; i++) {
+				fprintf(fp, " %s_%s=%lld",
+					Phase_Timer_Name(phase), Phase_Timer_Counter_Name(i),
+					(long long) pt->counter[phase][i]);
+			}
+		}
+	}
+
+	fprintf(fp, "\n");
+	fflush(fp);
+}
+
+/*
+ * Print the (step, hash) pair used to check that two runs
+ * are identical. See Universe_Hash().
+ */
+static void print_verify(UNIVERSE *u)
+{
+	ASSERT( u != NULL );
+
+	printf("Verify: step=%lld hash=%016llx\n", (long long) u->step, (unsigned long long) Universe_Hash(u));
+}
+
+/*
+ * The files of a delta checkpoint chain: 'out_filename' is the latest
+ * checkpoint, and 'files' are the older checkpoints it depends on.
+ */
+typedef struct {
+	int		delta_every;		// every Nth checkpoint is a full one
+	int		ncheckpoints;		// checkpoints written so far
+	LONG_LONG	last_step;		// step of the checkpoint in 'out_filename'
+	char	**files;
+	int		nfiles;
+} DELTA_CHAIN;
+
+static void delta_chain_remove(DELTA_CHAIN *dc)
+{
+	int i;
+
+	for(i=0; i < dc->nfiles; i++) {
+		remove(dc->files[i]);
+		FREE(dc->files[i]);
+	}
+	dc->nfiles = 0;
+}
+
+/*
+ * Write a checkpoint of 'u' to 'out_filename'. When 'dc' is not NULL, only
+ * every dc->delta_every'th checkpoint is a full one. The others are deltas:
+ * the previous checkpoint is renamed "<out_filename>-<step>.txt" and the new
+ * checkpoint only has the tiles that changed since then.
+ *
+ * The delta is written to "<out_filename>-tmp.txt" first, so 'out_filename'
+ * is only replaced once the write has succeeded.
+ */
+static int write_checkpoint(UNIVERSE *u, char *out_filename, DELTA_CHAIN *dc, char *errbuf)
+{
+	char prev_filename[1000], tmp_filename[1000];
+	const char *base;
+	int len, result;
+
+	if( dc == NULL )
+		return Universe_Write(u, out_filename, errbuf);
+
+	if( dc->ncheckpoints % dc->delta_every == 0 ) {
+		result = Universe_Write(u, out_filename, errbuf);
+		if( result )
+			delta_chain_remove(dc);
+
+	} else {
+		len = (int)strlen(out_filename);
+		if( len >= 4 && strcmp(out_filename + len - 4, ".txt") == 0 )
+			len -= 4;
+
+		snprintf(prev_filename, sizeof(prev_filename), "%.*s-%lld.txt", len, out_filename, (long long) dc->last_step);
+		snprintf(tmp_filename, sizeof(tmp_filename), "%.*s-tmp.txt", len, out_filename);
+
+		base = strrchr(prev_filename, '/');
+		base = (base == NULL) ? prev_filename : base+1;
+
+		result = Universe_WriteDelta(u, tmp_filename, base, dc->delta_every, errbuf);
+		if( ! result ) {
+			remove(tmp_filename);
+			return 0;
+		}
+
+		if( rename(out_filename, prev_filename) != 0 ) {
+			snprintf(errbuf, 1000, "%.900s: %s", prev_filename, strerror(errno));
+			remove(tmp_filename);
+			return 0;
+		}
+
+		if( rename(tmp_filename, out_filename) != 0 ) {
+			snprintf(errbuf, 1000, "%.900s: %s", out_filename, strerror(errno));
+			rename(prev_filename, out_filename);
+			remove(tmp_filename);
+			return 0;
+		}
+
+		dc->files[ dc->nfiles++ ] = STRDUP(prev_filename);
+	}
+
+	if( result ) {
+		dc->ncheckpoints++;
+		dc->last_step = u->step;
+		Universe_Clear_Dirty_Tiles(u);
+	}
+
+	return result;
+}
+
+#define TRIGGER_EVERY	10000
+
+/*
+ * The stop and trigger conditions of 's' and 'sf', checked every
+ * 'every' steps. A condition that wasn't given is NULL.
+ */
+typedef struct {
+	LONG_LONG		every;
+	ORGANISM_FINDER	*stop;				// --stop-if
+	ORGANISM_FINDER	*checkpoint;		// --checkpoint-if
+	ORGANISM_FINDER	*dump;				// --dump-if
+	int				checkpoint_was_true;
+	char			*out_filename;
+	DELTA_CHAIN		*dc;
+} TRIGGERS;
+
+static void rc_print(UNIVERSE *u, ORGANISM *o, const char *filename);
+
+/*
+ * Check the conditions in 'tr' and carry out their actions.
+ * Returns 1 if the stop condition is true.
+ */
+static int trigger_check(UNIVERSE *u, TRIGGERS *tr)
+{
+	char errbuf[1000];
+	ORGANISM **list;
+	int i, n, now;
+
+	ASSERT( u != NULL );
+	ASSERT( tr != NULL );
+
+	if( tr->dump != NULL ) {
+		list = OrganismFinder_select(tr->dump, u, &n);
+		if( n > 0 ) {
+			printf("Trigger: dump step=%lld organisms=%d\n", (long long) u->step, n);
+			for(i=0; i < n; i++) {
+				rc_print(u, list[i], tr->out_filename);
+			}
+		}
+		FREE(list);
+	}
+
+	if( tr->checkpoint != NULL ) {
+		now = OrganismFinder_test(tr->checkpoint, u);
+		if( now && ! tr->checkpoint_was_true ) {
+			printf("Trigger: checkpoint step=%lld\n", (long long) u->step);
+			if( write_checkpoint(u, tr->out_filename, tr->dc, errbuf) ) {
+				printf("Wrote %s.\n", tr->out_filename);
+			} else {
+				usage(errbuf);
+			}
+		}
+		tr->checkpoint_was_true = now;
+	}
+
+	if( tr->stop != NULL && OrganismFinder_test(tr->stop, u) ) {
+		printf("Trigger: stop step=%lld\n", (long long) u->step);
+		return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Simulate about 1000 steps, then print status.
+ * If 'end_step' >= 0, then stop simulating when we reach this step.
+ *
+ * If 'metrics_fp' is not NULL, the phase timings are appended to it.
+ *
+ * If 'verify_every' is > 0, the universe hash is printed whenever
+ * the step is a multiple of 'verify_every'.
+ *
+ * If 'tr' is not NULL its conditions are checked every tr->every steps.
+ * Returns 1 if the stop condition became true.
+ *
+ */
+static int simulate_chunk(UNIVERSE *u, int step_mode, LONG_LONG end_val, FILE *metrics_fp, LONG_LONG verify_every,
+						TRIGGERS *tr)
+{
+	long long end_age;
+	long long start_births, start_deaths;
+	int oenergy = 0;
+	int ncells = 0;
+	int stop = 0;
+	ORGANISM *o;
+
+	ASSERT( u != NULL );
+	
+	start_births = u->nborn;
+	start_deaths = u->ndie;
+
+	if( u->phase_timer != NULL )
+		Phase_Timer_Begin(u->phase_timer, PHASE_EXECUTE);
+
+	end_age = u->age + 1000;
+	while( u->age < end_age ) {
+		if( step_mode == SM_STEP ) {
+			if( u->step >= end_val )
+				break;
+		} else if( step_mode == SM_AGE ) {
+			if( u->age >= end_val )
+				break;
+		}
+		Universe_Simulate(u);
+
+		if( verify_every > 0 && u->step % verify_every == 0 )
+			print_verify(u);
+
+		if( tr != NULL && u->step % tr->every == 0 ) {
+			stop = trigger_check(u, tr);
+			if( stop )
+				break;
+		}
+	}
+
+	if( u->phase_timer != NULL )
+		Phase_Timer_End(u->phase_timer);
+	
+	for(o=u->organisms; o; o=o->next) {
+		ncells += o->ncells;
+		oenergy += o->energy;
+	}
+
+	printf("Age: %lld, Step: %lld, Organisms: %4d, Cells: %d, Energy: %d, Born: %lld, Died: %lld (%+lld)\n",
+					u->age, u->step, u->norganism, ncells, oenergy, u->nborn,
+		 			  	u->ndie, (u->ndie - start_deaths));
+
+	if( metrics_fp != NULL )
+		write_metrics(metrics_fp, u);
+
+	return stop;
+}
+
+/*
+ * A parsed <time-spec> argument, such as "24h" or "1000u".
+ */
+typedef struct {
+	int			step_mode;		// SM_TIME, SM_STEP or SM_AGE
+	int			tspec;			// the number part of the time spec
+	int			value;			// seconds, steps or ages
+	char		unit;
+	const char	*unit_desc;
+} TIME_SPEC;
+
+static int parse_time_spec(const char *time_spec, TIME_SPEC *ts)
+{
+	ASSERT( time_spec != NULL );
+	ASSERT( ts != NULL );
+
+	ts->tspec = atoi(time_spec);
+
+	ts->unit = time_spec[ strlen(time_spec)-1 ];
+
+	switch( ts->unit ) {
+	case 'h':
+		ts->step_mode = SM_TIME;
+		ts->unit_desc = "hours";
+		ts->value = ts->tspec * 60 * 60;
+		break;
+
+	case 'm':
+		ts->step_mode = SM_TIME;
+		ts->unit_desc = "minutes";
+		ts->value = ts->tspec * 60;
+		break;
+
+	case 's':
+		ts->step_mode = SM_TIME;
+		ts->unit_desc = "seconds";
+		ts->value = ts->tspec * 1;
+		break;
+
+	case 'u':
+		ts->step_mode = SM_STEP;
+		ts->unit_desc = "steps";
+		ts->value = ts->tspec * 1;
+		break;
+
+	case 'a':
+		ts->step_mode = SM_AGE;
+		ts->unit_desc = "ages";
+		ts->value = ts->tspec * 1;
+		break;
+		
+	default:
+		return 0;
+	}
+
+	return 1;
+}
+
+/*
+ * Simulate 'u' for the amount of time/steps/ages in 'ts',
+ * printing a status line every 1000 ages.
+ * Returns 1 if it ended early because the stop condition became true.
+ */
+static int simulate_for(UNIVERSE *u, TIME_SPEC *ts, FILE *metrics_fp, LONG_LONG verify_every, TRIGGERS *tr)
+{
+	LONG_LONG start_val, end_val;
+	long start_seconds, end_seconds = 0, now;
+
+	ASSERT( u != NULL );
+	ASSERT( ts != NULL );
+
+	if( ts->step_mode == SM_STEP ) {
+		ASSERT( ts->unit == 'u' );
 		start_val = u->step;
-		end_val = start_val + value;
-	} else if( step_mode == SM_AGE ) {
-		ASSERT( unit == 'a' );
+		end_val = start_val + ts->value;
+	} else if( ts->step_mode == SM_AGE ) {
+		ASSERT( ts->unit == 'a' );
 		start_val = u->age;
-		end_val = start_val + value;
+		end_val = start_val + ts->value;
 	} else {
-		ASSERT( step_mode == SM_TIME );
+		ASSERT( ts->step_mode == SM_TIME );
 		start_seconds = time_stamp();
-		end_seconds = start_seconds + value;
+		end_seconds = start_seconds + ts->value;
 		end_val = 0;
 	}
-	
-	for(;;) {
-		if( step_mode == SM_STEP ) {
-			if( u->step >= end_val ) {
-				break;
-			}
-		} else if( step_mode == SM_AGE ) {
-			if( u->age >= end_val ) {
-				break;
-			}
-		} else {
-			ASSERT( step_mode == SM_TIME );
+	
+	for(;;) {
+		if( ts->step_mode == SM_STEP ) {
+			if( u->step >= end_val ) {
+				break;
+			}
+		} else if( ts->step_mode == SM_AGE ) {
+			if( u->age >= end_val ) {
+				break;
+			}
+		} else {
+			ASSERT( ts->step_mode == SM_TIME );
+
+			now = time_stamp();
+			if( now >= end_seconds ) {
+				break;
+			}
+		}
+		if( simulate_chunk(u, ts->step_mode, end_val, metrics_fp, verify_every, tr) )
+			return 1;
+	}
+
+	return 0;
+}
+
+static void do_simulate(int forever, char *time_spec, char *in_filename, char *out_filename, char *metrics_filename,
+						LONG_LONG verify_every, int delta_every, TRIGGERS *tr)
+{
+	char errbuf[1000];
+	TIME_SPEC ts;
+	int result, stopped;
+	UNIVERSE *u;
+	char nowbuf[100];
+	PHASE_TIMER *pt;
+	FILE *metrics_fp;
+	DELTA_CHAIN dc;
+	
+
+	ASSERT( time_spec != NULL );
+	ASSERT( in_filename != NULL );
+	ASSERT( out_filename != NULL );
+
+	if( ! parse_time_spec(time_spec, &ts) ) {
+		usage("Time spec unit must be 'h', 'm', 's', 'u' or 'a'.");
+		exit(1);
+	}
+
+	printf("Input:  %s\n", in_filename);
+	printf("Output: %s\n", out_filename);
+	if( metrics_filename != NULL ) {
+		printf("Metrics: %s\n", metrics_filename);
+	}
+	if( forever ) {
+		printf("About to simulate universe for FOREVER.\n");
+		printf("Checkpoint interval is every %d %s.\n", ts.tspec, ts.unit_desc);
+	} else {
+		printf("About to simulate universe for %d %s...\n", ts.tspec, ts.unit_desc);
+	}
+
+#if 0
+	/*
+	 * Test to make sure the output file can be created
+	 * It screws up my perl script so we dont do this test.
+	 */
+{
+	FILE *fp;
+	fp = fopen(out_filename, "wb");
+	if( fp == NULL ) {
+		sprintf(errbuf, "unable to create/write to '%s'(%s)",
+					out_filename, strerror(errno));
+		usage(errbuf);
+		exit(1);
+	}
+	fclose(fp);
+}
+#endif
+
+	pt = NULL;
+	metrics_fp = NULL;
+	if( metrics_filename != NULL ) {
+		metrics_fp = fopen(metrics_filename, "a");
+		if( metrics_fp == NULL ) {
+			snprintf(errbuf, sizeof(errbuf), "%s: %s", metrics_filename, strerror(errno));
+			usage(errbuf);
+			exit(1);
+		}
+		pt = Phase_Timer_Make(1);
+		if( ! pt->have_counters ) {
+			printf("Hardware counters are not available, only timing phases.\n");
+		}
+	}
+
+	/*
+	 * Okay here we go... Open input file for simulating
+	 *
+	 */
+	if( pt != NULL )
+		Phase_Timer_Begin(pt, PHASE_CHECKPOINT);
+
+	u = Universe_Read(in_filename, errbuf);
+	if( u == NULL ) {
+		usage(errbuf);
+		exit(1);
+	}
+
+	if( pt != NULL ) {
+		Phase_Timer_End(pt);
+		u->phase_timer = pt;
+	}
+
+	if( verify_every > 0 )
+		print_verify(u);
+
+	if( delta_every > 1 ) {
+		dc.delta_every = delta_every;
+		dc.ncheckpoints = 0;
+		dc.last_step = u->step;
+		dc.files = (char **) CALLOC(delta_every, sizeof(char *));
+		ASSERT( dc.files != NULL );
+		dc.nfiles = 0;
+		Universe_Track_Dirty_Tiles(u, 1);
+	}
+
+	if( tr != NULL ) {
+		tr->out_filename = out_filename;
+		tr->dc = (delta_every > 1) ? &dc : NULL;
+		tr->checkpoint_was_true = 0;
+	}
+
+	stopped = 0;
+	
+do {
+		
+	time_stamp_str(nowbuf);
+
+	printf("%s ---------- BEGIN ----------\n", nowbuf);
+
+	stopped = simulate_for(u, &ts, metrics_fp, verify_every, tr);
+
+	time_stamp_str(nowbuf);
+
+	printf("%s ---------- END ----------\n", nowbuf);
+
+	if( pt != NULL )
+		Phase_Timer_Begin(pt, PHASE_CHECKPOINT);
+
+	result = write_checkpoint(u, out_filename, (delta_every > 1) ? &dc : NULL, errbuf);
+	if( ! result ) {
+		usage(errbuf);
+	}
+
+	if( pt != NULL ) {
+		Phase_Timer_End(pt);
+		write_metrics(metrics_fp, u);
+	}
+
+	if( stopped ) {
+		printf("Wrote %s. Stop condition is true.\n", out_filename);
+	} else if( forever ) {
+		printf("Wrote %s. Resuming simulating...\n", out_filename);
+	}
+		
+} while( forever && ! stopped );
+
+	Universe_Delete(u);
+
+	if( delta_every > 1 ) {
+		while( dc.nfiles > 0 )
+			FREE(dc.files[ --dc.nfiles ]);
+		FREE(dc.files);
+	}
+
+	if( pt != NULL ) {
+		Phase_Timer_Delete(pt);
+		fclose(metrics_fp);
+	}
+}
+
+static void simulate(char *time_spec, char *in_filename, char *out_filename, char *metrics_filename,
+						LONG_LONG verify_every, TRIGGERS *tr)
+{
+	do_simulate(0, time_spec, in_filename, out_filename, metrics_filename, verify_every, 0, tr);
+}
+
+static void simulateForever(char *time_spec, char *in_filename, char *out_filename, char *metrics_filename,
+						LONG_LONG verify_every, int delta_every, TRIGGERS *tr)
+{
+	do_simulate(1, time_spec, in_filename, out_filename, metrics_filename, verify_every, delta_every, tr);
+}
+
+/*
+ * Remove "<option> N" (e.g. "--verify-every N") from the argument list (it
+ * can appear anywhere after the mode), and return N. Returns 0 if the option
+ * isn't there, and -1 if N is missing or not a positive number.
+ */
+static LONG_LONG parse_count_option(int *argc, char *argv[], const char *option)
+{
+	LONG_LONG n;
+	int i, j;
+
+	ASSERT( argc != NULL );
+	ASSERT( argv != NULL );
+	ASSERT( option != NULL );
+
+	for(i=2; i < *argc; i++) {
+		if( strcmp(argv[i], option) == 0 )
+			break;
+	}
+
+	if( i == *argc )
+		return 0;
+
+	if( i+1 == *argc )
+		return -1;
+
+	n = atoll(argv[i+1]);
+	if( n <= 0 )
+		return -1;
+
+	for(j=i+2; j < *argc; j++) {
+		argv[j-2] = argv[j];
+	}
+	*argc -= 2;
+	argv[*argc] = NULL;
+
+	return n;
+}
+
+/*
+ * Remove "<option> value" (e.g. "--stop-if expr") from the argument list,
+ * and set 'value'. Returns 0 if the option isn't there, and -1 if the
+ * value is missing.
+ */
+static int parse_string_option(int *argc, char *argv[], const char *option, char **value)
+{
+	int i, j;
+
+	ASSERT( argc != NULL );
+	ASSERT( argv != NULL );
+	ASSERT( option != NULL );
+	ASSERT( value != NULL );
+
+	for(i=2; i < *argc; i++) {
+		if( strcmp(argv[i], option) == 0 )
+			break;
+	}
+
+	if( i == *argc )
+		return 0;
+
+	if( i+1 == *argc )
+		return -1;
+
+	*value = argv[i+1];
+
+	for(j=i+2; j < *argc; j++) {
+		argv[j-2] = argv[j];
+	}
+	*argc -= 2;
+	argv[*argc] = NULL;
+
+	return 1;
+}
+
+/*
+ * Parse (and remove) the condition options of 's' and 'sf'. Returns
+ * NULL if there are none. Each expression is compiled here so that
+ * a mistake is reported before simulating.
+ */
+static TRIGGERS *parse_triggers(int *argc, char *argv[])
+{
+	static const char *options[3] = { "--stop-if", "--checkpoint-if", "--dump-if" };
+	char errbuf[1000];
+	ORGANISM_FINDER *of[3];
+	TRIGGERS *tr;
+	LONG_LONG every;
+	char *expr;
+	int i, result, any;
+
+	every = parse_count_option(argc, argv, "--check-every");
+	if( every < 0 ) {
+		usage("'--check-every' must be followed by a positive number of steps.");
+		exit(1);
+	}
+
+	any = 0;
+	for(i=0; i < 3; i++) {
+		of[i] = NULL;
+		result = parse_string_option(argc, argv, options[i], &expr);
+		if( result < 0 ) {
+			snprintf(errbuf, sizeof(errbuf), "'%s' must be followed by a find expression.", options[i]);
+			usage(errbuf);
+			exit(1);
+		}
+		if( result == 0 )
+			continue;
+
+		of[i] = OrganismFinder_make(expr, 0);
+		if( of[i]->error ) {
+			snprintf(errbuf, sizeof(errbuf), "%s \"%s\": %s", options[i], expr, OrganismFinder_get_error(of[i]));
+			usage(errbuf);
+			exit(1);
+		}
+		any = 1;
+	}
+
+	if( ! any ) {
+		if( every > 0 ) {
+			usage("'--check-every' needs a condition to check.");
+			exit(1);
+		}
+		return NULL;
+	}
+
+	tr = (TRIGGERS *) CALLOC(1, sizeof(TRIGGERS));
+	ASSERT( tr != NULL );
+
+	tr->every		= (every > 0) ? every : TRIGGER_EVERY;
+	tr->stop		= of[0];
+	tr->checkpoint	= of[1];
+	tr->dump		= of[2];
+
+	return tr;
+}
+
+static void triggers_delete(TRIGGERS *tr)
+{
+	if( tr == NULL )
+		return;
+
+	if( tr->stop != NULL )
+		OrganismFinder_delete(tr->stop);
+
+	if( tr->checkpoint != NULL )
+		OrganismFinder_delete(tr->checkpoint);
+
+	if( tr->dump != NULL )
+		OrganismFinder_delete(tr->dump);
+
+	FREE(tr);
+}
+
+/***********************************************************************
+ * PICK RANDOM CREATURE
+ *
+ */
+#define RC_RADIUS	100
+
+/*
+ * Is 'c' the first cell of its organism that is inside the region
+ * (x1,y1)-(x2,y2)? This lets each organism be counted once when the
+ * region is scanned.
+ */
+static int rc_first_cell(CELL *c, int x1, int y1, int x2, int y2)
+{
+	CELL *cc;
+
+	for(cc=c->organism->cells; cc != c; cc=cc->next) {
+		if( cc->x >= x1 && cc->x <= x2 && cc->y >= y1 && cc->y <= y2 )
+			return 0;
+	}
+
+	return 1;
+}
+
+/*
+ * Print organism 'o' as a KFORTH program, with its strain settings as comments.
+ */
+static void rc_print(UNIVERSE *u, ORGANISM *o, const char *filename)
+{
+	KFORTH_DISASSEMBLY *kfd;
+	char *comment;
+
+	ASSERT( u != NULL );
+	ASSERT( o != NULL );
+
+	comment = kforth_metadata_comment_make(o->strain, &u->strop[o->strain],
+						&u->kfmo[o->strain], &u->kfops[o->strain], &o->program);
+
+	kfd = kforth_disassembly_make(&u->kfops[o->strain], &o->program, 80, 0);
+
+	printf("; Organism %lld from %s (step %lld)\n", (long long) o->id, filename, (long long) u->step);
+	printf("; Cell at (%d, %d), Cells: %d, Energy: %d, Age: %d, Generation: %d\n",
+				o->cells->x, o->cells->y, o->ncells, o->energy, o->age, o->generation);
+	printf("%s", comment);
+	printf(";\n");
+	printf("%s\n", kfd->program_text);
+
+	kforth_disassembly_delete(kfd);
+	kforth_metadata_comment_delete(comment);
+}
+
+/*
+ * Pick a random organism using reservoir sampling: the n'th organism
+ * seen replaces the pick with probability 1/n. When a region is given
+ * only that part of the grid is scanned, so the cost depends on the
+ * size of the region and not on the number of organisms.
+ */
+static void random_creature(char *filename, int have_xy, int x, int y, int radius)
+{
+	UNIVERSE *u;
+	char errbuf[1000];
+	EVOLVE_RANDOM er;
+	ORGANISM *o, *pick;
+	UNIVERSE_GRID ugrid;
+	int x1, y1, x2, y2, gx, gy;
+	LONG_LONG n;
+
+	ASSERT( filename != NULL );
+
+	u = Universe_Read(filename, errbuf);
+	if( u == NULL ) {
+		usage(errbuf);
+		exit(1);
+	}
+
+	sim_random_init((uint32_t) time(NULL), &er);
+
+	pick = NULL;
+	n = 0;
+
+	if( ! have_xy ) {
+		for(o=u->organisms; o; o=o->next) {
+			n++;
+			if( sim_random(&er) % n == 0 )
+				pick = o;
+		}
+
+	} else {
+		x1 = (x - radius < 0) ? 0 : x - radius;
+		y1 = (y - radius < 0) ? 0 : y - radius;
+		x2 = (x + radius >= u->width) ? u->width-1 : x + radius;
+		y2 = (y + radius >= u->height) ? u->height-1 : y + radius;
+
+		for(gy=y1; gy <= y2; gy++) {
+			for(gx=x1; gx <= x2; gx++) {
+				if( Grid_Get(u, gx, gy, &ugrid) != GT_CELL )
+					continue;
+
+				if( ! rc_first_cell(ugrid.u.cell, x1, y1, x2, y2) )
+					continue;
+
+				n++;
+				if( sim_random(&er) % n == 0 )
+					pick = ugrid.u.cell->organism;
+			}
+		}
+	}
+
+	if( pick == NULL ) {
+		if( have_xy )
+			snprintf(errbuf, sizeof(errbuf), "%s: no creatures within %d of (%d, %d)", filename, radius, x, y);
+		else
+			snprintf(errbuf, sizeof(errbuf), "%s: no creatures", filename);
+		usage(errbuf);
+		Universe_Delete(u);
+		exit(1);
+	}
+
+	rc_print(u, pick, filename);
+
+	Universe_Delete(u);
+}
+
+/***********************************************************************
+ * SIMULATE UNTIL ONE STRAIN LEFT
+ *
+ */
+
+/*
+ * Simulate 'u' until only one strain has organisms, or until 'max_steps'
+ * steps have been simulated (0 means no limit). Returns the strain that
+ * is left, or -1 if there was no winner.
+ *
+ * Only the strains alive at the start are watched, using u->strpop[] after
+ * each step. A strain can't come back once its population reaches 0.
+ */
+static int simulate_one_strain(UNIVERSE *u, LONG_LONG max_steps)
+{
+	int alive[8];
+	int nalive, i;
+	LONG_LONG end_step;
+
+	ASSERT( u != NULL );
+	ASSERT( max_steps >= 0 );
+
+	nalive = 0;
+	for(i=0; i < 8; i++) {
+		if( u->strpop[i] > 0 )
+			alive[nalive++] = i;
+	}
+
+	end_step = u->step + max_steps;
+
+	while( nalive > 1 ) {
+		if( max_steps > 0 && u->step >= end_step )
+			return -1;
+
+		Universe_Simulate(u);
+
+		for(i=0; i < nalive; ) {
+			if( u->strpop[ alive[i] ] == 0 )
+				alive[i] = alive[--nalive];
+			else
+				i++;
+		}
+	}
+
+	return (nalive == 1) ? alive[0] : -1;
+}
+
+/*
+ * 'time_spec' is the step limit, such as "5000000u", or NULL for no limit.
+ */
+static void one_strain(char *in_filename, char *out_filename, char *time_spec)
+{
+	UNIVERSE *u;
+	char errbuf[1000];
+	TIME_SPEC ts;
+	LONG_LONG start_step, max_steps;
+	int strain;
+
+	ASSERT( in_filename != NULL );
+	ASSERT( out_filename != NULL );
+
+	max_steps = 0;
+	if( time_spec != NULL ) {
+		if( ! parse_time_spec(time_spec, &ts) || ts.step_mode != SM_STEP || ts.value <= 0 ) {
+			usage("'1s' step limit must be a number of steps, such as 5000000u.");
+			exit(1);
+		}
+		max_steps = ts.value;
+	}
+
+	u = Universe_Read(in_filename, errbuf);
+	if( u == NULL ) {
+		usage(errbuf);
+		exit(1);
+	}
+
+	if( u->norganism == 0 ) {
+		printf("0 0\n");
+		Universe_Delete(u);
+		return;
+	}
+
+	start_step = u->step;
+
+	strain = simulate_one_strain(u, max_steps);
+
+	printf("%d %lld\n", strain, (long long) (u->step - start_step));
+
+	if( ! Universe_Write(u, out_filename, errbuf) ) {
+		usage(errbuf);
+		Universe_Delete(u);
+		exit(1);
+	}
+
+	Universe_Delete(u);
+}
+
+/***********************************************************************
+ * TOURNAMENT
+ *
+ */
+#define TOUR_MAX_PLAYERS	100
+#define TOUR_MAX_THREADS	64
+
+typedef struct {
+	int			a;				// players (index into TOURNAMENT.names)
+	int			b;
+	int			k;				// which of the N matches for this pair
+	int			winner;			// player that won, -1 for a draw
+	LONG_LONG	steps;
+	char		errbuf[1000];	// non-empty if the universe could not be made
+} TOUR_MATCH;
+
+typedef struct {
+	NEW_UNIVERSE_OPTIONS	nuo;			// from the template, strains 0 and 1 enabled
+	UNIVERSE				*tmpl;			// for the barriers
+	LONG_LONG				max_steps;
+	int						nplayers;
+	char					**names;
+	KFORTH_PROGRAM			**programs;		// compiled seed of each player
+	int						nmatches;
+	TOUR_MATCH				*matches;
+	std::atomic<int>		next;			// next match to play
+} TOURNAMENT;
+
+/*
+ * Read all of 'filename' into a string, NULL on error.
+ */
+static char *read_text_file(const char *filename, char *errbuf)
+{
+	FILE *fp;
+	char *text;
+	long len;
+
+	fp = fopen(filename, "rb");
+	if( fp == NULL ) {
+		snprintf(errbuf, 1000, "%s: %s", filename, strerror(errno));
+		return NULL;
+	}
+
+	fseek(fp, 0, SEEK_END);
+	len = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	text = (char *) MALLOC(len+1);
+	ASSERT( text != NULL );
+
+	len = (long) fread(text, 1, len, fp);
+	text[len] = '\0';
+
+	fclose(fp);
+
+	return text;
+}
+
+/*
+ * Fill in the NEW_UNIVERSE_OPTIONS for the tournament from the template.
+ * Strains 0 and 1 both get the template's strain 0 settings.
+ */
+static void tour_options(TOURNAMENT *t)
+{
+	UNIVERSE *u;
+	STRAIN_PROFILE *sp;
+	ORGANISM *o;
+	int i, population, energy;
+
+	u = t->tmpl;
+
+	population = 0;
+	energy = 0;
+	for(o=u->organisms; o; o=o->next) {
+		if( o->strain == 0 ) {
+			population++;
+			energy += o->energy;
+		}
+	}
+
+	if( population == 0 ) {
+		population = 1;
+		energy = 10000;
+	} else if( population > 100 ) {
+		population = 100;
+	}
+
+	NewUniverseOptions_Init(&t->nuo);
+	t->nuo.seed			= u->seed;
+	t->nuo.width		= u->width;
+	t->nuo.height		= u->height;
+	t->nuo.want_barrier	= 0;
+	t->nuo.so			= u->so;
+
+	for(i=0; i < 2; i++) {
+		sp = NewUniverse_Get_StrainProfile(&t->nuo, i);
+		StrainProfile_Init(sp);
+		snprintf(sp->name, sizeof(sp->name), "player%d", i);
+		sp->population	= population;
+		sp->energy		= energy;
+		sp->strop		= u->strop[0];
+		sp->kfmo		= u->kfmo[0];
+		sp->kfops		= u->kfops[0];
+		sp->strop.enabled = 1;
+	}
+}
+
+/*
+ * Play one match. Runs on a worker thread, so it only touches its own
+ * universe and its own TOUR_MATCH.
+ */
+static void tour_play(TOURNAMENT *t, TOUR_MATCH *m)
+{
+	NEW_UNIVERSE_OPTIONS nuo;
+	KFORTH_PROGRAM *programs[8];
+	UNIVERSE *u;
+	UNIVERSE_GRID ugrid;
+	int i, x, y, swap, strain;
+
+	nuo = t->nuo;
+	nuo.seed = t->nuo.seed + m->k;
+
+	swap = (m->k % 2);
+
+	for(i=0; i < 8; i++)
+		programs[i] = NULL;
+
+	programs[swap]		= t->programs[m->a];
+	programs[1-swap]	= t->programs[m->b];
+
+	u = CreateUniverse_Programs(&nuo, programs, m->errbuf);
+	if( u == NULL ) {
+		m->winner = -1;
+		return;
+	}
+
+	for(y=0; y < u->height; y++) {
+		for(x=0; x < u->width; x++) {
+			if( Grid_Get(t->tmpl, x, y, &ugrid) == GT_BARRIER )
+				Universe_SetBarrier(u, x, y);
+		}
+	}
+
+	strain = simulate_one_strain(u, t->max_steps);
+
+	if( strain == swap )
+		m->winner = m->a;
+	else if( strain == 1-swap )
+		m->winner = m->b;
+	else
+		m->winner = -1;
+
+	m->steps = u->step;
+
+	Universe_Delete(u);
+}
+
+static void tour_worker(TOURNAMENT *t)
+{
+	int i;
+
+	while( (i = t->next++) < t->nmatches ) {
+		tour_play(t, &t->matches[i]);
+	}
+}
+
+static void tour_print(TOURNAMENT *t)
+{
+	int *wins;
+	int i, j, n, total, draws, width;
+	TOUR_MATCH *m;
+
+	wins = (int *) CALLOC(t->nplayers * t->nplayers, sizeof(int));
+	ASSERT( wins != NULL );
+
+	draws = 0;
+	for(i=0; i < t->nmatches; i++) {
+		m = &t->matches[i];
+
+		if( m->errbuf[0] != '\0' ) {
+			printf("match %s %s seed=%d error=%s\n", t->names[m->a], t->names[m->b], m->k, m->errbuf);
+			continue;
+		}
+
+		printf("match %s %s seed=%d winner=%s steps=%lld\n",
+				t->names[m->a], t->names[m->b], m->k,
+				(m->winner >= 0) ? t->names[m->winner] : "draw", (long long) m->steps);
+
+		if( m->winner == m->a )
+			wins[ m->a * t->nplayers + m->b ] += 1;
+		else if( m->winner == m->b )
+			wins[ m->b * t->nplayers + m->a ] += 1;
+		else
+			draws++;
+	}
+
+	width = 6;
+	for(i=0; i < t->nplayers; i++) {
+		n = (int) strlen(t->names[i]);
+		if( n > width )
+			width = n;
+	}
+
+	printf("\n%*s", width, "");
+	for(j=0; j < t->nplayers; j++)
+		printf(" %*s", width, t->names[j]);
+	printf(" %*s\n", width, "wins");
+
+	for(i=0; i < t->nplayers; i++) {
+		printf("%-*s", width, t->names[i]);
+		total = 0;
+		for(j=0; j < t->nplayers; j++) {
+			if( i == j ) {
+				printf(" %*s", width, "-");
+			} else {
+				printf(" %*d", width, wins[ i * t->nplayers + j ]);
+				total += wins[ i * t->nplayers + j ];
+			}
+		}
+		printf(" %*d\n", width, total);
+	}
+	printf("draws %d\n", draws);
+
+	FREE(wins);
+}
+
+static void tournament(char *template_filename, char *time_spec, int nseeds, int nplayers, char **seed_filenames)
+{
+	std::thread workers[ TOUR_MAX_THREADS ];
+	TOURNAMENT *t;
+	TIME_SPEC ts;
+	char errbuf[1000];
+	char *text;
+	int i, a, b, k, nthreads;
+
+	ASSERT( template_filename != NULL );
+	ASSERT( seed_filenames != NULL );
+
+	if( ! parse_time_spec(time_spec, &ts) || ts.step_mode != SM_STEP || ts.value <= 0 ) {
+		usage("Tournament step limit must be a number of steps, such as 5000000u.");
+		exit(1);
+	}
+
+	if( nseeds <= 0 ) {
+		usage("Tournament must play each pair at least once.");
+		exit(1);
+	}
+
+	if( nplayers < 2 || nplayers > TOUR_MAX_PLAYERS ) {
+		snprintf(errbuf, sizeof(errbuf), "Tournament needs 2 to %d seed files.", TOUR_MAX_PLAYERS);
+		usage(errbuf);
+		exit(1);
+	}
+
+	t = new TOURNAMENT();
+
+	t->tmpl = Universe_Read(template_filename, errbuf);
+	if( t->tmpl == NULL ) {
+		usage(errbuf);
+		exit(1);
+	}
+
+	t->max_steps = ts.value;
+	tour_options(t);
+
+	/*
+	 * Compile each seed once, with the instruction set the players will use.
+	 */
+	t->nplayers = nplayers;
+	t->names = seed_filenames;
+	t->programs = (KFORTH_PROGRAM **) CALLOC(nplayers, sizeof(KFORTH_PROGRAM *));
+	ASSERT( t->programs != NULL );
+
+	for(i=0; i < nplayers; i++) {
+		text = read_text_file(seed_filenames[i], errbuf);
+		if( text == NULL ) {
+			usage(errbuf);
+			exit(1);
+		}
+
+		t->programs[i] = kforth_compile(text, &t->nuo.strain_profiles[0].kfops, errbuf);
+		FREE(text);
+
+		if( t->programs[i] == NULL ) {
+			fprintf(stderr, "%s: %s\n", seed_filenames[i], errbuf);
+			exit(1);
+		}
+	}
+
+	t->nmatches = nplayers * (nplayers-1) / 2 * nseeds;
+	t->matches = (TOUR_MATCH *) CALLOC(t->nmatches, sizeof(TOUR_MATCH));
+	ASSERT( t->matches != NULL );
+
+	i = 0;
+	for(a=0; a < nplayers; a++) {
+		for(b=a+1; b < nplayers; b++) {
+			for(k=0; k < nseeds; k++) {
+				t->matches[i].a = a;
+				t->matches[i].b = b;
+				t->matches[i].k = k;
+				i++;
+			}
+		}
+	}
+
+	/*
+	 * Play them, the last worker is this thread.
+	 */
+	nthreads = (int) std::thread::hardware_concurrency();
+	if( nthreads < 1 )
+		nthreads = 1;
+	if( nthreads > TOUR_MAX_THREADS )
+		nthreads = TOUR_MAX_THREADS;
+	if( nthreads > t->nmatches )
+		nthreads = t->nmatches;
+
+	t->next = 0;
+
+	for(i=0; i < nthreads-1; i++)
+		workers[i] = std::thread(tour_worker, t);
+
+	tour_worker(t);
+
+	for(i=0; i < nthreads-1; i++)
+		workers[i].join();
+
+	tour_print(t);
+
+	for(i=0; i < nplayers; i++)
+		kforth_delete(t->programs[i]);
+	FREE(t->programs);
+	FREE(t->matches);
+	Universe_Delete(t->tmpl);
+	delete t;
+}
+
+static double percent(LONG_LONG part, LONG_LONG total)
+{
+	if( total == 0 )
+		return 0.0;
+
+	return 100.0 * (double)part / (double)total;
+}
+
+/*
+ * Print the opcode profile for one strain, most expensive opcodes first.
+ * 'core' is used to tell the CORE KFORTH instructions apart
+ * from the cell instructions.
+ */
+static void profile_report(int strain, KFORTH_OPERATIONS *kfops, KFORTH_PROFILE *kfprof, KFORTH_OPERATIONS *core)
+{
+	int order[KFORTH_OPS_LEN];
+	int i, n, opcode;
+	LONG_LONG executed, skipped, ticks;
+	LONG_LONG core_executed, core_ticks;
+
+	ASSERT( kfops != NULL );
+	ASSERT( kfprof != NULL );
+	ASSERT( core != NULL );
+
+	executed = skipped = ticks = 0;
+	core_executed = core_ticks = 0;
+	for(opcode=0; opcode < kfops->count; opcode++) {
+		executed += kfprof->executed[opcode];
+		skipped += kfprof->skipped[opcode];
+		ticks += kfprof->ticks[opcode];
+
+		if( kforth_ops_find(core, kfops->table[opcode].name) >= 0 ) {
+			core_executed += kfprof->executed[opcode];
+			core_ticks += kfprof->ticks[opcode];
+		}
+	}
+
+	printf("\n");
+	printf("STRAIN %d\n", strain);
+	printf("    instructions executed: %lld, skipped: %lld\n", (long long) executed, (long long) skipped);
+	printf("    numbers pushed:        %lld, skipped: %lld\n",
+				(long long) kfprof->literals, (long long) kfprof->literals_skipped);
+	printf("    core instructions:     %5.1f%% of executions, %5.1f%% of ticks\n",
+				percent(core_executed, executed), percent(core_ticks, ticks));
+	printf("    cell instructions:     %5.1f%% of executions, %5.1f%% of ticks\n",
+				percent(executed - core_executed, executed), percent(ticks - core_ticks, ticks));
+	printf("\n");
+
+	printf("    %-16s %14s %6s %16s %6s %10s %14s\n",
+				"OPCODE", "EXECUTED", "EXEC%", "TICKS", "TICK%", "TICKS/EXEC", "SKIPPED");
+
+	n = kforth_profile_sort(kfops, kfprof, order);
+	for(i=0; i < n; i++) {
+		opcode = order[i];
+		printf("    %-16s %14lld %6.2f %16lld %6.2f %10.1f %14lld\n",
+					kfops->table[opcode].name,
+					(long long) kfprof->executed[opcode], percent(kfprof->executed[opcode], executed),
+					(long long) kfprof->ticks[opcode], percent(kfprof->ticks[opcode], ticks),
+					(kfprof->executed[opcode] == 0) ? 0.0
+						: (double)kfprof->ticks[opcode] / (double)kfprof->executed[opcode],
+					(long long) kfprof->skipped[opcode]);
+	}
+}
+
+/*
+ * Simulate 'in_filename' for 'time_spec' with the opcode profiler
+ * attached to every enabled strain, then print a report.
+ * Nothing is written back to the simulation file.
+ */
+static void profile_simulation(char *time_spec, char *in_filename)
+{
+	char errbuf[1000];
+	TIME_SPEC ts;
+	UNIVERSE *u;
+	KFORTH_PROFILE *kfprof[EVOLVE_MAX_STRAINS];
+	KFORTH_OPERATIONS *core;
+	int i;
+
+	ASSERT( time_spec != NULL );
+	ASSERT( in_filename != NULL );
+
+	if( ! kforth_profile_enabled() ) {
+		usage("The opcode profiler was not compiled in (build with -DKFORTH_PROFILER).");
+		exit(1);
+	}
 
-			now = time_stamp();
-			if( now >= end_seconds ) {
-				break;
-			}
+	if( ! parse_time_spec(time_spec, &ts) ) {
+		usage("Time spec unit must be 'h', 'm', 's', 'u' or 'a'.");
+		exit(1);
+	}
+
+	u = Universe_Read(in_filename, errbuf);
+	if( u == NULL ) {
+		usage(errbuf);
+		exit(1);
+	}
+
+	printf("Input:  %s\n", in_filename);
+	printf("About to profile universe for %d %s...\n", ts.tspec, ts.unit_desc);
+
+	for(i=0; i < EVOLVE_MAX_STRAINS; i++) {
+		kfprof[i] = NULL;
+		if( u->strop[i].enabled ) {
+			kfprof[i] = kforth_profile_make();
+			kforth_profile_attach(&u->kfops[i], kfprof[i]);
 		}
-		simulate_chunk(u, step_mode, end_val);
 	}
 
-	time_stamp_str(nowbuf);
+	simulate_for(u, &ts, NULL, 0, NULL);
 
-	printf("%s ---------- END ----------\n", nowbuf);
+	core = kforth_ops_make();
 
-	result = Universe_Write(u, out_filename, errbuf);
-	if( ! result ) {
+	for(i=0; i < EVOLVE_MAX_STRAINS; i++) {
+		if( kfprof[i] == NULL )
+			continue;
+
+		profile_report(i, &u->kfops[i], kfprof[i], core);
+
+		kforth_profile_attach(&u->kfops[i], NULL);
+		kforth_profile_delete(kfprof[i]);
+	}
+
+	kforth_ops_delete(core);
+	Universe_Delete(u);
+}
+
+/***********************************************************************
+ * BENCHMARKS
+ *
+ * Each case creates a universe from scratch (fixed seed, size and
+ * strains), simulates it for a fixed number of steps, then writes and
+ * reads it back as a checkpoint.
+ *
+ * The seed program is built in, so results do not depend on files
+ * lying around. It grows, eats, moves and makes spores, so every case
+ * exercises births, deaths, the grid and the interpreter.
+ *
+ */
+static const char *bench_seed_program =
+	"main:\n"
+	"{\n"
+	"	-1 0 GROW pop\n"
+	"	1 0 GROW pop\n"
+	"	0 1 GROW pop\n"
+	"	life call\n"
+	"}\n"
+	"\n"
+	"life:\n"
+	"{\n"
+	"	0 1 EAT pop 1 0 EAT pop 0 -1 EAT pop -1 0 EAT pop\n"
+	"	1 1 EAT pop -1 -1 EAT pop\n"
+	"	1 1 LOOK 2pop\n"
+	"	-1 1 CHOOSE -1 1 CHOOSE OMOVE pop\n"
+	"	ENERGY 300 > spore if\n"
+	"	R0++ 50 > die if\n"
+	"	1 ?loop\n"
+	"}\n"
+	"\n"
+	"spore:\n"
+	"{\n"
+	"	-1 1 CHOOSE -1 1 CHOOSE  ENERGY 4 / MAKE-SPORE pop\n"
+	"}\n"
+	"\n"
+	"die:\n"
+	"{\n"
+	"	0 R0! NUM-CELLS 4 > ?exit HALT\n"
+	"}\n";
+
+typedef struct {
+	const char	*name;
+	int32_t		seed;
+	int			width;
+	int			height;
+	int			nstrains;
+	int			population;		// per strain
+	int			energy;			// per strain
+	LONG_LONG	steps;
+} BENCH_CASE;
+
+static const BENCH_CASE bench_cases[] = {
+	{ "sparse-1",	1001,	 700,	 600,	1,	 10,	 100000,	20000000 },
+	{ "sparse-4",	1002,	 700,	 600,	4,	 10,	 100000,	20000000 },
+	{ "dense-1",	1003,	 160,	 120,	1,	100,	1000000,	20000000 },
+	{ "dense-4",	1004,	 160,	 120,	4,	 25,	 250000,	20000000 },
+	{ "large-8",	1005,	1500,	1200,	8,	 10,	 100000,	20000000 },
+};
+
+#define BENCH_NCASES	(int)(sizeof(bench_cases) / sizeof(bench_cases[0]))
+
+/*
+ * Peak resident set size of this process so far, in kilobytes (0 if unknown).
+ */
+static LONG_LONG peak_rss_kb(void)
+{
+#ifdef __windows__
+	return 0;
+#else
+	struct rusage ru;
+
+	if( getrusage(RUSAGE_SELF, &ru) != 0 )
+		return 0;
+
+#ifdef __APPLE__
+	return (LONG_LONG) ru.ru_maxrss / 1024;		// bytes on macos
+#else
+	return (LONG_LONG) ru.ru_maxrss;
+#endif
+#endif
+}
+
+static LONG_LONG file_size(const char *filename)
+{
+	FILE *fp;
+	LONG_LONG size;
+
+	fp = fopen(filename, "rb");
+	if( fp == NULL )
+		return 0;
+
+	fseek(fp, 0, SEEK_END);
+	size = (LONG_LONG) ftell(fp);
+	fclose(fp);
+
+	return size;
+}
+
+static UNIVERSE *bench_create(const BENCH_CASE *bc, const char *seed_filename, char *errbuf)
+{
+	NEW_UNIVERSE_OPTIONS nuo;
+	STRAIN_PROFILE *sp;
+	int i;
+
+	NewUniverseOptions_Init(&nuo);
+	nuo.seed	= bc->seed;
+	nuo.width	= bc->width;
+	nuo.height	= bc->height;
+	SimulationOptions_Init(&nuo.so);
+
+	for(i=0; i < bc->nstrains; i++) {
+		sp = NewUniverse_Get_StrainProfile(&nuo, i);
+
+		StrainProfile_Init(sp);
+		snprintf(sp->name, sizeof(sp->name), "bench%d", i);
+		StrainProfile_Set_SeedFile(sp, seed_filename);
+		sp->energy		= bc->energy;
+		sp->population	= bc->population;
+		kforth_mutate_options_defaults(&sp->kfmo);
+		sp->kfops		= *EvolveOperations();
+
+		StrainOptions_Init(&sp->strop);
+		sp->strop.enabled			= 1;
+		strcpy(sp->strop.name, sp->name);
+		sp->strop.look_mode			= 1;
+		sp->strop.rotate_mode		= 1;
+		sp->strop.make_spore_energy	= 10;
+		sp->strop.grow_energy		= 10;
+		sp->strop.grow_size			= 20;
+	}
+
+	return CreateUniverse(&nuo, errbuf);
+}
+
+/*
+ * Run one benchmark case and print one line of name=value pairs.
+ */
+static void bench_run(const BENCH_CASE *bc, const char *seed_filename, const char *checkpoint_filename)
+{
+	char errbuf[1000];
+	UNIVERSE *u, *u2;
+	double t0, sim_seconds, write_seconds, read_seconds, mb;
+	LONG_LONG nborn, bytes;
+
+	u = bench_create(bc, seed_filename, errbuf);
+	if( u == NULL ) {
 		usage(errbuf);
+		exit(1);
 	}
 
-	if( forever ) {
-		printf("Wrote %s. Resuming simulating...\n", out_filename);
+	nborn = u->nborn;
+
+	t0 = wall_clock();
+	while( u->step < bc->steps ) {
+		Universe_Simulate(u);
 	}
-		
-} while( forever );
+	sim_seconds = wall_clock() - t0;
+
+	t0 = wall_clock();
+	if( ! Universe_Write(u, checkpoint_filename, errbuf) ) {
+		usage(errbuf);
+		exit(1);
+	}
+	write_seconds = wall_clock() - t0;
+
+	bytes = file_size(checkpoint_filename);
+	mb = (double) bytes / (1024.0 * 1024.0);
+
+	t0 = wall_clock();
+	u2 = Universe_Read(checkpoint_filename, errbuf);
+	if( u2 == NULL ) {
+		usage(errbuf);
+		exit(1);
+	}
+	read_seconds = wall_clock() - t0;
+
+	printf("bench=%s width=%d height=%d strains=%d steps=%lld"
+			" seconds=%.3f steps_per_sec=%.0f instructions_per_sec=%.0f births_per_sec=%.1f"
+			" peak_rss_kb=%lld checkpoint_bytes=%lld write_mb_per_sec=%.2f read_mb_per_sec=%.2f"
+			" organisms=%d check_sum=%d\n",
+		bc->name, bc->width, bc->height, bc->nstrains, (long long) u->step,
+		sim_seconds,
+		(sim_seconds > 0) ? (double) u->step / sim_seconds : 0.0,
+		(sim_seconds > 0) ? (double) u->ninstructions / sim_seconds : 0.0,
+		(sim_seconds > 0) ? (double) (u->nborn - nborn) / sim_seconds : 0.0,
+		(long long) peak_rss_kb(), (long long) bytes,
+		(write_seconds > 0) ? mb / write_seconds : 0.0,
+		(read_seconds > 0) ? mb / read_seconds : 0.0,
+		u->norganism, check_sum(u));
+
+	fflush(stdout);
 
+	Universe_Delete(u2);
 	Universe_Delete(u);
 }
 
-static void simulate(char *time_spec, char *in_filename, char *out_filename)
+/*
+ * Run every benchmark case. Scratch files (the seed program and the
+ * checkpoint) are written to 'scratch_dir' and removed afterwards.
+ */
+static void benchmark(const char *scratch_dir)
+{
+	char seed_filename[1000];
+	char checkpoint_filename[1000];
+	char errbuf[1000];
+	FILE *fp;
+	int i;
+
+	ASSERT( scratch_dir != NULL );
+
+	snprintf(seed_filename, sizeof(seed_filename), "%s/bench_seed.kf", scratch_dir);
+	snprintf(checkpoint_filename, sizeof(checkpoint_filename), "%s/bench_checkpoint.txt", scratch_dir);
+
+	fp = fopen(seed_filename, "w");
+	if( fp == NULL ) {
+		snprintf(errbuf, sizeof(errbuf), "%.900s: %s", seed_filename, strerror(errno));
+		usage(errbuf);
+		exit(1);
+	}
+	fputs(bench_seed_program, fp);
+	fclose(fp);
+
+	printf("version=\"%s\" cases=%d\n", Evolve_Version(), BENCH_NCASES);
+
+	for(i=0; i < BENCH_NCASES; i++) {
+		bench_run(&bench_cases[i], seed_filename, checkpoint_filename);
+	}
+
+	remove(seed_filename);
+	remove(checkpoint_filename);
+}
+
+/***********************************************************************
+ * COMPILE BENCHMARK
+ *
+ * Compiles the seed program of each strain profile made by
+ * EvolvePreferences_Create_From_Scratch() (seed.kf, shoot3.kf, utank.kf, ...
+ * in 'seed_dir'), with that profile's instruction set, and prints
+ * programs compiled per second.
+ *
+ * Then all the seeds are compiled over and over from several threads at
+ * once, and each result is compared with the program compiled first.
+ *
+ */
+#define KC_SECONDS			1.0
+#define KC_MAX_THREADS		64
+#define KC_THREAD_ROUNDS	2000
+
+typedef struct {
+	int					nseeds;
+	char				**texts;
+	KFORTH_OPERATIONS	**kfops;
+	KFORTH_PROGRAM		**programs;		// compiled once, before the threads start
+	std::atomic<LONG_LONG>	compiled;
+	std::atomic<int>	mismatches;
+} KC_RUN;
+
+static int kc_same_program(KFORTH_PROGRAM *kfp, KFORTH_PROGRAM *kfp2)
+{
+	int cb, len;
+
+	if( kfp->nblocks != kfp2->nblocks )
+		return 0;
+
+	for(cb=0; cb < kfp->nblocks; cb++) {
+		len = kforth_program_cblen(kfp, cb);
+		if( len != kforth_program_cblen(kfp2, cb) )
+			return 0;
+		if( memcmp(kfp->block[cb], kfp2->block[cb], len * sizeof(KFORTH_INTEGER)) != 0 )
+			return 0;
+	}
+
+	return 1;
+}
+
+static void kc_worker(KC_RUN *kc)
 {
-	do_simulate(0, time_spec, in_filename, out_filename);
+	KFORTH_PROGRAM *kfp;
+	char errbuf[1000];
+	int r, i;
+
+	for(r=0; r < KC_THREAD_ROUNDS; r++) {
+		for(i=0; i < kc->nseeds; i++) {
+			kfp = kforth_compile(kc->texts[i], kc->kfops[i], errbuf);
+			if( kfp == NULL || ! kc_same_program(kfp, kc->programs[i]) ) {
+				kc->mismatches++;
+			}
+			if( kfp != NULL ) {
+				kforth_delete(kfp);
+			}
+			kc->compiled++;
+		}
+	}
 }
 
-static void simulateForever(char *time_spec, char *in_filename, char *out_filename)
+static void compile_benchmark(const char *seed_dir)
 {
-	do_simulate(1, time_spec, in_filename, out_filename);
+	std::thread workers[ KC_MAX_THREADS ];
+	EVOLVE_PREFERENCES ep;
+	STRAIN_PROFILE *sp;
+	KFORTH_PROGRAM *kfp;
+	KC_RUN *kc;
+	char errbuf[1000];
+	char *text;
+	LONG_LONG count;
+	double t0, seconds;
+	int i, n, nthreads;
+
+	ASSERT( seed_dir != NULL );
+
+	EvolvePreferences_Create_From_Scratch(&ep, seed_dir);
+
+	kc = new KC_RUN();
+	kc->nseeds		= 0;
+	kc->texts		= (char **) CALLOC(ep.nprofiles, sizeof(char *));
+	kc->kfops		= (KFORTH_OPERATIONS **) CALLOC(ep.nprofiles, sizeof(KFORTH_OPERATIONS *));
+	kc->programs	= (KFORTH_PROGRAM **) CALLOC(ep.nprofiles, sizeof(KFORTH_PROGRAM *));
+	kc->compiled	= 0;
+	kc->mismatches	= 0;
+
+	printf("version=\"%s\" profiles=%d\n", Evolve_Version(), ep.nprofiles);
+
+	for(i=0; i < ep.nprofiles; i++) {
+		sp = &ep.strain_profiles[i];
+
+		text = read_text_file(sp->seed_file, errbuf);
+		if( text == NULL ) {
+			printf("profile=\"%s\" skipped=1 error=\"%s\"\n", sp->name, errbuf);
+			continue;
+		}
+
+		kfp = kforth_compile(text, &sp->kfops, errbuf);
+		if( kfp == NULL ) {
+			printf("profile=\"%s\" skipped=1 error=\"%s\"\n", sp->name, errbuf);
+			FREE(text);
+			continue;
+		}
+
+		/*
+		 * Single thread: compile it again until KC_SECONDS have gone by.
+		 */
+		count = 0;
+		t0 = wall_clock();
+		do {
+			for(n=0; n < 100; n++) {
+				kforth_delete( kforth_compile(text, &sp->kfops, errbuf) );
+			}
+			count += n;
+			seconds = wall_clock() - t0;
+		} while( seconds < KC_SECONDS );
+
+		printf("profile=\"%s\" seed=%s bytes=%d instructions=%d blocks=%d"
+				" programs=%lld seconds=%.3f programs_per_sec=%.0f mb_per_sec=%.2f\n",
+			sp->name, sp->seed_file, (int) strlen(text),
+			kforth_program_length(kfp), kfp->nblocks,
+			(long long) count, seconds, count / seconds,
+			(double) strlen(text) * count / seconds / (1024.0*1024.0));
+		fflush(stdout);
+
+		kc->texts[kc->nseeds]		= text;
+		kc->kfops[kc->nseeds]		= &sp->kfops;
+		kc->programs[kc->nseeds]	= kfp;
+		kc->nseeds++;
+	}
+
+	if( kc->nseeds == 0 ) {
+		snprintf(errbuf, sizeof(errbuf), "No seed files could be compiled from '%s'.", seed_dir);
+		usage(errbuf);
+		exit(1);
+	}
+
+	/*
+	 * Several threads: the last worker is this thread.
+	 */
+	nthreads = (int) std::thread::hardware_concurrency();
+	if( nthreads < 2 )
+		nthreads = 2;
+	if( nthreads > KC_MAX_THREADS )
+		nthreads = KC_MAX_THREADS;
+
+	t0 = wall_clock();
+
+	for(i=0; i < nthreads-1; i++)
+		workers[i] = std::thread(kc_worker, kc);
+
+	kc_worker(kc);
+
+	for(i=0; i < nthreads-1; i++)
+		workers[i].join();
+
+	seconds = wall_clock() - t0;
+
+	printf("threads=%d seeds=%d programs=%lld seconds=%.3f programs_per_sec=%.0f mismatches=%d\n",
+		nthreads, kc->nseeds, (long long) kc->compiled, seconds,
+		(seconds > 0) ? kc->compiled / seconds : 0.0, (int) kc->mismatches);
+
+	for(i=0; i < kc->nseeds; i++) {
+		kforth_delete(kc->programs[i]);
+		FREE(kc->texts[i]);
+	}
+	FREE(kc->texts);
+	FREE(kc->kfops);
+	FREE(kc->programs);
+	delete kc;
+
+	EvolvePreferences_Deinit(&ep);
 }
 
 static const char *grid_type_to_string(int type)
@@ -659,21 +2858,199 @@ static const char *grid_type_to_string(int type)
 	return "NOTREACHED";
 }
 
+typedef struct {
+	int		diffs;
+	char	*text;		// mismatch report for these rows
+	int		len;
+	int		alloc;
+} COMPARE_RESULT;
+
+static void compare_printf(COMPARE_RESULT *cr, const char *fmt, ...)
+{
+	va_list ap;
+	char buf[1000];
+	int len;
+
+	va_start(ap, fmt);
+	len = vsnprintf(buf, sizeof(buf), fmt, ap);
+	va_end(ap);
+
+	if( len >= (int) sizeof(buf) )
+		len = sizeof(buf)-1;
+
+	if( cr->len + len + 1 > cr->alloc ) {
+		cr->alloc = (cr->alloc == 0) ? 4096 : cr->alloc * 2;
+		if( cr->alloc < cr->len + len + 1 )
+			cr->alloc = cr->len + len + 1;
+		cr->text = (char *) REALLOC(cr->text, cr->alloc);
+		ASSERT( cr->text != NULL );
+	}
+
+	memcpy(cr->text + cr->len, buf, len+1);
+	cr->len += len;
+}
+
+/*
+ * What compare_rows() compares 'u1' against. If 'diff' is not NULL
+ * only the tiles marked in it are compared (the tile hashes say
+ * the other tiles are the same).
+ */
+typedef struct {
+	UNIVERSE			*u2;
+	UNIVERSE_TILE_HASH	*th;
+	char				*diff;
+} COMPARE_ARG;
+
+static void compare_rows(UNIVERSE *u1, int y1, int y2, void *acc, void *arg)
+{
+	COMPARE_RESULT *cr;
+	UNIVERSE *u2;
+	UNIVERSE_GRID ugrid1, ugrid2;
+	const char *type_string1, *type_string2;
+	int x, y;
+	CELL *c1, *c2;
+	ORGANISM *o1, *o2;
+	SPORE *s1, *s2;
+	COMPARE_ARG *ca;
+
+	cr = (COMPARE_RESULT *) acc;
+	ca = (COMPARE_ARG *) arg;
+	u2 = ca->u2;
+
+	for(y=y1; y < y2; y++) {
+		for(x=0; x < u1->width; x++) {
+			if( ca->diff != NULL
+					&& ! ca->diff[ (y / ca->th->tile_size) * ca->th->ntx + (x / ca->th->tile_size) ] )
+				continue;
+
+			Universe_Query(u1, x, y, &ugrid1);
+			Universe_Query(u2, x, y, &ugrid2);
+
+			if( ugrid1.type != ugrid2.type ) {
+				type_string1 = grid_type_to_string(ugrid1.type);
+				type_string2 = grid_type_to_string(ugrid2.type);
+
+				compare_printf(cr, "(%d, %d) type mismatch. '%s' != '%s'\n",
+					x, y, type_string1, type_string2);
+
+				cr->diffs++;
+
+				continue;
+			}
+
+			switch( ugrid1.type ) {
+			case GT_ORGANIC:
+				if( ugrid1.u.energy != ugrid2.u.energy ) {
+					compare_printf(cr, "(%d, %d) ORGANIC energy mismatch. '%d' != '%d'\n",
+						x, y, ugrid1.u.energy, ugrid2.u.energy);
+					cr->diffs++;
+					continue;
+				}
+				break;
+
+			case GT_CELL:
+				c1 = ugrid1.u.cell;
+				c2 = ugrid2.u.cell;
+				o1 = c1->organism;
+				o2 = c2->organism;
+				if( o1->energy != o2->energy ) {
+					compare_printf(cr, "(%d, %d) ORGANISM energy mismatch. '%d' != '%d'\n",
+						x, y, o1->energy, o2->energy);
+					cr->diffs++;
+					continue;
+				}
+				if( check_sum_stack(c1) != check_sum_stack(c2) ) {
+					compare_printf(cr, "(%d, %d) CELL stack mismatch.\n", x, y);
+					cr->diffs++;
+					continue;
+				}
+				break;
+
+			case GT_SPORE:
+				s1 = ugrid1.u.spore;
+				s2 = ugrid2.u.spore;
+				if( s1->energy != s2->energy ) {
+					compare_printf(cr, "(%d, %d) SPORE energy mismatch. '%d' != '%d'\n",
+						x, y, s1->energy, s2->energy);
+					cr->diffs++;
+					continue;
+				}
+				break;
+			}
+		}
+	}
+}
+
+static void compare_merge(void *acc, void *part, void *arg)
+{
+	COMPARE_RESULT *cr, *p;
+
+	cr = (COMPARE_RESULT *) acc;
+	p = (COMPARE_RESULT *) part;
+
+	if( p->len > 0 ) {
+		if( cr->len + p->len + 1 > cr->alloc ) {
+			cr->alloc = cr->len + p->len + 1;
+			cr->text = (char *) REALLOC(cr->text, cr->alloc);
+			ASSERT( cr->text != NULL );
+		}
+
+		memcpy(cr->text + cr->len, p->text, p->len+1);
+		cr->len += p->len;
+	}
+
+	cr->diffs += p->diffs;
+	FREE(p->text);
+}
+
+/*
+ * Mismatches are reported row by row (y, then x).
+ *
+ * When both files have TILE_HASH trailers, the trailers are compared
+ * first. Files with matching trailers are reported as the same without
+ * loading them, otherwise only the tiles that differ are compared.
+ */
 static void compare_universes(char *file1, char *file2)
 {
 	UNIVERSE *u1, *u2;
-	UNIVERSE_GRID ugrid1, ugrid2;
 	char errbuf[1000];
-	const char *type_string1, *type_string2;
-	int x, y;
-	int diffs;
-	CELL *c1, *c2;
-	ORGANISM *o1, *o2;
-	SPORE *s1, *s2;
+	COMPARE_RESULT cr;
+	COMPARE_ARG ca;
+	UNIVERSE_TILE_HASH *th1, *th2;
+	int ndiff, state_diff;
 
 	ASSERT( file1 != NULL );
 	ASSERT( file2 != NULL );
 
+	ca.u2 = NULL;
+	ca.th = NULL;
+	ca.diff = NULL;
+
+	th1 = Universe_ReadTileHash(file1, errbuf);
+	th2 = Universe_ReadTileHash(file2, errbuf);
+
+	if( th1 != NULL && th2 != NULL ) {
+		ca.diff = (char *) MALLOC(th1->ntx * th1->nty);
+		ASSERT( ca.diff != NULL );
+
+		if( Universe_Tile_Hash_Compare(th1, th2, ca.diff, &ndiff, &state_diff) ) {
+			if( ndiff == 0 && ! state_diff ) {
+				printf("Files are the same (tile hashes match)\n");
+				FREE(ca.diff);
+				Universe_Tile_Hash_Delete(th1);
+				Universe_Tile_Hash_Delete(th2);
+				return;
+			}
+
+			printf("Tile hashes: %d of %d tiles differ, state %s\n\n",
+				ndiff, th1->ntx * th1->nty, state_diff ? "differs" : "is the same");
+			ca.th = th1;
+		} else {
+			FREE(ca.diff);
+			ca.diff = NULL;
+		}
+	}
+
 	u1 = Universe_Read(file1, errbuf);
 	if( u1 == NULL ) {
 		usage(errbuf);
@@ -704,73 +3081,507 @@ static void compare_universes(char *file1, char *file2)
 		exit(1);
 	}
 
-	diffs = 0;
+	memset(&cr, 0, sizeof(cr));
+	ca.u2 = u2;
+	Grid_Reduce(u1, compare_rows, compare_merge, &cr, sizeof(cr), &ca);
 
-	for(x=0; x < u1->width; x++) {
-		for(y=0; y < u1->height; y++) {
-			Universe_Query(u1, x, y, &ugrid1);
-			Universe_Query(u2, x, y, &ugrid2);
+	if( cr.len > 0 ) {
+		fputs(cr.text, stdout);
+	}
 
-			if( ugrid1.type != ugrid2.type ) {
-				type_string1 = grid_type_to_string(ugrid1.type);
-				type_string2 = grid_type_to_string(ugrid2.type);
+	if( cr.diffs == 0 ) {
+		if( ca.th != NULL && state_diff ) {
+			printf("Grids are the same (organisms, programs or universe fields differ)\n");
+		} else {
+			printf("Files are the same\n");
+		}
+	}
 
-				printf("(%d, %d) type mismatch. '%s' != '%s'\n",
-					x, y, type_string1, type_string2);
+	FREE(cr.text);
+
+	if( ca.diff != NULL )
+		FREE(ca.diff);
+
+	if( th1 != NULL )
+		Universe_Tile_Hash_Delete(th1);
+
+	if( th2 != NULL )
+		Universe_Tile_Hash_Delete(th2);
+
+	Universe_Delete(u1);
+	Universe_Delete(u2);
+}
+
+/***********************************************************************
+ * DIVERGENCE BISECTION
+ *
+ * Find the first step where two builds of evolve_batch stop producing
+ * the same simulation (a refactored engine against the reference, or
+ * the same source built on two platforms).
+ *
+ * Both executables are run on the same input with "--verify-every" and
+ * their (step, hash) logs are compared. The first mismatch brackets
+ * the divergence between two logged steps 'lo' and 'hi'. The first
+ * executable then writes a checkpoint at 'lo', and both executables
+ * are run again from that checkpoint with a finer hash interval. This
+ * repeats until 'hi' is 'lo' + 1.
+ *
+ * At most about BISECT_POINTS hashes are logged per pass, so a
+ * divergence 'N' steps into the run is found in log10(N)/3 passes.
+ *
+ * Finally both executables simulate the one step from the 'lo'
+ * checkpoint, and the two results are compared here: universe fields,
+ * random number generator, organisms and every grid square that
+ * differs. The cell that executed during that step is printed too.
+ *
+ */
+#define BISECT_POINTS		1000
+#define BISECT_MAX_REPORT	20
+
+#ifdef __windows__
+#define popen	_popen
+#define pclose	_pclose
+#endif
+
+typedef struct {
+	int			len;
+	int			alloc;
+	LONG_LONG	*step;
+	uint64_t	*hash;
+} HASH_LOG;
+
+/*
+ * Run 'exe' on 'in_filename' for 'nsteps' steps, writing 'out_filename'.
+ * If 'every' > 0 the "Verify:" lines are collected in 'hl'.
+ * Returns the exit status of 'exe'.
+ */
+static int bisect_run(const char *exe, const char *in_filename, LONG_LONG nsteps,
+						const char *out_filename, LONG_LONG every, HASH_LOG *hl)
+{
+	char cmd[4000];
+	char line[1000];
+	FILE *fp;
+	long long step;
+	unsigned long long hash;
+
+	ASSERT( exe != NULL );
+	ASSERT( in_filename != NULL );
+	ASSERT( out_filename != NULL );
+	ASSERT( nsteps >= 0 );
+
+	if( every > 0 ) {
+		snprintf(cmd, sizeof(cmd), "\"%s\" s %lldu \"%s\" \"%s\" --verify-every %lld",
+				exe, (long long) nsteps, in_filename, out_filename, (long long) every);
+	} else {
+		snprintf(cmd, sizeof(cmd), "\"%s\" s %lldu \"%s\" \"%s\"",
+				exe, (long long) nsteps, in_filename, out_filename);
+	}
+
+	fp = popen(cmd, "r");
+	if( fp == NULL ) {
+		return -1;
+	}
+
+	while( fgets(line, sizeof(line), fp) != NULL ) {
+		if( hl == NULL )
+			continue;
+
+		if( sscanf(line, "Verify: step=%lld hash=%llx", &step, &hash) != 2 )
+			continue;
+
+		if( hl->len == hl->alloc ) {
+			hl->alloc = (hl->alloc == 0) ? 64 : hl->alloc * 2;
+			hl->step = (LONG_LONG *) REALLOC(hl->step, hl->alloc * sizeof(LONG_LONG));
+			hl->hash = (uint64_t *) REALLOC(hl->hash, hl->alloc * sizeof(uint64_t));
+		}
+		hl->step[hl->len] = step;
+		hl->hash[hl->len] = hash;
+		hl->len++;
+	}
+
+	return pclose(fp);
+}
+
+/*
+ * Smallest power of 10 that logs no more than BISECT_POINTS hashes over 'span' steps.
+ */
+static LONG_LONG bisect_interval(LONG_LONG span)
+{
+	LONG_LONG every;
+
+	every = 1;
+	while( span / every > BISECT_POINTS ) {
+		every *= 10;
+	}
+	return every;
+}
+
+static int programs_equal(KFORTH_PROGRAM *p1, KFORTH_PROGRAM *p2)
+{
+	int cb, len;
+
+	if( p1->nblocks != p2->nblocks || p1->nprotected != p2->nprotected )
+		return 0;
+
+	for(cb=0; cb < p1->nblocks; cb++) {
+		len = p1->block[cb][-1];
+		if( len != p2->block[cb][-1] )
+			return 0;
+
+		if( memcmp(p1->block[cb], p2->block[cb], len * sizeof(KFORTH_INTEGER)) != 0 )
+			return 0;
+	}
+	return 1;
+}
+
+static int cells_equal(CELL *c1, CELL *c2)
+{
+	KFORTH_MACHINE *m1, *m2;
+
+	m1 = &c1->kfm;
+	m2 = &c2->kfm;
+
+	return c1->organism->id == c2->organism->id
+		&& c1->mood == c2->mood
+		&& c1->message == c2->message
+		&& m1->loc.cb == m2->loc.cb
+		&& m1->loc.pc == m2->loc.pc
+		&& memcmp(m1->R, m2->R, sizeof(m1->R)) == 0
+		&& m1->csp == m2->csp
+		&& m1->dsp == m2->dsp
+		&& memcmp(m1->call_stack, m2->call_stack, m1->csp * sizeof(KFORTH_LOC)) == 0
+		&& memcmp(m1->data_stack, m2->data_stack, m1->dsp * sizeof(KFORTH_INTEGER)) == 0;
+}
+
+/*
+ * Describe the instruction 'c' will execute next.
+ */
+static void cell_opcode(UNIVERSE *u, CELL *c, char *buf, int size)
+{
+	KFORTH_PROGRAM *kfp;
+	KFORTH_OPERATIONS *kfops;
+	KFORTH_INTEGER opcode, value;
+	int cb, pc;
+
+	kfp = &c->organism->program;
+	kfops = &u->kfops[ c->organism->strain ];
+	cb = c->kfm.loc.cb;
+	pc = c->kfm.loc.pc;
+
+	if( kforth_machine_terminated(&c->kfm) ) {
+		snprintf(buf, size, "terminated");
+	} else if( cb >= kfp->nblocks ) {
+		snprintf(buf, size, "bad-cb");
+	} else if( pc >= kfp->block[cb][-1] ) {
+		snprintf(buf, size, "end-of-block");
+	} else {
+		opcode = kfp->block[cb][pc];
+		if( opcode & 0x8000 ) {
+			value = opcode & 0x7fff;
+			if( value & 0x4000 )
+				value |= 0x8000;
+			snprintf(buf, size, "%d", value);
+		} else if( opcode < kfops->count ) {
+			snprintf(buf, size, "%s", kfops->table[opcode].name);
+		} else {
+			snprintf(buf, size, "op#%d", opcode);
+		}
+	}
+}
+
+static void print_cell_state(const char *label, UNIVERSE *u, CELL *c)
+{
+	KFORTH_MACHINE *kfm;
+	char opbuf[100];
+	int i;
+
+	kfm = &c->kfm;
+	cell_opcode(u, c, opbuf, sizeof(opbuf));
+
+	printf("%s x=%d y=%d organism=%lld strain=%d cb=%d pc=%d opcode=%s mood=%d message=%d csp=%d dsp=%d R=",
+			label, c->x, c->y, (long long) c->organism->id, c->organism->strain,
+			kfm->loc.cb, kfm->loc.pc, opbuf, c->mood, c->message, kfm->csp, kfm->dsp);
+
+	for(i=0; i < 10; i++) {
+		printf("%s%d", (i == 0) ? "" : ",", kfm->R[i]);
+	}
+
+	printf(" dstack=");
+	for(i=0; i < kfm->dsp; i++) {
+		printf("%s%d", (i == 0) ? "" : ",", kfm->data_stack[i]);
+	}
+	printf("\n");
+}
+
+static void print_field_diff(const char *name, LONG_LONG v1, LONG_LONG v2)
+{
+	if( v1 != v2 ) {
+		printf("field=%s a=%lld b=%lld\n", name, (long long) v1, (long long) v2);
+	}
+}
+
+static void bisect_report(UNIVERSE *ulo, UNIVERSE *ua, UNIVERSE *ub)
+{
+	UNIVERSE_GRID ga, gb;
+	ORGANISM *oa, *ob;
+	CELL *ca, *cb;
+	int x, y, i, n, same;
+
+	ASSERT( ulo != NULL );
+	ASSERT( ua != NULL );
+	ASSERT( ub != NULL );
+
+	if( ulo->current_cell != NULL ) {
+		print_cell_state("executed", ulo, ulo->current_cell);
+	}
+
+	print_field_diff("step", ua->step, ub->step);
+	print_field_diff("age", ua->age, ub->age);
+	print_field_diff("next_id", ua->next_id, ub->next_id);
+	print_field_diff("norganism", ua->norganism, ub->norganism);
+	print_field_diff("nborn", ua->nborn, ub->nborn);
+	print_field_diff("ndie", ua->ndie, ub->ndie);
+	print_field_diff("G0", ua->G0, ub->G0);
+
+	n = 0;
+	for(i=0; i < EVOLVE_DEG4; i++) {
+		if( ua->er.state[i] != ub->er.state[i] )
+			n++;
+	}
+
+	printf("rng fidx_lo=%u ridx_lo=%u fidx_a=%u ridx_a=%u fidx_b=%u ridx_b=%u state_words_differ=%d\n",
+			ulo->er.fidx, ulo->er.ridx, ua->er.fidx, ua->er.ridx, ub->er.fidx, ub->er.ridx, n);
+
+	n = 0;
+	oa = ua->organisms;
+	ob = ub->organisms;
+	while( oa != NULL && ob != NULL && n < BISECT_MAX_REPORT ) {
+		same = oa->id == ob->id
+			&& oa->parent1 == ob->parent1
+			&& oa->parent2 == ob->parent2
+			&& oa->generation == ob->generation
+			&& oa->energy == ob->energy
+			&& oa->age == ob->age
+			&& oa->strain == ob->strain
+			&& oa->oflags == ob->oflags
+			&& oa->sim_count == ob->sim_count
+			&& oa->ncells == ob->ncells
+			&& programs_equal(&oa->program, &ob->program);
+
+		if( ! same ) {
+			printf("organism a_id=%lld b_id=%lld energy_a=%d energy_b=%d ncells_a=%d ncells_b=%d sim_count_a=%d sim_count_b=%d program_same=%d\n",
+				(long long) oa->id, (long long) ob->id, oa->energy, ob->energy, oa->ncells, ob->ncells,
+				oa->sim_count, ob->sim_count, programs_equal(&oa->program, &ob->program));
+			n++;
+		}
+		oa = oa->next;
+		ob = ob->next;
+	}
 
-				diffs++;
+	if( (oa == NULL) != (ob == NULL) ) {
+		printf("organism list lengths differ\n");
+	}
+
+	n = 0;
+	for(y=0; y < ua->height && n < BISECT_MAX_REPORT; y++) {
+		for(x=0; x < ua->width && n < BISECT_MAX_REPORT; x++) {
+			Grid_Get(ua, x, y, &ga);
+			Grid_Get(ub, x, y, &gb);
 
+			if( ga.type != gb.type ) {
+				printf("square x=%d y=%d a=%s b=%s\n", x, y,
+						grid_type_to_string(ga.type), grid_type_to_string(gb.type));
+				n++;
 				continue;
 			}
 
-			switch( ugrid1.type ) {
+			if( ga.odor != gb.odor ) {
+				printf("square x=%d y=%d odor_a=%d odor_b=%d\n", x, y, ga.odor, gb.odor);
+				n++;
+			}
+
+			switch( ga.type ) {
 			case GT_ORGANIC:
-				if( ugrid1.u.energy != ugrid2.u.energy ) {
-					printf("(%d, %d) ORGANIC energy mismatch. '%d' != '%d'\n",
-						x, y, ugrid1.u.energy, ugrid2.u.energy);
-					diffs++;
-					continue;
+				if( ga.u.energy != gb.u.energy ) {
+					printf("square x=%d y=%d organic_a=%d organic_b=%d\n", x, y, ga.u.energy, gb.u.energy);
+					n++;
 				}
 				break;
 
-			case GT_CELL:
-				c1 = ugrid1.u.cell;
-				c2 = ugrid2.u.cell;
-				o1 = c1->organism;
-				o2 = c2->organism;
-				if( o1->energy != o2->energy ) {
-					printf("(%d, %d) ORGANISM energy mismatch. '%d' != '%d'\n",
-						x, y, o1->energy, o2->energy);
-					diffs++;
-					continue;
-				}
-				if( check_sum_stack(c1) != check_sum_stack(c2) ) {
-					printf("(%d, %d) CELL stack mismatch.\n", x, y);
-					diffs++;
-					continue;
+			case GT_SPORE:
+				if( ga.u.spore->energy != gb.u.spore->energy
+						|| ga.u.spore->parent != gb.u.spore->parent
+						|| ga.u.spore->strain != gb.u.spore->strain
+						|| ga.u.spore->sflags != gb.u.spore->sflags
+						|| ! programs_equal(&ga.u.spore->program, &gb.u.spore->program) ) {
+					printf("square x=%d y=%d spore energy_a=%d energy_b=%d parent_a=%lld parent_b=%lld\n",
+						x, y, ga.u.spore->energy, gb.u.spore->energy,
+						(long long) ga.u.spore->parent, (long long) gb.u.spore->parent);
+					n++;
 				}
 				break;
 
-			case GT_SPORE:
-				s1 = ugrid1.u.spore;
-				s2 = ugrid2.u.spore;
-				if( s1->energy != s2->energy ) {
-					printf("(%d, %d) SPORE energy mismatch. '%d' != '%d'\n",
-						x, y, s1->energy, s2->energy);
-					diffs++;
-					continue;
+			case GT_CELL:
+				ca = ga.u.cell;
+				cb = gb.u.cell;
+				if( ! cells_equal(ca, cb) ) {
+					print_cell_state("cell_a", ua, ca);
+					print_cell_state("cell_b", ub, cb);
+					n++;
 				}
 				break;
+
+			default:
+				break;
 			}
 		}
 	}
 
-	if( diffs == 0 ) {
-		printf("Files are the same\n");
+	if( n == BISECT_MAX_REPORT ) {
+		printf("(stopped after %d differences)\n", BISECT_MAX_REPORT);
 	}
+}
 
-	Universe_Delete(u1);
-	Universe_Delete(u2);
+static void bisect(char *in_filename, char *exe1, char *exe2, char *time_spec, const char *scratch_dir)
+{
+	char errbuf[1000];
+	char start_filename[2][1000], a_filename[1000], b_filename[1000];
+	TIME_SPEC ts;
+	HASH_LOG hla, hlb;
+	UNIVERSE *ulo, *ua, *ub;
+	const char *cur_filename;
+	LONG_LONG cur_step, span, every, lo, hi;
+	int i, pass, status_a, status_b;
+
+	ASSERT( in_filename != NULL );
+	ASSERT( exe1 != NULL );
+	ASSERT( exe2 != NULL );
+	ASSERT( time_spec != NULL );
+	ASSERT( scratch_dir != NULL );
+
+	if( ! parse_time_spec(time_spec, &ts) || ts.step_mode != SM_STEP ) {
+		usage("Time spec for 'bisect' must be in steps ('u').");
+		exit(1);
+	}
+
+	snprintf(start_filename[0], sizeof(start_filename[0]), "%s/bisect_lo0.txt", scratch_dir);
+	snprintf(start_filename[1], sizeof(start_filename[1]), "%s/bisect_lo1.txt", scratch_dir);
+	snprintf(a_filename, sizeof(a_filename), "%s/bisect_a.txt", scratch_dir);
+	snprintf(b_filename, sizeof(b_filename), "%s/bisect_b.txt", scratch_dir);
+
+	ulo = Universe_Read(in_filename, errbuf);
+	if( ulo == NULL ) {
+		usage(errbuf);
+		exit(1);
+	}
+	cur_step = ulo->step;
+	Universe_Delete(ulo);
+
+	printf("input=%s a=%s b=%s steps=%d\n", in_filename, exe1, exe2, ts.value);
+
+	memset(&hla, 0, sizeof(hla));
+	memset(&hlb, 0, sizeof(hlb));
+
+	cur_filename = in_filename;
+	span = ts.value;
+
+	for(pass=0; ; pass++) {
+		every = bisect_interval(span);
+
+		hla.len = 0;
+		hlb.len = 0;
+		status_a = bisect_run(exe1, cur_filename, span, a_filename, every, &hla);
+		status_b = bisect_run(exe2, cur_filename, span, b_filename, every, &hlb);
+
+		printf("pass=%d from_step=%lld span=%lld every=%lld hashes_a=%d hashes_b=%d status_a=%d status_b=%d\n",
+				pass, (long long) cur_step, (long long) span, (long long) every, hla.len, hlb.len, status_a, status_b);
+
+		for(i=0; i < hla.len && i < hlb.len; i++) {
+			if( hla.step[i] != hlb.step[i] || hla.hash[i] != hlb.hash[i] )
+				break;
+		}
+
+		if( i == 0 ) {
+			if( hla.len == 0 || hlb.len == 0 ) {
+				printf("result=failed (no hashes logged, check both executables support --verify-every)\n");
+			} else {
+				printf("result=diverged step=%lld (the loaded universes already differ)\n", (long long) cur_step);
+			}
+			break;
+		}
+
+		if( i == hla.len && i == hlb.len ) {
+			if( pass == 0 ) {
+				printf("result=same steps=%lld hash=%016llx\n", (long long) hla.step[i-1], (unsigned long long) hla.hash[i-1]);
+			} else {
+				printf("result=not-reproducible (runs from the checkpoint at step %lld agree)\n", (long long) cur_step);
+			}
+			break;
+		}
+
+		if( i == hla.len || i == hlb.len ) {
+			printf("result=diverged after step=%lld (one executable stopped logging)\n", (long long) hla.step[i-1]);
+			break;
+		}
+
+		lo = hla.step[i-1];
+		hi = hla.step[i];
+
+		/*
+		 * Checkpoint the universe at 'lo', using the first executable
+		 */
+		if( lo > cur_step ) {
+			if( bisect_run(exe1, cur_filename, lo - cur_step, start_filename[pass % 2], 0, NULL) != 0 ) {
+				printf("result=failed (unable to checkpoint step %lld)\n", (long long) lo);
+				break;
+			}
+			cur_filename = start_filename[pass % 2];
+			cur_step = lo;
+		}
+
+		span = hi - lo;
+		if( span > 1 )
+			continue;
+
+		/*
+		 * Found it, both runs make step 'hi' from the same
+		 * universe. Load all three and compare.
+		 */
+		printf("result=diverged step=%lld\n", (long long) hi);
+
+		bisect_run(exe1, cur_filename, 1, a_filename, 0, NULL);
+		bisect_run(exe2, cur_filename, 1, b_filename, 0, NULL);
+
+		ulo = Universe_Read(cur_filename, errbuf);
+		ua = Universe_Read(a_filename, errbuf);
+		ub = Universe_Read(b_filename, errbuf);
+
+		if( ulo == NULL || ua == NULL || ub == NULL ) {
+			printf("unable to load step %lld/%lld checkpoints: %s\n", (long long) lo, (long long) hi, errbuf);
+		} else {
+			bisect_report(ulo, ua, ub);
+		}
+
+		if( ulo != NULL ) Universe_Delete(ulo);
+		if( ua != NULL ) Universe_Delete(ua);
+		if( ub != NULL ) Universe_Delete(ub);
+		break;
+	}
+
+	if( hla.alloc > 0 ) {
+		FREE(hla.step);
+		FREE(hla.hash);
+	}
+
+	if( hlb.alloc > 0 ) {
+		FREE(hlb.step);
+		FREE(hlb.hash);
+	}
+
+	remove(start_filename[0]);
+	remove(start_filename[1]);
+	remove(a_filename);
+	remove(b_filename);
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -897,6 +3708,9 @@ int main(int argc, char* argv[])
 	const char *filename;
 	int success;
 	FILE *fp;
+	LONG_LONG verify_every;
+	LONG_LONG delta_every;
+	TRIGGERS *tr;
 
 	if( argc == 1 ) {
 		usage("No arguments.");
@@ -912,18 +3726,46 @@ int main(int argc, char* argv[])
 		print_information(argv[2]);
 
 	} else if( strcmp(argv[1], "s") == 0 ) {
-		if( argc != 5 ) {
-			usage("'s' option must be followed by exactly 3 arguments.");
+		verify_every = parse_count_option(&argc, argv, "--verify-every");
+		if( verify_every < 0 ) {
+			usage("'--verify-every' must be followed by a positive number of steps.");
+			exit(1);
+		}
+		tr = parse_triggers(&argc, argv);
+		if( argc != 5 && argc != 6 ) {
+			usage("'s' option must be followed by 3 arguments (and an optional metrics file).");
 			exit(1);
 		}
-		simulate(argv[2], argv[3], argv[4]);
+		simulate(argv[2], argv[3], argv[4], (argc == 6) ? argv[5] : NULL, verify_every, tr);
+		triggers_delete(tr);
 		
 	} else if( strcmp(argv[1], "sf") == 0 ) {
-			if( argc != 5 ) {
-			 usage("'sf' option must be followed by exactly 3 arguments.");
+		verify_every = parse_count_option(&argc, argv, "--verify-every");
+		if( verify_every < 0 ) {
+			usage("'--verify-every' must be followed by a positive number of steps.");
+			exit(1);
+		}
+		delta_every = parse_count_option(&argc, argv, "--delta");
+		if( delta_every < 0 ) {
+			usage("'--delta' must be followed by a positive number of checkpoints.");
+			exit(1);
+		}
+		if( delta_every > EVOLVE_MAX_DELTA_EVERY ) {
+			snprintf(errbuf, sizeof(errbuf), "'--delta' can be at most %d.", EVOLVE_MAX_DELTA_EVERY);
+			usage(errbuf);
+			exit(1);
+		}
+		tr = parse_triggers(&argc, argv);
+			if( argc != 5 && argc != 6 ) {
+			 usage("'sf' option must be followed by 3 arguments (and an optional metrics file).");
 			 exit(1);
 		 }
-		 simulateForever(argv[2], argv[3], argv[4]);
+		if( delta_every > 1 && (strlen(argv[4]) < 4 || strcmp(argv[4] + strlen(argv[4]) - 4, ".txt") != 0) ) {
+			usage("'--delta' needs a .txt output file.");
+			exit(1);
+		}
+		 simulateForever(argv[2], argv[3], argv[4], (argc == 6) ? argv[5] : NULL, verify_every, (int)delta_every, tr);
+		 triggers_delete(tr);
 
 	} else if( strcmp(argv[1], "k") == 0 ) {
 		if( argc > 3 ) {
@@ -953,6 +3795,78 @@ int main(int argc, char* argv[])
 		}
 		compare_universes(argv[2], argv[3]);
 
+	} else if( strcmp(argv[1], "rc") == 0 ) {
+		if( argc != 3 && argc != 5 && argc != 6 ) {
+			usage("'rc' option must be followed by a simulation filename, and optionally x y [radius].");
+			exit(1);
+		}
+		if( argc == 3 ) {
+			random_creature(argv[2], 0, 0, 0, 0);
+		} else {
+			random_creature(argv[2], 1, atoi(argv[3]), atoi(argv[4]),
+						(argc == 6) ? atoi(argv[5]) : RC_RADIUS);
+		}
+
+	} else if( strcmp(argv[1], "1s") == 0 ) {
+		if( argc != 4 && argc != 5 ) {
+			usage("'1s' option must be followed by 2 arguments (and an optional step limit).");
+			exit(1);
+		}
+		one_strain(argv[2], argv[3], (argc == 5) ? argv[4] : NULL);
+
+	} else if( strcmp(argv[1], "tour") == 0 ) {
+		if( argc < 7 ) {
+			usage("'tour' option must be followed by a template, a step limit, N, and 2 or more seed files.");
+			exit(1);
+		}
+		tournament(argv[2], argv[3], atoi(argv[4]), argc-5, &argv[5]);
+
+	} else if( strcmp(argv[1], "prof") == 0 ) {
+		if( argc != 4 ) {
+			usage("'prof' option must be followed by exactly 2 arguments.");
+			exit(1);
+		}
+		profile_simulation(argv[2], argv[3]);
+
+	} else if( strcmp(argv[1], "kb") == 0 ) {
+		if( argc > 4 || (argc == 4 && strcmp(argv[3], "u") != 0) ) {
+			usage("'kb' option must be followed by nothing, a kforth file, or a kforth file and 'u'.");
+			exit(1);
+		} else if( argc == 2 ) {
+			kforth_microbench_stock();
+		} else {
+			filename = argv[2];
+			fp = fopen(filename, "r");
+			if( fp == NULL ) {
+				sprintf(errbuf, "%s: %s", filename, strerror(errno));
+				usage(errbuf);
+				exit(1);
+			}
+			kforth_microbench_snippet(fp, filename, (argc == 4));
+			fclose(fp);
+		}
+
+	} else if( strcmp(argv[1], "bench") == 0 ) {
+		if( argc > 3 ) {
+			usage("'bench' option must be followed by a scratch directory, or nothing.");
+			exit(1);
+		}
+		benchmark( (argc == 3) ? argv[2] : "." );
+
+	} else if( strcmp(argv[1], "kc") == 0 ) {
+		if( argc != 3 ) {
+			usage("'kc' option must be followed by the directory holding the seed files.");
+			exit(1);
+		}
+		compile_benchmark(argv[2]);
+
+	} else if( strcmp(argv[1], "bisect") == 0 ) {
+		if( argc != 6 && argc != 7 ) {
+			usage("'bisect' option must be followed by 4 arguments (and an optional scratch directory).");
+			exit(1);
+		}
+		bisect(argv[2], argv[3], argv[4], argv[5], (argc == 7) ? argv[6] : ".");
+
 	} else if( strcmp(argv[1], "t") == 0 ) {
 		if( argc != 6 ) {
 			usage("'t' option must be followed by exactly 4 arguments.");
@@ -966,7 +3880,7 @@ int main(int argc, char* argv[])
 		}
 
 	} else {
-		usage("First argument must be 'p' or 's' or 'sf' or 'k' or '='.");
+		usage("First argument must be 'p' or 's' or 'sf' or 'k' or 'kb' or '=' or 'prof' or 'bench' or 'kc' or 'bisect'.");
 		exit(1);
 	}
 
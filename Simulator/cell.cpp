@@ -312,7 +312,15 @@ static CELL *grid_has_our_cell(UNIVERSE *u, ORGANISM *o, int x, int y)
  *
  * Look Mode range  0000 - 1111, 0 - 15
  *
+ * LOOK_MODE is the compiled-in look_mode (just the LOOK_MODE_BITS this
+ * routine uses), or LOOK_MODE_ANY to use the 'look_mode' argument.
+ * If 'look_mode' no longer matches LOOK_MODE (the strain options were changed
+ * without calling EvolveOperations_Specialize()) the LOOK_MODE_ANY version is used.
+ *
  */
+#define LOOK_MODE_ANY	-1
+#define LOOK_MODE_BITS	(1|4)
+
 typedef struct {
 	int what;
 	int dist;
@@ -323,6 +331,7 @@ typedef struct {
 	int strain;
 } LOOK_RESULT;
 
+template <int LOOK_MODE>
 static void look_along_line(UNIVERSE *u, CELL *c, int look_mode, int xoffset, int yoffset, LOOK_RESULT *res)
 {
 	UNIVERSE_GRID ugrid;
@@ -337,6 +346,14 @@ static void look_along_line(UNIVERSE *u, CELL *c, int look_mode, int xoffset, in
 	ASSERT( !(xoffset == 0 && yoffset == 0) );
 	ASSERT( res != NULL );
 
+	if( LOOK_MODE != LOOK_MODE_ANY ) {
+		if( LOOK_MODE != (look_mode & LOOK_MODE_BITS) ) {
+			look_along_line<LOOK_MODE_ANY>(u, c, look_mode, xoffset, yoffset, res);
+			return;
+		}
+		look_mode = LOOK_MODE;
+	}
+
 	x = c->x;
 	y = c->y;
 
@@ -444,17 +461,18 @@ static void look_along_line(UNIVERSE *u, CELL *c, int look_mode, int xoffset, in
 
 /*
  * Fixed stack structure for use in mark_reachable_cells()
- * (approx. 1.2 MB of RAM)
+ * (approx. 1.2 MB of RAM, per thread, so that several universes
+ * can be simulated at once)
  */
 
 #define MRC_STACK_SIZE (EVOLVE_MAX_BOUNDS * 100)
 
-static struct {
+static thread_local struct {
 	short x;
 	short y;
 } mrc_stack[ MRC_STACK_SIZE ];
 
-static int mrc_sp;
+static thread_local int mrc_sp;
 
 static void mrc_empty_stack(void)
 {
@@ -709,7 +727,7 @@ static void create_spore(UNIVERSE *u, ORGANISM *o, int x, int y, int energy)
  *	6 - cell doesn't have at least 2 data stack element avail
  *
  */
-static int interrupt(CELL *cell, int intflags)
+static int interrupt(UNIVERSE *u, CELL *cell, int intflags)
 {
 	KFORTH_LOC loc;
 
@@ -748,6 +766,11 @@ static int interrupt(CELL *cell, int intflags)
 	loc.pc = cell->kfm.loc.pc - 1;			// the return from code block logic increments the pc.
 	Kforth_Call_Stack_Push(&cell->kfm, loc);
 
+	// the executing cell's stacks are counted by Universe_Simulate()
+	if( cell != u->current_cell ) {
+		u->totals.call_stack_nodes += 1;
+	}
+
 	// set location to (intflags, 0)
 	cell->kfm.loc.cb = intflags;
 	cell->kfm.loc.pc = 0;
@@ -755,6 +778,23 @@ static int interrupt(CELL *cell, int intflags)
 	return 0;
 }
 
+/*
+ * Kill the cell 'eatc' that was just eaten by 'cell'.
+ *
+ * If a cell eats itself, Universe_Simulate() will notice it
+ * terminated and count it, so don't count it twice.
+ */
+static void eat_terminate(CELL *cell, CELL *eatc)
+{
+	ASSERT( !Kforth_Machine_Terminated(&eatc->kfm) );
+
+	Kforth_Machine_Terminate(&eatc->kfm);
+
+	if( eatc != cell ) {
+		eatc->organism->ndead += 1;
+	}
+}
+
 /*
  * Organism 'o' is wanting to eat anything
  * in grid location (x,y)
@@ -908,14 +948,14 @@ static int eat(UNIVERSE *u, ORGANISM *o, CELL *cell, int eat_mode, int x, int y)
 
 		if( eat_mode & 512 ) {
 			if( eato->energy / eato->ncells == 0 ) {
-				Kforth_Machine_Terminate(&eatc->kfm);
+				eat_terminate(cell, eatc);
 			} else {
 				// interrupt
 				intflags = (u->strop[ eato->strain ].eat_mode >> 10) & 7;
-				interrupt(eatc, intflags);
+				interrupt(u, eatc, intflags);
 			}
 		} else {
-			Kforth_Machine_Terminate(&eatc->kfm);
+			eat_terminate(cell, eatc);
 		}
 
 		return energy;
@@ -1829,13 +1869,12 @@ static void Opcode_MAKE_ORGANIC(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, K
 	type = Grid_GetPtr(u, x, y, &ugrid);
 
 	if( type == GT_BLANK ) {
-		ugrid->type = GT_ORGANIC;
-		ugrid->u.energy = energy;
+		Grid_SetOrganic(u, x, y, energy);
 		o->energy -= energy;
 		Kforth_Data_Stack_Push(kfm, energy);
 
 	} else if( type == GT_ORGANIC ) {
-		ugrid->u.energy += energy;
+		Grid_SetOrganic(u, x, y, ugrid->u.energy + energy);
 		o->energy -= energy;
 		Kforth_Data_Stack_Push(kfm, energy);
 
@@ -1907,6 +1946,7 @@ static void Opcode_MAKE_BARRIER(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, K
 		} else {
 			ugrid->type = GT_BARRIER;
 			u->barrier_flag = 1;
+			GRID_DIRTY(u, x, y);
 			Kforth_Data_Stack_Push(kfm, 1);
 		}
 	} else if( type == GT_BARRIER ) {
@@ -1916,6 +1956,7 @@ static void Opcode_MAKE_BARRIER(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, K
 		} else {
 			ugrid->type = GT_BLANK;
 			u->barrier_flag = 1;
+			GRID_DIRTY(u, x, y);
 			Kforth_Data_Stack_Push(kfm, 1);
 		}
 	} else {
@@ -2018,14 +2059,7 @@ static void grow(KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data, in
 
 	o->ncells	+= 1;
 
-	ncell->u_next = u->cells;
-	ncell->u_prev = NULL;
-	if( u->cells ) {
-		u->cells->u_prev = ncell;
-	}
-	u->cells = ncell;
-
-	Grid_SetCell(u, ncell);
+	Schedule_Insert(u, ncell);
 
 	/*
 	 * Push 1 on Parent cell's data stack
@@ -2042,6 +2076,8 @@ static void grow(KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data, in
 		 */
 		Kforth_Data_Stack_Push(&ncell->kfm, -1);
 	}
+
+	Grid_SetCell(u, ncell);
 }
 
 /***********************************************************************
@@ -2222,7 +2258,7 @@ static int spawn(UNIVERSE *u, int spawn_mode, int x, int y, int energy, int stra
 	KFORTH_OPERATIONS *kfops1, *kfops2;
 	KFORTH_MUTATE_OPTIONS *kfmo;
 	ORGANISM *o;
-	int success, num_dstack;
+	int success, num_dstack, i;
 
 	ASSERT( u != NULL );
 	ASSERT( cell != NULL );
@@ -2258,7 +2294,17 @@ static int spawn(UNIVERSE *u, int spawn_mode, int x, int y, int energy, int stra
 	if( (spawn_mode & 8) == 0 ) {
 		// mutate program when mode bit-8 is OFF.
 		kfmo = &u->kfmo[o->strain];
-		kforth_mutate(kfops1, kfmo, &u->er, &np);
+		PHASE_BEGIN(u, PHASE_MUTATE);
+		kforth_mutate(kfops1, kfmo, &u->er, &u->kfms, &np);
+		PHASE_END(u);
+
+		/*
+		 * mutation may have deleted code block 'cb' (or enough
+		 * blocks before it), start the new cell at main instead.
+		 */
+		if( cb >= np.nblocks ) {
+			cb = 0;
+		}
 	}
 
 	no = (ORGANISM *) CALLOC(1, sizeof(ORGANISM));
@@ -2276,8 +2322,9 @@ static int spawn(UNIVERSE *u, int spawn_mode, int x, int y, int energy, int stra
 	num_dstack = ((spawn_mode >> 4) & 7);
 	num_dstack = (cell->kfm.dsp < num_dstack) ? cell->kfm.dsp : num_dstack;
 
-	nc->kfm.dsp = num_dstack;
-	memcpy(nc->kfm.data_stack, cell->kfm.data_stack + (cell->kfm.dsp - num_dstack), num_dstack * sizeof(KFORTH_INTEGER) );
+	for(i=cell->kfm.dsp - num_dstack; i < cell->kfm.dsp; i++) {
+		Kforth_Data_Stack_Push(&nc->kfm, cell->kfm.data_stack[i]);
+	}
 
 	nc->kfm.loc.cb = cb;
 	nc->kfm.loc.pc = 0;
@@ -2287,12 +2334,7 @@ static int spawn(UNIVERSE *u, int spawn_mode, int x, int y, int energy, int stra
 	nc->organism	= no;
 	nc->next	= NULL;
 
-	nc->u_next = u->cells;
-	nc->u_prev = NULL;
-	if( u->cells ) {
-		u->cells->u_prev = nc;
-	}
-	u->cells = nc;
+	Schedule_Insert(u, nc);
 
 	no->strain	= strain;
 	no->id		= u->next_id++;
@@ -2459,6 +2501,7 @@ static void Opcode_SPAWN(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_M
  * Look along (x, y) and return a 'what' value and a 'dist' value.
  *
  */
+template <int LOOK_MODE>
 static void Opcode_LOOK(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
 	CELL *cell;
@@ -2488,7 +2531,7 @@ static void Opcode_LOOK(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MA
 
 	look_mode = u->strop[o->strain].look_mode;
 
-	look_along_line(u, cell, look_mode, xoffset, yoffset, &res);
+	look_along_line<LOOK_MODE>(u, cell, look_mode, xoffset, yoffset, &res);
 
 	Kforth_Data_Stack_Push(kfm, res.what);
 	Kforth_Data_Stack_Push(kfm, res.dist);
@@ -2515,7 +2558,8 @@ enum {
 	ATTR_COLDEST,		// least energy for cell
 };
 
-static void generic_vision_search(KFORTH_MACHINE *kfm, int attribute, void *client_data)
+template <int ATTRIBUTE, int LOOK_MODE>
+static void generic_vision_search(KFORTH_MACHINE *kfm, void *client_data)
 {
 	static const int xoffset[8] = {  0,  1,  1,  1,  0, -1, -1, -1 };
 	static const int yoffset[8] = { -1, -1,  0,  1,  1,  1,  0, -1 };
@@ -2553,7 +2597,7 @@ static void generic_vision_search(KFORTH_MACHINE *kfm, int attribute, void *clie
 	u = cd->universe;
 	look_mode = u->strop[o->strain].look_mode;
 
-	switch( attribute ) {
+	switch( ATTRIBUTE ) {
 	case ATTR_NEAREST:
 		best_dist = EVOLVE_MAX_BOUNDS + 1000;
 		break;
@@ -2582,14 +2626,14 @@ static void generic_vision_search(KFORTH_MACHINE *kfm, int attribute, void *clie
 
 	found = 0;
 	for(i=0; i<8; i++) {
-		look_along_line(u, cell, look_mode, xoffset[dir], yoffset[dir], &res);
+		look_along_line<LOOK_MODE>(u, cell, look_mode, xoffset[dir], yoffset[dir], &res);
 
 		ASSERT( res.dist != 0 );
 		ASSERT( res.what != 0 );
 
 		if( (res.what & mask) ) {
 			found = 1;
-			switch( attribute ) {
+			switch( ATTRIBUTE ) {
 			case ATTR_NEAREST:
 				c = res.dist < best_dist;
 				break;
@@ -2640,9 +2684,10 @@ static void generic_vision_search(KFORTH_MACHINE *kfm, int attribute, void *clie
  *	  matches 'mask'.
  *
  */
+template <int LOOK_MODE>
 static void Opcode_NEAREST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	generic_vision_search(kfm, ATTR_NEAREST, client_data);
+	generic_vision_search<ATTR_NEAREST, LOOK_MODE>(kfm, client_data);
 }
 
 /***********************************************************************
@@ -2654,9 +2699,10 @@ static void Opcode_NEAREST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH
  * the farthest object matching the 'mask'.
  *
  */
+template <int LOOK_MODE>
 static void Opcode_FARTHEST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	generic_vision_search(kfm, ATTR_FARTHEST, client_data);
+	generic_vision_search<ATTR_FARTHEST, LOOK_MODE>(kfm, client_data);
 }
 
 /***********************************************************************
@@ -2666,6 +2712,7 @@ static void Opcode_FARTHEST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORT
  * Look along x,y. repost size and and distance to what was found.
  * Return 0 0 if nothing 
  */
+template <int LOOK_MODE>
 static void Opcode_SIZE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
 	CELL *cell;
@@ -2695,7 +2742,7 @@ static void Opcode_SIZE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MA
 		return;
 	}
 
-	look_along_line(u, cell, look_mode, xoffset, yoffset, &res);
+	look_along_line<LOOK_MODE>(u, cell, look_mode, xoffset, yoffset, &res);
 
 	value = (res.size < TOO_BIG) ? res.size : TOO_BIG;
 
@@ -2712,9 +2759,10 @@ static void Opcode_SIZE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MA
  *
  * Return 0,0 if nothing 
  */
+template <int LOOK_MODE>
 static void Opcode_BIGGEST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	generic_vision_search(kfm, ATTR_BIGGEST, client_data);
+	generic_vision_search<ATTR_BIGGEST, LOOK_MODE>(kfm, client_data);
 }
 
 /***********************************************************************
@@ -2724,9 +2772,10 @@ static void Opcode_BIGGEST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH
  * Look along in all 8 directions. Report the x,y vector to
  * the smallest thing. 'mask' filters on what to consider
  */
+template <int LOOK_MODE>
 static void Opcode_SMALLEST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	generic_vision_search(kfm, ATTR_SMALLEST, client_data);
+	generic_vision_search<ATTR_SMALLEST, LOOK_MODE>(kfm, client_data);
 }
 
 /***********************************************************************
@@ -2736,6 +2785,7 @@ static void Opcode_SMALLEST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORT
  * Look along x,y. repost energy level and and distance to what was found.
  * Return 0 0 if nothing 
  */
+template <int LOOK_MODE>
 static void Opcode_TEMPERATURE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
 	CELL *cell;
@@ -2766,7 +2816,7 @@ static void Opcode_TEMPERATURE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KF
 
 	look_mode = u->strop[o->strain].look_mode;
 
-	look_along_line(u, cell, look_mode, xoffset, yoffset, &res);
+	look_along_line<LOOK_MODE>(u, cell, look_mode, xoffset, yoffset, &res);
 
 	value = (res.energy < TOO_BIG) ? res.energy : TOO_BIG;
 
@@ -2782,9 +2832,10 @@ static void Opcode_TEMPERATURE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KF
  * 'mask' filters on what to consider.
  * Return 0,0 if nothing
  */
+template <int LOOK_MODE>
 static void Opcode_HOTTEST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	generic_vision_search(kfm, ATTR_HOTTEST, client_data);
+	generic_vision_search<ATTR_HOTTEST, LOOK_MODE>(kfm, client_data);
 }
 
 /***********************************************************************
@@ -2795,9 +2846,10 @@ static void Opcode_HOTTEST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH
  * 'mask' filters on what to consider.
  * Return 0,0 if nothing 
  */
+template <int LOOK_MODE>
 static void Opcode_COLDEST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	generic_vision_search(kfm, ATTR_COLDEST, client_data);
+	generic_vision_search<ATTR_COLDEST, LOOK_MODE>(kfm, client_data);
 }
 
 /***********************************************************************
@@ -2935,7 +2987,7 @@ static void Opcode_BROADCAST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFOR
 	for(ccurr=o->cells; ccurr; ccurr=ccurr->next) {
 		ccurr->message = value;
 		if( ccurr != cell ) {
-			interrupt(ccurr, broadcast_mode);
+			interrupt(u, ccurr, broadcast_mode);
 		}
 	}
 }
@@ -2975,7 +3027,7 @@ static void Opcode_SEND(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MA
 		c->message = message;
 
 		o_send_mode = u->strop[c->organism->strain].send_mode;
-		interrupt(c, o_send_mode);
+		interrupt(u, c, o_send_mode);
 	}
 }
 
@@ -3056,7 +3108,7 @@ static int shout(UNIVERSE *u, CELL *cell, int shout_mode, KFORTH_INTEGER message
 	c->message = message;
 
 	intflags = (shout_mode >> 4) & 7;
-	interrupt(c, intflags);
+	interrupt(u, c, intflags);
 
 	return 1;
 }
@@ -3153,7 +3205,7 @@ static void Opcode_LISTEN(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_
 		look_mode = 0;
 	}
 
-	look_along_line(u, cell, look_mode, xoffset, yoffset, &res);
+	look_along_line<LOOK_MODE_ANY>(u, cell, look_mode, xoffset, yoffset, &res);
 
 	value = res.mood;
 
@@ -3229,7 +3281,7 @@ static void Opcode_SAY(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MAC
 		look_mode = 0;
 	}
 
-	look_along_line(u, cell, look_mode, xoffset, yoffset, &res);
+	look_along_line<LOOK_MODE_ANY>(u, cell, look_mode, xoffset, yoffset, &res);
 
 	if( (res.what & VISION_TYPE_CELL) == 0 ) {
 		Kforth_Data_Stack_Push(kfm, 0);
@@ -3279,7 +3331,7 @@ static void Opcode_SAY(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MAC
 	ocell->message = value;
 
 	intflags = (o_say_mode >> 5) & 7;
-	interrupt(ocell, intflags);
+	interrupt(u, ocell, intflags);
 
 	Kforth_Data_Stack_Push(kfm, res.dist);
 }
@@ -3504,11 +3556,12 @@ static void Opcode_READ(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MA
 
 	if( (read_mode & 64) == 0 ) {
 		kfmo = &u->kfmo[org->strain];
-		kforth_mutate_cb(kfops, kfmo, &u->er, &new_block);
+		kforth_mutate_cb(kfops, kfmo, &u->er, &u->kfms, &new_block);
 	}
 
-	FREE( kfp->block[cbme]-1 );
-	kfp->block[cbme] = new_block;
+	kforth_program_replace_cb(kfp, cbme, new_block);
+
+	kforth_program_changed(kfp);
 
 	org->oflags |= ORGANISM_FLAG_READWRITE;
 
@@ -3543,7 +3596,7 @@ static void Opcode_WRITE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_M
 	KFORTH_OPERATIONS *okfops;
 	int xoffset, yoffset, x, y, pc, ostrain;
 	int success, write_mode, o_write_mode;
-	int cb, cbme, intflags, len, num_cnt;
+	int cb, cbme, intflags, len, num_cnt, delta;
 
 	cd = (CELL_CLIENT_DATA*)client_data;
 	cell = cd->cell;
@@ -3736,15 +3789,22 @@ static void Opcode_WRITE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_M
 
 	if( (write_mode & 64) == 0 ) {
 		kfmo = &u->kfmo[org->strain];
-		kforth_mutate_cb(okfops, kfmo, &u->er, &new_block);
+		kforth_mutate_cb(okfops, kfmo, &u->er, &u->kfms, &new_block);
 	}
 
-	FREE( okfp->block[cb]-1 );
-	okfp->block[cb] = new_block;
+	if( gt == GT_SPORE ) {
+		delta = new_block[-1] - okfp->block[cb][-1];
+		u->totals.spore_instructions += delta;
+		u->totals.spore_program_memory += delta * sizeof(KFORTH_INTEGER);
+	}
+
+	kforth_program_replace_cb(okfp, cb, new_block);
+
+	kforth_program_changed(okfp);
 
 	if( gt == GT_CELL ) {
 		intflags = (o_write_mode >> 7) & 7;
-		interrupt(ocell, intflags);
+		interrupt(u, ocell, intflags);
 		ocell->organism->oflags |= ORGANISM_FLAG_READWRITE;
 	}
 
@@ -3802,6 +3862,7 @@ static int take_energy(UNIVERSE *u, ORGANISM *o, int send_energy_mode, int x, in
 
 	if( gt == GT_SPORE ) {
 		ospore->energy -= energy;
+		u->totals.spore_energy -= energy;
 		o->energy += energy;
 
 		if( ospore->energy == 0 ) {
@@ -3817,7 +3878,7 @@ static int take_energy(UNIVERSE *u, ORGANISM *o, int send_energy_mode, int x, in
 		intflags = (o_send_energy_mode >> 7) & 7;
 
 		// interrupts
-		interrupt(ocell, intflags);
+		interrupt(u, ocell, intflags);
 	}
 
 	return energy;
@@ -3870,6 +3931,7 @@ static int give_energy(UNIVERSE *u, ORGANISM *o, int send_energy_mode, int x, in
 	if( gt == GT_SPORE ) {
 		o->energy -= energy;
 		ospore->energy += energy;
+		u->totals.spore_energy += energy;
 
 	} else {
 		o->energy -= energy;
@@ -3880,7 +3942,7 @@ static int give_energy(UNIVERSE *u, ORGANISM *o, int send_energy_mode, int x, in
 		intflags = (o_send_energy_mode >> 4) & 7;
 
 		// interrupts
-		interrupt(ocell, intflags);
+		interrupt(u, ocell, intflags);
 	}
 
 	return energy;
@@ -3957,7 +4019,7 @@ static void Opcode_SEND_ENERGY(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KF
 		}
 
 		look_mode = 1;
-		look_along_line(u, cell, look_mode, xoffset, yoffset, &res);
+		look_along_line<LOOK_MODE_ANY>(u, cell, look_mode, xoffset, yoffset, &res);
 
 		if( res.dist == 0 ) {
 			Kforth_Data_Stack_Push(kfm, 0);
@@ -4147,8 +4209,8 @@ static void Opcode_CHOOSE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_
 		return;
 	}
 
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 
 	value = (KFORTH_INTEGER) CHOOSE(&u->er, low, high);
 
@@ -4473,7 +4535,7 @@ static void interrupt_all(UNIVERSE *u, int flag)
 	if( ! needed )
 		return;
 
-	for(cell=u->cells; cell; cell=cell->u_next) {
+	for(cell=Schedule_First(u); cell; cell=Schedule_Next(u, cell)) {
 		strain = cell->organism->strain;
 		key_press_mode = u->strop[ strain ].key_press_mode;
 		if( flag == 0 ) {
@@ -4481,7 +4543,7 @@ static void interrupt_all(UNIVERSE *u, int flag)
 		} else {
 			intflags = (key_press_mode >> 3) & 7;
 		}
-		interrupt(cell, intflags);
+		interrupt(u, cell, intflags);
 	}
 }
 
@@ -4684,7 +4746,7 @@ void Universe_CellSensoryData(UNIVERSE *u, CELL *cell, CELL_SENSE_DATA *csd)
 		x = cell->x + xoffset[i];
 		y = cell->y + yoffset[i];
 
-		look_along_line(u, cell,  look_mode,  xoffset[i], yoffset[i], &res);
+		look_along_line<LOOK_MODE_ANY>(u, cell,  look_mode,  xoffset[i], yoffset[i], &res);
 
 		csd->dirs[i].what = res.what;
 		csd->dirs[i].dist = res.dist;
@@ -4741,15 +4803,15 @@ KFORTH_OPERATIONS *EvolveOperations(void)
 		kforth_ops_add(&kfops,	"GROW.CB",			3, 1,	Opcode_GROW_CB);
 		kforth_ops_add(&kfops,	"CSHIFT",			2, 1,	Opcode_CSHIFT);
 		kforth_ops_add(&kfops,	"EXUDE",			3, 0,	Opcode_EXUDE);
-		kforth_ops_add(&kfops,	"LOOK",				2, 2,	Opcode_LOOK);
-		kforth_ops_add(&kfops,	"NEAREST",			1, 2,	Opcode_NEAREST);
-		kforth_ops_add(&kfops,	"FARTHEST",			1, 2,	Opcode_FARTHEST);
-		kforth_ops_add(&kfops,	"SIZE",				2, 2,	Opcode_SIZE);
-		kforth_ops_add(&kfops,	"BIGGEST",			1, 2,	Opcode_BIGGEST);
-		kforth_ops_add(&kfops,	"SMALLEST",			1, 2,	Opcode_SMALLEST);
-		kforth_ops_add(&kfops,	"TEMPERATURE",		2, 2,	Opcode_TEMPERATURE);
-		kforth_ops_add(&kfops,	"HOTTEST",			1, 2,	Opcode_HOTTEST);
-		kforth_ops_add(&kfops,	"COLDEST",			1, 2,	Opcode_COLDEST);
+		kforth_ops_add(&kfops,	"LOOK",				2, 2,	Opcode_LOOK<LOOK_MODE_ANY>);
+		kforth_ops_add(&kfops,	"NEAREST",			1, 2,	Opcode_NEAREST<LOOK_MODE_ANY>);
+		kforth_ops_add(&kfops,	"FARTHEST",			1, 2,	Opcode_FARTHEST<LOOK_MODE_ANY>);
+		kforth_ops_add(&kfops,	"SIZE",				2, 2,	Opcode_SIZE<LOOK_MODE_ANY>);
+		kforth_ops_add(&kfops,	"BIGGEST",			1, 2,	Opcode_BIGGEST<LOOK_MODE_ANY>);
+		kforth_ops_add(&kfops,	"SMALLEST",			1, 2,	Opcode_SMALLEST<LOOK_MODE_ANY>);
+		kforth_ops_add(&kfops,	"TEMPERATURE",		2, 2,	Opcode_TEMPERATURE<LOOK_MODE_ANY>);
+		kforth_ops_add(&kfops,	"HOTTEST",			1, 2,	Opcode_HOTTEST<LOOK_MODE_ANY>);
+		kforth_ops_add(&kfops,	"COLDEST",			1, 2,	Opcode_COLDEST<LOOK_MODE_ANY>);
 		kforth_ops_add(&kfops,	"SMELL",			2, 1,	Opcode_SMELL);
 		kforth_ops_add(&kfops,	"MOOD",				2, 1,	Opcode_MOOD);
 		kforth_ops_add(&kfops,	"MOOD!",			1, 0,	Opcode_SET_MOOD);
@@ -4788,7 +4850,93 @@ KFORTH_OPERATIONS *EvolveOperations(void)
 		for(i=0; i < kfops.count; i++) {
 			kfops.table[i].key = 1000 + i;
 		}
+
+		// every name must be in the opcode name hash (kforth_opcode_hash.cpp)
+		ASSERT( kfops.nunhashed == 0 );
 	}
 
 	return &kfops;
 }
+
+/*
+ * The vision instructions, compiled for each look_mode.
+ * 'func[LOOK_MODE_INDEX(look_mode)]' is the version for 'look_mode'.
+ */
+#define LOOK_MODE_INDEX(m)		( ((m) & 1) | (((m) & 4) >> 1) )
+#define LOOK_MODE_VERSIONS(op)	{ op<0>, op<1>, op<4>, op<5> }
+
+static const struct {
+	const char		*name;
+	KFORTH_FUNCTION	any;
+	KFORTH_FUNCTION	func[4];
+} vision_operations[] = {
+	{ "LOOK",			Opcode_LOOK<LOOK_MODE_ANY>,			LOOK_MODE_VERSIONS(Opcode_LOOK)			},
+	{ "NEAREST",		Opcode_NEAREST<LOOK_MODE_ANY>,		LOOK_MODE_VERSIONS(Opcode_NEAREST)		},
+	{ "FARTHEST",		Opcode_FARTHEST<LOOK_MODE_ANY>,		LOOK_MODE_VERSIONS(Opcode_FARTHEST)		},
+	{ "SIZE",			Opcode_SIZE<LOOK_MODE_ANY>,			LOOK_MODE_VERSIONS(Opcode_SIZE)			},
+	{ "BIGGEST",		Opcode_BIGGEST<LOOK_MODE_ANY>,		LOOK_MODE_VERSIONS(Opcode_BIGGEST)		},
+	{ "SMALLEST",		Opcode_SMALLEST<LOOK_MODE_ANY>,		LOOK_MODE_VERSIONS(Opcode_SMALLEST)		},
+	{ "TEMPERATURE",	Opcode_TEMPERATURE<LOOK_MODE_ANY>,	LOOK_MODE_VERSIONS(Opcode_TEMPERATURE)	},
+	{ "HOTTEST",		Opcode_HOTTEST<LOOK_MODE_ANY>,		LOOK_MODE_VERSIONS(Opcode_HOTTEST)		},
+	{ "COLDEST",		Opcode_COLDEST<LOOK_MODE_ANY>,		LOOK_MODE_VERSIONS(Opcode_COLDEST)		},
+	{ NULL }
+};
+
+/***********************************************************************
+ * Make 'kfops' (a strain's instruction table) use the versions of the
+ * vision instructions compiled for the strain's look_mode, so they don't
+ * test the look_mode bits on every call.
+ *
+ * EvolveOperations() has the LOOK_MODE_ANY versions, which read the
+ * strain options each time. Call this again whenever the strain
+ * options or the instruction table of the strain are changed. If that is
+ * missed (say a caller changes the look_mode through Universe_get_ith_strop())
+ * the specialized versions see the new look_mode and fall back to LOOK_MODE_ANY,
+ * so the results are still right, only slower.
+ *
+ * Instructions that were replaced with other functions, or removed from
+ * the strain, are left alone.
+ *
+ */
+void EvolveOperations_Specialize(KFORTH_OPERATIONS *kfops, STRAIN_OPTIONS *strop)
+{
+	KFORTH_OPERATION *kfop;
+	int i, j, idx, m, known;
+
+	ASSERT( kfops != NULL );
+	ASSERT( strop != NULL );
+
+	m = LOOK_MODE_INDEX(strop->look_mode);
+
+	for(i=0; vision_operations[i].name != NULL; i++) {
+		idx = kforth_ops_find(kfops, vision_operations[i].name);
+		if( idx < 0 )
+			continue;
+
+		kfop = kforth_ops_get(kfops, idx);
+		known = (kfop->func == vision_operations[i].any);
+		for(j=0; j < 4; j++) {
+			known |= (kfop->func == vision_operations[i].func[j]);
+		}
+
+		if( ! known )
+			continue;
+
+		kforth_ops_set_function(kfops, vision_operations[i].name, vision_operations[i].func[m]);
+	}
+}
+
+/***********************************************************************
+ * EvolveOperations_Specialize() for every strain of 'u'.
+ *
+ */
+void Universe_Specialize_Operations(UNIVERSE *u)
+{
+	int i;
+
+	ASSERT( u != NULL );
+
+	for(i=0; i < EVOLVE_MAX_STRAINS; i++) {
+		EvolveOperations_Specialize(&u->kfops[i], &u->strop[i]);
+	}
+}
@@ -15,8 +15,8 @@
 //
 static void dummy_CMOVE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
 
@@ -25,8 +25,8 @@ static void dummy_CMOVE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MA
 //
 static void dummy_OMOVE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
 
@@ -35,7 +35,7 @@ static void dummy_OMOVE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MA
 //
 static void dummy_ROTATE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
 
@@ -44,8 +44,8 @@ static void dummy_ROTATE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_M
 //
 static void dummy_EAT(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
 
@@ -54,9 +54,9 @@ static void dummy_EAT(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACH
 //
 static void dummy_SEND_ENERGY(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
 
@@ -65,9 +65,9 @@ static void dummy_SEND_ENERGY(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFO
 //
 static void dummy_MAKE_SPORE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
 
@@ -76,8 +76,8 @@ static void dummy_MAKE_SPORE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFOR
 //
 static void dummy_GROW(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
 
@@ -86,8 +86,8 @@ static void dummy_GROW(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MAC
 //
 static void dummy_LOOK(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
@@ -97,7 +97,7 @@ static void dummy_LOOK(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MAC
 //
 static void dummy_NEAREST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
@@ -107,7 +107,7 @@ static void dummy_NEAREST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_
 //
 static void dummy_FARTHEST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
@@ -117,8 +117,8 @@ static void dummy_FARTHEST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH
 //
 static void dummy_MOOD(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
 
@@ -127,7 +127,7 @@ static void dummy_MOOD(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MAC
 //
 static void dummy_SET_MOOD(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 }
 
 //
@@ -135,7 +135,7 @@ static void dummy_SET_MOOD(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH
 //
 static void dummy_BROADCAST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 }
 
 //
@@ -143,9 +143,9 @@ static void dummy_BROADCAST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORT
 //
 static void dummy_SEND(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 }
 
 //
@@ -185,8 +185,8 @@ static void dummy_NUM_CELLS(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORT
 //
 static void dummy_HAS_NEIGHBOR(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
 
@@ -195,9 +195,9 @@ static void dummy_HAS_NEIGHBOR(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KF
 //
 static void dummy_MAKE_ORGANIC(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
 
@@ -206,9 +206,9 @@ static void dummy_MAKE_ORGANIC(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KF
 //
 static void dummy_GROW_CB(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
 
@@ -217,8 +217,8 @@ static void dummy_GROW_CB(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_
 //
 static void dummy_CSHIFT(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
 
@@ -227,11 +227,11 @@ static void dummy_CSHIFT(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_M
 //
 static void dummy_SPAWN(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
 
@@ -240,8 +240,8 @@ static void dummy_SPAWN(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MA
 //
 static void dummy_MAKE_BARRIER(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
 
@@ -250,8 +250,8 @@ static void dummy_MAKE_BARRIER(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KF
 //
 static void dummy_SIZE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
@@ -261,7 +261,7 @@ static void dummy_SIZE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MAC
 //
 static void dummy_BIGGEST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
@@ -271,7 +271,7 @@ static void dummy_BIGGEST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_
 //
 static void dummy_SMALLEST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
@@ -281,8 +281,8 @@ static void dummy_SMALLEST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH
 //
 static void dummy_TEMPERATURE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
@@ -292,7 +292,7 @@ static void dummy_TEMPERATURE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFO
 //
 static void dummy_HOTTEST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
@@ -302,7 +302,7 @@ static void dummy_HOTTEST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_
 //
 static void dummy_COLDEST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
@@ -312,7 +312,7 @@ static void dummy_COLDEST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_
 //
 static void dummy_SHOUT(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
 
@@ -321,9 +321,9 @@ static void dummy_SHOUT(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MA
 //
 static void dummy_SAY(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
 
@@ -332,8 +332,8 @@ static void dummy_SAY(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACH
 //
 static void dummy_LISTEN(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
@@ -343,10 +343,10 @@ static void dummy_LISTEN(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_M
 //
 static void dummy_READ(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
 
@@ -355,10 +355,10 @@ static void dummy_READ(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MAC
 //
 static void dummy_WRITE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
 
@@ -367,9 +367,9 @@ static void dummy_WRITE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MA
 //
 static void dummy_EXUDE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 }
 
 //
@@ -377,8 +377,8 @@ static void dummy_EXUDE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MA
 //
 static void dummy_SMELL(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
 
@@ -395,7 +395,7 @@ static void dummy_G0(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHI
 //
 static void dummy_SET_G0(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 }
 
 //
@@ -411,7 +411,7 @@ static void dummy_S0(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHI
 //
 static void dummy_SET_S0(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 }
 
 //
@@ -469,8 +469,8 @@ static void dummy_MOUSE_POS(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORT
 //
 static void dummy_DIST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
 
@@ -479,8 +479,8 @@ static void dummy_DIST(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MAC
 //
 static void dummy_CHOOSE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, 0);
 }
 
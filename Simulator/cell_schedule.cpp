@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2022 Ken Stauffer
+ */
+
+/***********************************************************************
+ * CELL SCHEDULE
+ *
+ * Keeps the simulation order for all the cells in the universe as a
+ * dense array of cell pointers (see CELL_SCHEDULE in evolve_simulator.h).
+ *
+ * Walking an array instead of chasing a linked list through cells
+ * scattered all over the heap lets us look ahead and prefetch the
+ * machine state of the cells that will be simulated next.
+ *
+ */
+#include "evolve_simulator.h"
+#include "evolve_simulator_private.h"
+
+#define SCHEDULE_INITIAL_ALLOC	1024
+
+/*
+ * How many slots ahead of the current cell to prefetch.
+ */
+#define SCHEDULE_PREFETCH_AHEAD	2
+
+/***********************************************************************
+ * Add 'cell' to the schedule. It will be the first cell
+ * simulated when the next age begins.
+ *
+ */
+void Schedule_Insert(UNIVERSE *u, CELL *cell)
+{
+	CELL_SCHEDULE *cs;
+
+	ASSERT( u != NULL );
+	ASSERT( cell != NULL );
+
+	cs = &u->sched;
+
+	if( cs->len == cs->alloc ) {
+		cs->alloc = (cs->alloc == 0) ? SCHEDULE_INITIAL_ALLOC : cs->alloc * 2;
+		cs->slot = (CELL **) REALLOC(cs->slot, cs->alloc * sizeof(CELL*));
+		ASSERT( cs->slot != NULL );
+	}
+
+	cell->sidx = cs->len;
+	cs->slot[ cs->len++ ] = cell;
+}
+
+/***********************************************************************
+ * Remove 'cell' from the schedule, leaving a tombstone in its slot.
+ *
+ * The caller is responsible for moving u->current_cell off of 'cell'
+ * (see Schedule_Next) before calling this.
+ *
+ */
+void Schedule_Remove(UNIVERSE *u, CELL *cell)
+{
+	CELL_SCHEDULE *cs;
+
+	ASSERT( u != NULL );
+	ASSERT( cell != NULL );
+
+	cs = &u->sched;
+
+	ASSERT( cell->sidx >= 0 && cell->sidx < cs->len );
+	ASSERT( cs->slot[cell->sidx] == cell );
+
+	cs->slot[cell->sidx] = NULL;
+	cs->ntomb += 1;
+	cell->sidx = -1;
+}
+
+/***********************************************************************
+ * Return the first cell to be simulated in an age. NULL if there
+ * are no cells.
+ *
+ */
+CELL *Schedule_First(UNIVERSE *u)
+{
+	CELL_SCHEDULE *cs;
+	int i;
+
+	ASSERT( u != NULL );
+
+	cs = &u->sched;
+
+	for(i=cs->len-1; i >= 0; i--) {
+		if( cs->slot[i] != NULL )
+			return cs->slot[i];
+	}
+
+	return NULL;
+}
+
+/***********************************************************************
+ * Return the cell that gets simulated after 'cell', or NULL
+ * if 'cell' is the last cell of this age.
+ *
+ * 'cell' must still be in the schedule.
+ *
+ */
+CELL *Schedule_Next(UNIVERSE *u, CELL *cell)
+{
+	CELL_SCHEDULE *cs;
+	int i;
+
+	ASSERT( u != NULL );
+	ASSERT( cell != NULL );
+
+	cs = &u->sched;
+
+	ASSERT( cell->sidx >= 0 && cell->sidx < cs->len );
+
+	for(i=cell->sidx-1; i >= 0; i--) {
+		if( cs->slot[i] != NULL )
+			return cs->slot[i];
+	}
+
+	return NULL;
+}
+
+/***********************************************************************
+ * Squeeze out the tombstones. The relative order of the
+ * remaining cells is preserved.
+ *
+ */
+void Schedule_Compact(UNIVERSE *u)
+{
+	CELL_SCHEDULE *cs;
+	CELL *cell;
+	int i, j;
+
+	ASSERT( u != NULL );
+
+	cs = &u->sched;
+
+	if( cs->ntomb == 0 )
+		return;
+
+	j = 0;
+	for(i=0; i < cs->len; i++) {
+		cell = cs->slot[i];
+		if( cell == NULL )
+			continue;
+
+		cell->sidx = j;
+		cs->slot[j++] = cell;
+	}
+
+	ASSERT( j == cs->len - cs->ntomb );
+
+	cs->len = j;
+	cs->ntomb = 0;
+}
+
+/***********************************************************************
+ * 'cell' is about to be simulated. Prefetch the machine
+ * state for a cell that will be simulated shortly after it.
+ *
+ */
+void Schedule_Prefetch(UNIVERSE *u, CELL *cell)
+{
+	CELL_SCHEDULE *cs;
+	CELL *ahead;
+	int i;
+
+	cs = &u->sched;
+
+	i = cell->sidx - SCHEDULE_PREFETCH_AHEAD;
+	if( i < 0 )
+		return;
+
+	ahead = cs->slot[i];
+	if( ahead != NULL ) {
+		PREFETCH(&ahead->kfm);
+	}
+}
+
+/***********************************************************************
+ * Free the schedule memory (does not free the cells).
+ *
+ */
+void Schedule_Deinit(UNIVERSE *u)
+{
+	ASSERT( u != NULL );
+
+	FREE(u->sched.slot);
+
+	u->sched.slot = NULL;
+	u->sched.len = 0;
+	u->sched.alloc = 0;
+	u->sched.ntomb = 0;
+}
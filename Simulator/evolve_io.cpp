@@ -53,3 +53,30 @@ int Universe_Write(UNIVERSE *u, const char *filename, char *errbuf)
 		return NULL;
 	}
 }
+
+/*
+ * Write a delta checkpoint: only the tiles of the grid that changed since
+ * u->dirty_tiles was last cleared are written, the rest are found in
+ * 'base_filename' when the file is read (see evolve_io_ascii.cpp).
+ * 'base_filename' is relative to the directory 'filename' is in.
+ * 'every' is how often a full checkpoint is written, so readers can
+ * reject chains of deltas longer than that.
+ */
+int Universe_WriteDelta(UNIVERSE *u, const char *filename, const char *base_filename, int every, char *errbuf)
+{
+	const char *ext;
+
+	ASSERT( u != NULL );
+	ASSERT( filename != NULL );
+	ASSERT( base_filename != NULL );
+	ASSERT( errbuf != NULL );
+
+	ext = strrchr(filename, '.');
+
+	if( ext != NULL && stricmp(ext, ".txt") == 0 ) {
+		return Universe_WriteAsciiDelta(u, filename, base_filename, every, errbuf);
+	} else {
+		strcpy(errbuf, "delta checkpoints must be .txt files");
+		return 0;
+	}
+}
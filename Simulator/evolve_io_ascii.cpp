@@ -24,6 +24,22 @@
  *
  *	4. And lastly, CELL_LIST should be at the end.
  *
+ *	5. Except for the TILE_HASH trailer, which follows CELL_LIST. It is not needed
+ *		to load the universe, it lets tools compare files without loading them
+ *		(see Universe_ReadTileHash).
+ *
+ * DELTA CHECKPOINTS:
+ * A delta checkpoint starts with DELTA_UNIVERSE instead of UNIVERSE (same
+ * fields), so readers that don't know about deltas reject the file rather
+ * than load half a grid. DELTA_UNIVERSE and DELTA always come together.
+ * A file with a DELTA instance only has the organic, barriers and odor for
+ * the tiles listed in DELTA.TILES. Everything else in the file is complete.
+ * The other tiles come from the BASE file (which can be a delta itself),
+ * named relative to the directory of this file. The reader loads the base,
+ * copies the missing tiles, and checks the result against TILE_HASH.
+ * DELTA.EVERY is the writer's delta_every: a chain of deltas longer than
+ * EVERY-1 (or EVOLVE_MAX_DELTA_EVERY-1) is rejected.
+ *
  */
 #include "evolve_simulator.h"
 #include "evolve_simulator_private.h"
@@ -189,6 +205,23 @@ static const char *prolog4[] = {
 	"	S0[N] { V }"
 	"}",
 	"",
+	"struct DELTA_UNIVERSE {    # UNIVERSE of a delta checkpoint",
+	"	SEED",
+	"	STEP",
+	"	AGE",
+	"	CURRENT_CELL { X Y }",
+	"	NEXT_ID",
+	"	NBORN",
+	"	NDIE",
+	"	WIDTH",
+	"	HEIGHT",
+	"	G0",
+	"	KEY",
+	"	MOUSE_X",
+	"	MOUSE_Y",
+	"	S0[N] { V }",
+	"}",
+	"",
 	"struct CELL_LIST[N] {",
 	"	X Y ",
 	"}",
@@ -197,6 +230,24 @@ static const char *prolog4[] = {
 	"	X Y LEN VALUE",
 	"}",
 	"",
+	"struct DELTA {",
+	"	BASE",
+	"	EVERY",
+	"	TILES[N] {",
+	"		INDEX",
+	"	}",
+	"}",
+	"",
+	"struct TILE_HASH {",
+	"	SIZE",
+	"	NX",
+	"	NY",
+	"	STATE",
+	"	TILES[N] {",
+	"		VALUE",
+	"	}",
+	"}",
+	"",
 };
 
 static const char *prolog5[] = {
@@ -286,6 +337,21 @@ static void write_prolog(PHASCII_FILE pf)
 	}
 }
 
+/*
+ * Is (x,y) in one of the 'tiles' being written? A NULL 'tiles' means all of them.
+ */
+static int tile_wanted(UNIVERSE *u, const unsigned char *tiles, int x, int y)
+{
+	int ntx;
+
+	if( tiles == NULL )
+		return 1;
+
+	ntx = (u->width + UNIVERSE_TILE_SIZE - 1) / UNIVERSE_TILE_SIZE;
+
+	return tiles[ (y / UNIVERSE_TILE_SIZE) * ntx + (x / UNIVERSE_TILE_SIZE) ];
+}
+
 static void write_spore(UNIVERSE *u, PHASCII_FILE pf, int x, int y, SPORE *spore)
 {
 	KFORTH_DISASSEMBLY *kfd;
@@ -342,9 +408,9 @@ static void write_spores(PHASCII_FILE pf, UNIVERSE *u)
 }
 
 /*
- * Write out barrier elements
+ * Write out barrier elements (only those in 'tiles', if not NULL)
  */
-static void write_barriers(PHASCII_FILE pf, UNIVERSE *u)
+static void write_barriers(PHASCII_FILE pf, UNIVERSE *u, const unsigned char *tiles)
 {
 	int x, y, n;
 	GRID_TYPE type;
@@ -365,6 +431,9 @@ static void write_barriers(PHASCII_FILE pf, UNIVERSE *u)
 			if( type != GT_BARRIER )
 				continue;
 
+			if( ! tile_wanted(u, tiles, x, y) )
+				continue;
+
 			if( n >= 500 ) {
 				n = 0;
 				Phascii_Printf(pf, "}\n");
@@ -399,7 +468,11 @@ static void write_odor_map_item(PHASCII_FILE pf, int *state, int x, int y, int l
 	Phascii_Printf(pf, "\t%4d %-4d  %4d  %d\n", x, y, len, (int)value);
 }
 
-static void write_odor_map(PHASCII_FILE pf, UNIVERSE *u)
+/*
+ * Write the odor map (only the tiles in 'tiles', if not NULL).
+ * When writing some tiles, runs stop at tile edges.
+ */
+static void write_odor_map(PHASCII_FILE pf, UNIVERSE *u, const unsigned char *tiles)
 {
 	int x, y, nx, len;
 	int state;
@@ -413,11 +486,19 @@ static void write_odor_map(PHASCII_FILE pf, UNIVERSE *u)
 	{
 		for(x=0; x < u->width; x += len)
 		{
+			if( ! tile_wanted(u, tiles, x, y) ) {
+				len = UNIVERSE_TILE_SIZE - (x % UNIVERSE_TILE_SIZE);
+				continue;
+			}
+
 			Grid_GetPtr(u, x, y, &ugp);
 			the_odor = ugp->odor;
 
 			nx = x + 1;
 			while( nx < u->width ) {
+				if( tiles != NULL && (nx % UNIVERSE_TILE_SIZE) == 0 ) {
+					break;
+				}
 				Grid_GetPtr(u, nx, y, &ugp);
 				if( ugp->odor != the_odor ) {
 					break;
@@ -438,42 +519,141 @@ static void write_odor_map(PHASCII_FILE pf, UNIVERSE *u)
 	Phascii_Printf(pf, "\n");
 }
 
+typedef struct {
+	int		x;
+	int		y;
+	int		energy;
+} ORGANIC_ITEM;
+
+typedef struct {
+	ORGANIC_ITEM	*items;
+	int				n;
+	int				alloc;
+} ORGANIC_LIST;
+
 /*
- * Write out organic material
+ * 'arg' is the 'tiles' argument of write_organic()
  */
-static void write_organic(PHASCII_FILE pf, UNIVERSE *u)
+static void organic_rows(UNIVERSE *u, int y1, int y2, void *acc, void *arg)
 {
-	int x, y, n;
-	GRID_TYPE type;
+	ORGANIC_LIST *ol;
 	UNIVERSE_GRID ugrid;
+	int x, y;
+
+	ol = (ORGANIC_LIST *) acc;
+
+	for(y=y1; y < y2; y++) {
+		for(x=0; x < u->width; x++) {
+			if( Grid_Get(u, x, y, &ugrid) != GT_ORGANIC )
+				continue;
+
+			if( ! tile_wanted(u, (const unsigned char *) arg, x, y) )
+				continue;
+
+			if( ol->n == ol->alloc ) {
+				ol->alloc = (ol->alloc == 0) ? 1024 : ol->alloc * 2;
+				ol->items = (ORGANIC_ITEM *) REALLOC(ol->items, ol->alloc * sizeof(ORGANIC_ITEM));
+				ASSERT( ol->items != NULL );
+			}
+
+			ol->items[ol->n].x		= x;
+			ol->items[ol->n].y		= y;
+			ol->items[ol->n].energy	= ugrid.u.energy;
+			ol->n++;
+		}
+	}
+}
+
+static void organic_merge(void *acc, void *part, void *arg)
+{
+	ORGANIC_LIST *ol, *p;
+
+	ol = (ORGANIC_LIST *) acc;
+	p = (ORGANIC_LIST *) part;
+
+	if( ol->n + p->n > ol->alloc ) {
+		ol->alloc = ol->n + p->n;
+		ol->items = (ORGANIC_ITEM *) REALLOC(ol->items, ol->alloc * sizeof(ORGANIC_ITEM));
+		ASSERT( ol->items != NULL );
+	}
+
+	if( p->n > 0 ) {
+		memcpy(ol->items + ol->n, p->items, p->n * sizeof(ORGANIC_ITEM));
+		ol->n += p->n;
+	}
+
+	FREE(p->items);
+}
+
+/*
+ * Write out organic material
+ *
+ * The grid is scanned a row at a time, but the ORGANIC
+ * entries are written sorted by x, then y. That is the order
+ * older versions wrote, so files stay the same. (read_organic()
+ * doesn't care about the order)
+ *
+ * Only organic in 'tiles' is written, if 'tiles' is not NULL.
+ */
+static void write_organic(PHASCII_FILE pf, UNIVERSE *u, const unsigned char *tiles)
+{
+	int x, i, n;
+	ORGANIC_LIST ol;
+	ORGANIC_ITEM *sorted, *item;
+	int *start;
 
 	ASSERT( pf != NULL );
 	ASSERT( u != NULL );
 
+	memset(&ol, 0, sizeof(ol));
+	Grid_Reduce(u, organic_rows, organic_merge, &ol, sizeof(ol), (void *) tiles);
+
+	/*
+	 * Counting sort on x. Items are already in (y, x) order, so
+	 * this leaves each column sorted by y.
+	 */
+	start = (int *) CALLOC(u->width+1, sizeof(int));
+	ASSERT( start != NULL );
+
+	for(i=0; i < ol.n; i++) {
+		start[ ol.items[i].x + 1 ] += 1;
+	}
+
+	for(x=0; x < u->width; x++) {
+		start[x+1] += start[x];
+	}
+
+	sorted = (ORGANIC_ITEM *) MALLOC((ol.n+1) * sizeof(ORGANIC_ITEM));
+	ASSERT( sorted != NULL );
+
+	for(i=0; i < ol.n; i++) {
+		sorted[ start[ol.items[i].x]++ ] = ol.items[i];
+	}
+
 	Phascii_Printf(pf, "\n");
 
 	n = 0;
 	Phascii_Printf(pf, "ORGANIC {\n");
 
-	for(x=0; x < u->width; x++) {
-		for(y=0; y < u->height; y++) {
-			type = Grid_Get(u, x, y, &ugrid);
-			if( type != GT_ORGANIC )
-				continue;
-
-			if( n >= 500 ) {
-				n = 0;
-				Phascii_Printf(pf, "}\n");
-				Phascii_Printf(pf, "ORGANIC {\n");
-			}
+	for(i=0; i < ol.n; i++) {
+		item = &sorted[i];
 
-			Phascii_Printf(pf, "\t%d\t%d\t%d\n", x, y, ugrid.u.energy);
-			n += 1;
+		if( n >= 500 ) {
+			n = 0;
+			Phascii_Printf(pf, "}\n");
+			Phascii_Printf(pf, "ORGANIC {\n");
 		}
+
+		Phascii_Printf(pf, "\t%d\t%d\t%d\n", item->x, item->y, item->energy);
+		n += 1;
 	}
 
 	Phascii_Printf(pf, "}\n");
 	Phascii_Printf(pf, "\n");
+
+	FREE(sorted);
+	FREE(start);
+	FREE(ol.items);
 }
 
 void write_evolve_random(PHASCII_FILE pf, EVOLVE_RANDOM *er)
@@ -762,13 +942,16 @@ static void write_cell_list(PHASCII_FILE pf, UNIVERSE *u)
 	Phascii_Printf(pf, "\n");
 	Phascii_Printf(pf, "CELL_LIST {\n");
 
-	for(c=u->cells; c != NULL; c=c->u_next) {
+	for(c=Schedule_First(u); c != NULL; c=Schedule_Next(u, c)) {
 		Phascii_Printf(pf, "\t%d %d\n", c->x, c->y);
 	}
 	Phascii_Printf(pf, "}\n\n");
 }
 
-static void write_universe(PHASCII_FILE pf, UNIVERSE *u)
+/*
+ * 'name' is "UNIVERSE", or "DELTA_UNIVERSE" for a delta checkpoint.
+ */
+static void write_universe(PHASCII_FILE pf, UNIVERSE *u, const char *name)
 {
 	int x, y, i;
 
@@ -783,7 +966,7 @@ static void write_universe(PHASCII_FILE pf, UNIVERSE *u)
 		y = -1;
 	}
 
-	Phascii_Printf(pf, "UNIVERSE %u             # seed\n", u->seed );
+	Phascii_Printf(pf, "%s %u             # seed\n", name, u->seed );
 	Phascii_Printf(pf, "         %lld           # step\n", u->step );
 	Phascii_Printf(pf, "         %lld           # age\n", u->age );
 	Phascii_Printf(pf, "         %d %d          # current cell location (x,y)\n", x, y);
@@ -805,6 +988,76 @@ static void write_universe(PHASCII_FILE pf, UNIVERSE *u)
 	Phascii_Printf(pf, "\n");
 }
 
+/*
+ * Say which tiles this delta checkpoint has, and where to find the rest.
+ */
+static void write_delta(PHASCII_FILE pf, UNIVERSE *u, const char *base_filename, int every)
+{
+	int i, n, ntiles;
+
+	ASSERT( pf != NULL );
+	ASSERT( u != NULL );
+	ASSERT( u->dirty_tiles != NULL );
+	ASSERT( base_filename != NULL );
+
+	ntiles = u->dirty_ntx * ((u->height + UNIVERSE_TILE_SIZE - 1) / UNIVERSE_TILE_SIZE);
+
+	n = 0;
+	for(i=0; i < ntiles; i++) {
+		if( u->dirty_tiles[i] )
+			n++;
+	}
+
+	Phascii_Printf(pf, "DELTA \"%s\" %d %d      # base file, full checkpoint every N, number of tiles in this file\n",
+						base_filename, every, n);
+
+	n = 0;
+	for(i=0; i < ntiles; i++) {
+		if( ! u->dirty_tiles[i] )
+			continue;
+
+		if( n >= 10 ) {
+			n = 0;
+			Phascii_Printf(pf, "\n");
+		}
+		Phascii_Printf(pf, "\t%d", i);
+		n++;
+	}
+	Phascii_Printf(pf, "\n\n");
+}
+
+/*
+ * Write the tile hashes of 'u' as the last thing in the file.
+ */
+static void write_tile_hash(PHASCII_FILE pf, UNIVERSE *u)
+{
+	UNIVERSE_TILE_HASH *th;
+	int i, n;
+
+	ASSERT( pf != NULL );
+	ASSERT( u != NULL );
+
+	th = Universe_Tile_Hash_Make(u);
+
+	Phascii_Printf(pf, "TILE_HASH %d %d %d %016llx %d\n",
+			th->tile_size, th->ntx, th->nty,
+			(unsigned long long) th->state, th->ntx * th->nty);
+
+	n = 0;
+	for(i=0; i < th->ntx * th->nty; i++) {
+		if( n >= 4 ) {
+			n = 0;
+			Phascii_Printf(pf, "\n");
+		}
+
+		Phascii_Printf(pf, "\t%016llx", (unsigned long long) th->tile[i]);
+		n++;
+	}
+	Phascii_Printf(pf, "\n");
+
+	Universe_Tile_Hash_Delete(th);
+}
+
 #define ERROR_STR_SIZE 1000
 /*
  * This is a replacement for sprintf() which uses a limit of 1000
@@ -822,8 +1075,16 @@ static void errfmt(char *errbuf, const char *fmt, ...)
  * Write the entire state of the universe to 'filename'
  *
  */
-static int Do_Write_Ascii(UNIVERSE *u, const char *filename, PhasciiWriteCB wcb, char *errbuf)
+/*
+ * Write 'u' to 'filename'. If 'base_filename' is not NULL a delta checkpoint
+ * is written, with only the dirty tiles (u->dirty_tiles) of the grid.
+ * 'every' is the delta_every that wrote the chain (see DELTA.EVERY).
+ */
+static int Do_Write_Ascii(UNIVERSE *u, const char *filename, PhasciiWriteCB wcb,
+							const char *base_filename, int every, char *errbuf)
 {
+	const unsigned char *tiles;
+
 	PHASCII_FILE pf;
 
 	ASSERT( u != NULL );
@@ -846,8 +1107,17 @@ static int Do_Write_Ascii(UNIVERSE *u, const char *filename, PhasciiWriteCB wcb,
 		return 0;
 	}
 
+	tiles = NULL;
+
 	write_prolog(pf);
-	write_universe(pf, u);
+	if( base_filename != NULL ) {
+		write_universe(pf, u, "DELTA_UNIVERSE");
+		write_delta(pf, u, base_filename, every);
+		tiles = u->dirty_tiles;
+	} else {
+		write_universe(pf, u, "UNIVERSE");
+	}
+
 	write_evolve_random(pf, &u->er);
 
 	write_simulation_options(pf, &u->so);
@@ -855,12 +1125,13 @@ static int Do_Write_Ascii(UNIVERSE *u, const char *filename, PhasciiWriteCB wcb,
 	write_kfmo(pf, u->kfmo);
 	write_strain_opcodes(pf, u->kfops);
 
-	write_barriers(pf, u);
-	write_odor_map(pf, u);
-	write_organic(pf, u);
+	write_barriers(pf, u, tiles);
+	write_odor_map(pf, u, tiles);
+	write_organic(pf, u, tiles);
 	write_spores(pf, u);
 	write_organisms(pf, u);
 	write_cell_list(pf, u);
+	write_tile_hash(pf, u);
 
 	Phascii_Close(pf);
 	
@@ -873,9 +1144,22 @@ static int Do_Write_Ascii(UNIVERSE *u, const char *filename, PhasciiWriteCB wcb,
    ***********************************************************************
    *********************************************************************** */
 
-static int read_universe(PHASCII_INSTANCE pi, UNIVERSE **pu, char *errmsg, int *cc_x, int *cc_y)
+/*
+ * Build the path of 'field' in the universe instance 'name' for Phascii_Get().
+ */
+static const char *universe_path(char *buf, const char *name, const char *field)
+{
+	snprintf(buf, 100, "%s.%s", name, field);
+	return buf;
+}
+
+/*
+ * 'name' is "UNIVERSE", or "DELTA_UNIVERSE" for a delta checkpoint.
+ */
+static int read_universe(PHASCII_INSTANCE pi, const char *name, UNIVERSE **pu, char *errmsg, int *cc_x, int *cc_y)
 {
 	UNIVERSE *u;
+	char path[100];
 	int n, x, y, g0, s0, len, i;
 
 	ASSERT( pi != NULL );
@@ -890,128 +1174,128 @@ static int read_universe(PHASCII_INSTANCE pi, UNIVERSE **pu, char *errmsg, int *
 	u = (UNIVERSE *) CALLOC(1, sizeof(UNIVERSE));
 	ASSERT( u != NULL );
 
-	n = Phascii_Get(pi, "UNIVERSE.SEED", "%u", &u->seed);
+	n = Phascii_Get(pi, universe_path(path, name, "SEED"), "%u", &u->seed);
 	if( n != 1 ) {
-		errfmt(errmsg, "missing UNIVERSE.SEED");
+		errfmt(errmsg, "missing %s", path);
 		FREE(u);
 		return 0;
 	}
 
-	n = Phascii_Get(pi, "UNIVERSE.STEP", "%ll", &u->step);
+	n = Phascii_Get(pi, universe_path(path, name, "STEP"), "%ll", &u->step);
 	if( n != 1 ) {
-		errfmt(errmsg, "missing UNIVERSE.STEP");
+		errfmt(errmsg, "missing %s", path);
 		FREE(u);
 		return 0;
 	}
 
-	n = Phascii_Get(pi, "UNIVERSE.AGE", "%ll", &u->age);
+	n = Phascii_Get(pi, universe_path(path, name, "AGE"), "%ll", &u->age);
 	if( n != 1 ) {
-		errfmt(errmsg, "missing UNIVERSE.AGE");
+		errfmt(errmsg, "missing %s", path);
 		FREE(u);
 		return 0;
 	}
 
-	n = Phascii_Get(pi, "UNIVERSE.CURRENT_CELL.{X,Y}", "%d %d", cc_x, cc_y);
+	n = Phascii_Get(pi, universe_path(path, name, "CURRENT_CELL.{X,Y}"), "%d %d", cc_x, cc_y);
 	if( n != 2 ) {
-		errfmt(errmsg, "missing UNIVERSE.CURRENT_CELL.{X,Y}");
+		errfmt(errmsg, "missing %s", path);
 		FREE(u);
 		return 0;
 	}
 
-	n = Phascii_Get(pi, "UNIVERSE.NEXT_ID", "%ll", &u->next_id);
+	n = Phascii_Get(pi, universe_path(path, name, "NEXT_ID"), "%ll", &u->next_id);
 	if( n != 1 ) {
-		errfmt(errmsg, "missing UNIVERSE.NEXT_ID");
+		errfmt(errmsg, "missing %s", path);
 		FREE(u);
 		return 0;
 	}
 
-	n = Phascii_Get(pi, "UNIVERSE.NBORN", "%ll", &u->nborn);
+	n = Phascii_Get(pi, universe_path(path, name, "NBORN"), "%ll", &u->nborn);
 	if( n != 1 ) {
-		errfmt(errmsg, "missing UNIVERSE.NBORN");
+		errfmt(errmsg, "missing %s", path);
 		FREE(u);
 		return 0;
 	}
 
-	n = Phascii_Get(pi, "UNIVERSE.NDIE", "%ll", &u->ndie);
+	n = Phascii_Get(pi, universe_path(path, name, "NDIE"), "%ll", &u->ndie);
 	if( n != 1 ) {
-		errfmt(errmsg, "missing UNIVERSE.NDIE");
+		errfmt(errmsg, "missing %s", path);
 		FREE(u);
 		return 0;
 	}
 
-	n = Phascii_Get(pi, "UNIVERSE.WIDTH", "%d", &u->width);
+	n = Phascii_Get(pi, universe_path(path, name, "WIDTH"), "%d", &u->width);
 	if( n != 1 ) {
-		errfmt(errmsg, "missing UNIVERSE.WIDTH");
+		errfmt(errmsg, "missing %s", path);
 		FREE(u);
 		return 0;
 	}
 
-	n = Phascii_Get(pi, "UNIVERSE.HEIGHT", "%d", &u->height);
+	n = Phascii_Get(pi, universe_path(path, name, "HEIGHT"), "%d", &u->height);
 	if( n != 1 ) {
-		errfmt(errmsg, "missing UNIVERSE.HEIGHT");
+		errfmt(errmsg, "missing %s", path);
 		FREE(u);
 		return 0;
 	}
 
 	if( u->width < 0 || u->width > EVOLVE_MAX_BOUNDS ) {
-		errfmt(errmsg, "UNIVERSE.WIDTH out of bounds");
+		errfmt(errmsg, "%s.WIDTH out of bounds", name);
 		FREE(u);
 		return 0;
 	}
 
 	if( u->height < 0 || u->height > EVOLVE_MAX_BOUNDS ) {
-		errfmt(errmsg, "UNIVERSE.HEIGHT out of bounds");
+		errfmt(errmsg, "%s.HEIGHT out of bounds", name);
 		FREE(u);
 		return 0;
 	}
 
-	n = Phascii_Get(pi, "UNIVERSE.G0", "%d", &g0);
+	n = Phascii_Get(pi, universe_path(path, name, "G0"), "%d", &g0);
 	if( n != 1 ) {
-		errfmt(errmsg, "missing UNIVERSE.G0");
+		errfmt(errmsg, "missing %s", path);
 		FREE(u);
 		return 0;
 	}
 
-	n = Phascii_Get(pi, "UNIVERSE.KEY", "%d", &u->key);
+	n = Phascii_Get(pi, universe_path(path, name, "KEY"), "%d", &u->key);
 	if( n != 1 ) {
-		errfmt(errmsg, "missing UNIVERSE.KEY");
+		errfmt(errmsg, "missing %s", path);
 		FREE(u);
 		return 0;
 	}
 
-	n = Phascii_Get(pi, "UNIVERSE.MOUSE_X", "%d", &u->mouse_x);
+	n = Phascii_Get(pi, universe_path(path, name, "MOUSE_X"), "%d", &u->mouse_x);
 	if( n != 1 ) {
-		errfmt(errmsg, "missing UNIVERSE.MOUSE_X");
+		errfmt(errmsg, "missing %s", path);
 		FREE(u);
 		return 0;
 	}
 
-	n = Phascii_Get(pi, "UNIVERSE.MOUSE_Y", "%d", &u->mouse_y);
+	n = Phascii_Get(pi, universe_path(path, name, "MOUSE_Y"), "%d", &u->mouse_y);
 	if( n != 1 ) {
-		errfmt(errmsg, "missing UNIVERSE.MOUSE_Y");
+		errfmt(errmsg, "missing %s", path);
 		FREE(u);
 		return 0;
 	}
 
 	u->G0 = g0;
 
-	n = Phascii_Get(pi, "UNIVERSE.S0.N", "%d", &len);
+	n = Phascii_Get(pi, universe_path(path, name, "S0.N"), "%d", &len);
 	if( n != 1 ) {
-		errfmt(errmsg, "missing UNIVERSE.S0.N");
+		errfmt(errmsg, "missing %s", path);
 		FREE(u);
 		return 0;
 	}
 
 	if( len != 8 ) {
-		errfmt(errmsg, "UNIVERSE.S0.N must be 8, got %d", len);
+		errfmt(errmsg, "%s.S0.N must be 8, got %d", name, len);
 		FREE(u);
 		return 0;
 	}
 
 	for(i=0; i < 8; i++) {
-		n = Phascii_Get(pi, "UNIVERSE.S0[%0].V", i, "%d", &s0);
+		n = Phascii_Get(pi, universe_path(path, name, "S0[%0].V"), i, "%d", &s0);
 		if( n != 1 ) {
-			errfmt(errmsg, "missing UNIVERSE.S0[%d]", i);
+			errfmt(errmsg, "missing %s.S0[%d]", name, i);
 			FREE(u);
 			return 0;
 		}
@@ -1104,6 +1388,190 @@ static int read_er(PHASCII_INSTANCE pi, UNIVERSE *u, char *errmsg, int *got_it)
 	return 1;
 }
 
+/*
+ * What a DELTA instance says about the file being read.
+ */
+typedef struct {
+	int				got_it;
+	int				got_universe;	// header was DELTA_UNIVERSE
+	char			base[1000];
+	int				every;			// full checkpoint every N
+	unsigned char	*tiles;			// tiles that are in this file
+} DELTA_INFO;
+
+static int read_delta(PHASCII_INSTANCE pi, UNIVERSE *u, DELTA_INFO *delta, char *errmsg)
+{
+	int n, i, num, idx, ntiles;
+
+	ASSERT( pi != NULL );
+	ASSERT( delta != NULL );
+	ASSERT( errmsg != NULL );
+
+	if( u == NULL ) {
+		errfmt(errmsg, "a UNIVERSE instance must appear before DELTA instance");
+		return 0;
+	}
+
+	if( delta->got_it ) {
+		errfmt(errmsg, "multiple DELTA instances not allowed");
+		return 0;
+	}
+
+	delta->got_it = 1;
+
+	n = Phascii_Get(pi, "DELTA.BASE", "%*s", sizeof(delta->base), delta->base);
+	if( n != 1 ) {
+		errfmt(errmsg, "missing DELTA.BASE");
+		return 0;
+	}
+
+	n = Phascii_Get(pi, "DELTA.EVERY", "%d", &delta->every);
+	if( n != 1 ) {
+		errfmt(errmsg, "missing DELTA.EVERY");
+		return 0;
+	}
+
+	if( delta->every < 2 || delta->every > EVOLVE_MAX_DELTA_EVERY ) {
+		errfmt(errmsg, "DELTA.EVERY = %d out of range", delta->every);
+		return 0;
+	}
+
+	n = Phascii_Get(pi, "DELTA.TILES.N", "%d", &num);
+	if( n != 1 ) {
+		errfmt(errmsg, "missing DELTA.TILES.N");
+		return 0;
+	}
+
+	ntiles = ((u->width + UNIVERSE_TILE_SIZE - 1) / UNIVERSE_TILE_SIZE)
+				* ((u->height + UNIVERSE_TILE_SIZE - 1) / UNIVERSE_TILE_SIZE);
+
+	delta->tiles = (unsigned char *) CALLOC(ntiles, sizeof(unsigned char));
+	ASSERT( delta->tiles != NULL );
+
+	for(i=0; i < num; i++) {
+		n = Phascii_Get(pi, "DELTA.TILES[%0].INDEX", i, "%d", &idx);
+		if( n != 1 ) {
+			errfmt(errmsg, "DELTA.TILES[%d].INDEX missing", i);
+			return 0;
+		}
+
+		if( idx < 0 || idx >= ntiles ) {
+			errfmt(errmsg, "DELTA.TILES[%d].INDEX = %d out of range", i, idx);
+			return 0;
+		}
+
+		delta->tiles[idx] = 1;
+	}
+
+	return 1;
+}
+
+/*
+ * Copy organic, barriers and odor from 'base' for every tile of 'u' that
+ * is not in 'tiles'. Those squares have nothing but cells in 'u'.
+ */
+static void merge_delta_base(UNIVERSE *u, UNIVERSE *base, const unsigned char *tiles)
+{
+	UNIVERSE_GRID *bgrid;
+	int x, y;
+
+	ASSERT( u != NULL );
+	ASSERT( base != NULL );
+	ASSERT( u->width == base->width && u->height == base->height );
+
+	for(y=0; y < u->height; y++) {
+		for(x=0; x < u->width; x++) {
+			if( tile_wanted(u, tiles, x, y) )
+				continue;
+
+			Grid_GetPtr(base, x, y, &bgrid);
+
+			if( bgrid->type == GT_ORGANIC ) {
+				Grid_SetOrganic(u, x, y, bgrid->u.energy);
+			} else if( bgrid->type == GT_BARRIER ) {
+				Grid_SetBarrier(u, x, y);
+			}
+
+			if( bgrid->odor != 0 ) {
+				Grid_SetOdor(u, x, y, bgrid->odor);
+			}
+		}
+	}
+}
+
+static UNIVERSE *Do_Read_Ascii(const char *filename, PhasciiReadCB rcb, char *errbuf,
+								int chain, int max_chain);
+
+/*
+ * Finish reading a delta checkpoint 'filename': load its base,
+ * fill in the missing tiles, and check the tile hashes.
+ * 'chain' deltas (counting this one) have been read so far,
+ * at most 'max_chain' are allowed.
+ */
+static int read_delta_base(UNIVERSE *u, const char *filename, DELTA_INFO *delta,
+							int chain, int max_chain, char *errbuf)
+{
+	char base_path[2000], base_errbuf[1000];
+	const char *slash;
+	UNIVERSE *base;
+	UNIVERSE_TILE_HASH *th, *file_th;
+	int ndiff, state_diff, same;
+
+	ASSERT( u != NULL );
+	ASSERT( filename != NULL );
+	ASSERT( delta != NULL );
+
+	slash = strrchr(filename, '/');
+	if( delta->base[0] == '/' || slash == NULL ) {
+		snprintf(base_path, sizeof(base_path), "%s", delta->base);
+	} else {
+		snprintf(base_path, sizeof(base_path), "%.*s/%s", (int)(slash - filename), filename, delta->base);
+	}
+
+	base = Do_Read_Ascii(base_path, NULL, base_errbuf, chain, max_chain);
+	if( base == NULL ) {
+		// only the first delta of the chain names its base, so the
+		// message from deep in a long chain isn't cut off
+		if( chain == 1 )
+			errfmt(errbuf, "%s: base checkpoint %s: %s", filename, base_path, base_errbuf);
+		else
+			errfmt(errbuf, "%s", base_errbuf);
+		return 0;
+	}
+
+	if( base->width != u->width || base->height != u->height ) {
+		errfmt(errbuf, "%s: base checkpoint %s has different dimensions", filename, base_path);
+		Universe_Delete(base);
+		return 0;
+	}
+
+	merge_delta_base(u, base, delta->tiles);
+	Universe_Delete(base);
+
+	/*
+	 * The merge can only be trusted if it reproduces the tile hashes
+	 * the writer saw, so a delta without them is an error.
+	 */
+	file_th = Universe_ReadTileHash(filename, base_errbuf);
+	if( file_th == NULL ) {
+		errfmt(errbuf, "%s", base_errbuf);
+		return 0;
+	}
+
+	th = Universe_Tile_Hash_Make(u);
+	same = Universe_Tile_Hash_Compare(th, file_th, NULL, &ndiff, &state_diff)
+				&& ndiff == 0 && ! state_diff;
+	Universe_Tile_Hash_Delete(th);
+	Universe_Tile_Hash_Delete(file_th);
+
+	if( ! same ) {
+		errfmt(errbuf, "%s: does not match its base checkpoint %s", filename, base_path);
+		return 0;
+	}
+
+	return 1;
+}
+
 static int read_simulation_options_item(PHASCII_INSTANCE pi, SIMULATION_OPTIONS *so, char *errmsg)
 {
 	int n;
@@ -1366,7 +1834,6 @@ static int read_strain_opcodes_item(PHASCII_INSTANCE pi, KFORTH_OPERATIONS *mast
 {
 	char buf[5000];
 	int n, m, num, j;
-	KFORTH_OPERATION *found;
 
 	n = Phascii_Get(pi, "STRAIN_OPCODES[%0].NPROTECTED", i, "%d", &num);
 	if( n != 1 ) {
@@ -1395,20 +1862,14 @@ static int read_strain_opcodes_item(PHASCII_INSTANCE pi, KFORTH_OPERATIONS *mast
 			return 0;
 		}
 
-		found = NULL;
-		for(j=0; j < master_kfops->count; j++) {
-			if( stricmp(buf, master_kfops->table[j].name) == 0 ) {
-				found = &master_kfops->table[j];
-			}
-		}
-
-		if( found == NULL )
+		j = kforth_ops_find(master_kfops, buf);
+		if( j < 0 )
 		{
 			errfmt(errmsg, "no such opcode STRAIN_OPCODES[%d].TABLE[%d].NAME = '%s'", i, m, buf);
 			return 0;
 		}
 
-		kforth_ops_add2(kfops, found);
+		kforth_ops_add2(kfops, &master_kfops->table[j]);
 	}
 
 	return 1;
@@ -1466,7 +1927,7 @@ static int read_cell_list(PHASCII_INSTANCE pi, UNIVERSE *u, char *errmsg, int *g
 {
 	int num, n, i;
 	int x, y;
-	CELL *prev, *c;
+	CELL **list, *c;
 	UNIVERSE_GRID ugrid;
 	GRID_TYPE type;
 	ORGANISM *o;
@@ -1493,9 +1954,14 @@ static int read_cell_list(PHASCII_INSTANCE pi, UNIVERSE *u, char *errmsg, int *g
 		return 0;
 	}
 
-	ASSERT( u->cells == NULL );
+	ASSERT( u->sched.len == 0 );
 
-	prev = NULL;
+	//
+	// The list is in simulation order, the schedule runs from
+	// its last slot to its first, so insert in reverse.
+	//
+	list = (CELL **) CALLOC(num+1, sizeof(CELL*));
+	ASSERT( list != NULL );
 
 	for(i=0; i<num; i++)
 	{
@@ -1503,6 +1969,7 @@ static int read_cell_list(PHASCII_INSTANCE pi, UNIVERSE *u, char *errmsg, int *g
 		if( n != 2 )
 		{
 			errfmt(errmsg, "CELL_LIST[%d].{X,Y} missing", i);
+			FREE(list);
 			return 0;
 		}
 
@@ -1510,32 +1977,25 @@ static int read_cell_list(PHASCII_INSTANCE pi, UNIVERSE *u, char *errmsg, int *g
 		if( type != GT_CELL )
 		{
 			errfmt(errmsg, "CELL_LIST[%d] -> (%d,%d). not found", i, x, y);
+			FREE(list);
 			return 0;
 		}
 
-		c = ugrid.u.cell;
+		list[i] = ugrid.u.cell;
+	}
 
-		if( prev == NULL )
-		{
-			u->cells = c;
-			c->u_prev = NULL;
-			c->u_next = NULL;
-		} else {
-			prev->u_next = c;
-			c->u_prev = prev;
-			c->u_next = NULL;
-		}
-		prev = c;
+	for(i=num-1; i >= 0; i--) {
+		Schedule_Insert(u, list[i]);
 	}
 
+	FREE(list);
+
 	// Every cell should be in the list.
-	if( u->norganism > 1 ) {
-		for(o=u->organisms; o != NULL; o=o->next) {
-			for(c=o->cells; c != NULL; c=c->next) {
-				if( c->u_next == NULL && c->u_prev == NULL ) {
-					errfmt(errmsg, "cell at (%d, %d) was not found in u->cells list", c->x, c->y);
-					return 0;
-				}
+	for(o=u->organisms; o != NULL; o=o->next) {
+		for(c=o->cells; c != NULL; c=c->next) {
+			if( c->sidx < 0 || c->sidx >= u->sched.len || u->sched.slot[c->sidx] != c ) {
+				errfmt(errmsg, "cell at (%d, %d) was not found in CELL_LIST", c->x, c->y);
+				return 0;
 			}
 		}
 	}
@@ -1839,7 +2299,7 @@ static int read_odor_map(PHASCII_INSTANCE pi, UNIVERSE *u, char *errmsg)
 }
 
 
-static int read_spore(PHASCII_INSTANCE pi, UNIVERSE *u, KFORTH_SYMTAB **strain_kfst, char *errmsg)
+static int read_spore(PHASCII_INSTANCE pi, UNIVERSE *u, int got_strain_opcodes, char *errmsg)
 {
 	char buf[5000];
 	int n, num, i, len;
@@ -1852,8 +2312,6 @@ static int read_spore(PHASCII_INSTANCE pi, UNIVERSE *u, KFORTH_SYMTAB **strain_k
 
 	ASSERT( pi != NULL );
 	ASSERT( errmsg != NULL );
-	ASSERT( strain_kfst != NULL );
-
 	if( u == NULL ) {
 		errfmt(errmsg, "a UNIVERSE instance must appear before SPORE instance");
 		return 0;
@@ -1983,14 +2441,13 @@ static int read_spore(PHASCII_INSTANCE pi, UNIVERSE *u, KFORTH_SYMTAB **strain_k
 	}
 #endif
 
-	KFORTH_OPERATIONS *kfops = &u->kfops[strain];
-	KFORTH_SYMTAB *kfst = strain_kfst[strain];
-	if( kfst == NULL ) {
-		errfmt(errmsg, "missing strain_kfst[%d] == NULL", strain);
+	if( ! got_strain_opcodes || ! u->strop[strain].enabled ) {
+		errfmt(errmsg, "no STRAIN_OPCODES for strain %d", strain);
+		FREE(program_text);
 		return 0;
 	}
 
-	kfp = kforth_compile_kfst(program_text, kfst, kfops, errmsg);
+	kfp = kforth_compile(program_text, &u->kfops[strain], errmsg);
 	if( kfp == NULL ) {
 		FREE(program_text);
 		return 0;
@@ -2012,7 +2469,7 @@ static int read_spore(PHASCII_INSTANCE pi, UNIVERSE *u, KFORTH_SYMTAB **strain_k
 	return 1;
 }
 
-static int read_organism(PHASCII_INSTANCE pi, UNIVERSE *u, KFORTH_SYMTAB **strain_kfst, char *errmsg)
+static int read_organism(PHASCII_INSTANCE pi, UNIVERSE *u, int got_strain_opcodes, char *errmsg)
 {
 	char buf[5000];
 	int n, num, i, len;
@@ -2025,8 +2482,6 @@ static int read_organism(PHASCII_INSTANCE pi, UNIVERSE *u, KFORTH_SYMTAB **strai
 
 	ASSERT( pi != NULL );
 	ASSERT( errmsg != NULL );
-	ASSERT( strain_kfst != NULL );
-
 	if( u == NULL ) {
 		errfmt(errmsg, "a UNIVERSE instance must appear before ORGANISM instance");
 		return 0;
@@ -2170,14 +2625,13 @@ static int read_organism(PHASCII_INSTANCE pi, UNIVERSE *u, KFORTH_SYMTAB **strai
 
 #endif
 
-	KFORTH_OPERATIONS *kfops = &u->kfops[strain];
-	KFORTH_SYMTAB *kfst = strain_kfst[strain];
-	if( kfst == NULL ) {
-		errfmt(errmsg, "missing strain_kfst[%d] == NULL", strain);
+	if( ! got_strain_opcodes || ! u->strop[strain].enabled ) {
+		errfmt(errmsg, "no STRAIN_OPCODES for strain %d", strain);
+		FREE(program_text);
 		return 0;
 	}
 
-	kfp = kforth_compile_kfst(program_text, kfst, kfops, errmsg);
+	kfp = kforth_compile(program_text, &u->kfops[strain], errmsg);
 	if( kfp == NULL ) {
 		FREE(program_text);
 		return 0;
@@ -2255,6 +2709,7 @@ static int read_cell(PHASCII_INSTANCE pi, UNIVERSE *u, char *errmsg)
 
 	c = (CELL*) CALLOC(1, sizeof(CELL));
 	ASSERT( c != NULL );
+	c->sidx = -1;
 
 	n = Phascii_Get(pi, "CELL.X", "%d", &c->x);
 	if( n != 1 ) {
@@ -2411,13 +2866,18 @@ static int read_cell(PHASCII_INSTANCE pi, UNIVERSE *u, char *errmsg)
 		return 0;
 	}
 
-	c->kfm			= kfm;
+	kforth_machine_copy2(&kfm, &c->kfm);
+	kforth_machine_deinit(&kfm);
 	c->organism		= o;
 
 	/*
 	 * Attach cell to organism
 	 */
 	o->ncells += 1;
+	if( kforth_machine_terminated(&c->kfm) ) {
+		o->ndead += 1;
+	}
+
 	if( o->cells == NULL ) {
 		o->cells = c;
 	} else {
@@ -2431,44 +2891,6 @@ static int read_cell(PHASCII_INSTANCE pi, UNIVERSE *u, char *errmsg)
 	return 1;
 }
 
-/***********************************************************************
- * Symbol Tables
- *
- * For each strain build a KFORTH_SYMTAB for that strains
- * kforth instruction symbols.
- *
- * 	KFORTH_SYMTAB*	strain_kfst[8];		<--- kfst
- * 	build a struct of up to 8 of these things:
- */
-static void make_fast_symtabs(UNIVERSE *u, KFORTH_SYMTAB** strain_kfst)
-{
-	int i;
-
-	ASSERT( u != NULL );
-	ASSERT( strain_kfst != NULL );
-
-	for(i=0; i < 8; i++) {
-		strain_kfst[i] = NULL;
-
-		if( u->strop[i].enabled ) {
-			strain_kfst[i] = kforth_symtab_make( &u->kfops[i] );
-		}
-	}
-}
-
-static void delete_fast_symtabs(KFORTH_SYMTAB** strain_kfst)
-{
-	int i;
-
-	ASSERT( strain_kfst != NULL );
-
-	for(i=0; i < 8; i++) {
-		if( strain_kfst[i] != NULL ) {
-			kforth_symtab_delete(strain_kfst[i]);
-		}
-	}
-}
-
 /***********************************************************************
  * Read a universe from 'filename'.
  *
@@ -2480,8 +2902,12 @@ static void delete_fast_symtabs(KFORTH_SYMTAB** strain_kfst)
  *	On Success, a universe object is returned.
  *	On Failure, NULL is returned and errbuf contains a error message.
  *
+ *	'chain' is the number of delta checkpoints already read to get here,
+ *	and 'max_chain' the most allowed (see read_delta_base).
+ *
  */
-static UNIVERSE *Do_Read_Ascii(const char *filename, PhasciiReadCB rcb, char *errbuf)
+static UNIVERSE *Do_Read_Ascii(const char *filename, PhasciiReadCB rcb, char *errbuf,
+								int chain, int max_chain)
 {
 	PHASCII_FILE phf;
 	PHASCII_INSTANCE pi;
@@ -2495,8 +2921,7 @@ static UNIVERSE *Do_Read_Ascii(const char *filename, PhasciiReadCB rcb, char *er
 	int got_strain_options;
 	int got_sim_options;
 	int got_cell_list;
-	KFORTH_SYMTAB* strain_kfst[8];		// fast hash table of instruction opcodes for each strain 
-	int i;
+	DELTA_INFO delta;
 
 #if 0
 	// debug time the read operation
@@ -2508,10 +2933,6 @@ static UNIVERSE *Do_Read_Ascii(const char *filename, PhasciiReadCB rcb, char *er
 	ASSERT( filename != NULL );
 	ASSERT( errbuf != NULL );
 
-	for(i=0; i < 8; i++) {
-		strain_kfst[i] = NULL;
-	}
-
 	if( rcb != NULL )
 	{
 		phf = Phascii_Open_ReadCB(filename, rcb);
@@ -2536,6 +2957,7 @@ static UNIVERSE *Do_Read_Ascii(const char *filename, PhasciiReadCB rcb, char *er
 	cc_x = -1;
 	cc_y = -1;
 	u = NULL;
+	memset(&delta, 0, sizeof(delta));
 
 	while( (pi = Phascii_GetInstance(phf)) ) {
 
@@ -2555,16 +2977,20 @@ static UNIVERSE *Do_Read_Ascii(const char *filename, PhasciiReadCB rcb, char *er
 			success = read_kfmo(pi, u, errmsg, &got_kfmo);
 
 		} else if( Phascii_IsInstance(pi, "SPORE") ) {
-			success = read_spore(pi, u, strain_kfst, errmsg);
+			success = read_spore(pi, u, got_strain_opcodes, errmsg);
 
 		} else if( Phascii_IsInstance(pi, "CELL") ) {
 			success = read_cell(pi, u, errmsg);
 
 		} else if( Phascii_IsInstance(pi, "ORGANISM") ) {
-			success = read_organism(pi, u, strain_kfst, errmsg);
+			success = read_organism(pi, u, got_strain_opcodes, errmsg);
 
 		} else if( Phascii_IsInstance(pi, "UNIVERSE") ) {
-			success = read_universe(pi, &u, errmsg, &cc_x, &cc_y);
+			success = read_universe(pi, "UNIVERSE", &u, errmsg, &cc_x, &cc_y);
+
+		} else if( Phascii_IsInstance(pi, "DELTA_UNIVERSE") ) {
+			success = read_universe(pi, "DELTA_UNIVERSE", &u, errmsg, &cc_x, &cc_y);
+			delta.got_universe = 1;
 
 		} else if( Phascii_IsInstance(pi, "SIMULATION_OPTIONS") ) {
 			success = read_simulation_options(pi, u, errmsg, &got_sim_options);
@@ -2574,13 +3000,13 @@ static UNIVERSE *Do_Read_Ascii(const char *filename, PhasciiReadCB rcb, char *er
 
 		} else if( Phascii_IsInstance(pi, "STRAIN_OPCODES") ) {
 			success = read_strain_opcodes(pi, u, errmsg, &got_strain_opcodes);
-			if( success ) {
-				make_fast_symtabs(u, strain_kfst);
-			}
 
 		} else if( Phascii_IsInstance(pi, "CELL_LIST") ) {
 			success = read_cell_list(pi, u, errmsg, &got_cell_list);
 
+		} else if( Phascii_IsInstance(pi, "DELTA") ) {
+			success = read_delta(pi, u, &delta, errmsg);
+
 		} else {
 			success = 1;
 		}
@@ -2590,15 +3016,17 @@ static UNIVERSE *Do_Read_Ascii(const char *filename, PhasciiReadCB rcb, char *er
 		if( ! success ) {
 			errfmt(errbuf, "%s", errmsg);
 			Phascii_Close(phf);
+			if( delta.tiles != NULL )
+				FREE(delta.tiles);
 			return NULL;
 		}
 	}
 
-	delete_fast_symtabs(strain_kfst);
-
 	if( ! Phascii_Eof(phf) ) {
 		errfmt(errbuf, "%s\n", Phascii_Error(phf));
 		Phascii_Close(phf);
+		if( delta.tiles != NULL )
+			FREE(delta.tiles);
 		return NULL;
 	}
 
@@ -2609,6 +3037,14 @@ static UNIVERSE *Do_Read_Ascii(const char *filename, PhasciiReadCB rcb, char *er
 		return NULL;
 	}
 
+	if( delta.got_it != delta.got_universe ) {
+		errfmt(errbuf, "%s: DELTA_UNIVERSE and DELTA instances must appear together", filename);
+		if( delta.tiles != NULL )
+			FREE(delta.tiles);
+		Universe_Delete(u);
+		return NULL;
+	}
+
 	/*
 	 * Attach current_cell, based on its coordinates. This happens at the end
 	 * after all cells have been populated
@@ -2639,6 +3075,33 @@ static UNIVERSE *Do_Read_Ascii(const char *filename, PhasciiReadCB rcb, char *er
 		u->strpop[ o->strain ] += 1;
 	}
 
+	/*
+	 * A delta checkpoint needs the rest of its grid from its base
+	 */
+	if( delta.got_it ) {
+		if( delta.every - 1 < max_chain )
+			max_chain = delta.every - 1;
+
+		if( rcb != NULL ) {
+			errfmt(errbuf, "%s: delta checkpoints can only be read from files", filename);
+			success = 0;
+		} else if( chain + 1 > max_chain ) {
+			errfmt(errbuf, "%s: more than %d delta checkpoints in a row", filename, max_chain);
+			success = 0;
+		} else {
+			success = read_delta_base(u, filename, &delta, chain + 1, max_chain, errbuf);
+		}
+
+		FREE(delta.tiles);
+
+		if( ! success ) {
+			Universe_Delete(u);
+			return NULL;
+		}
+	}
+
+	Universe_Specialize_Operations(u);
+
 #if 0
 	// KJS debug timer
 	time(&x);
@@ -2650,7 +3113,7 @@ static UNIVERSE *Do_Read_Ascii(const char *filename, PhasciiReadCB rcb, char *er
 
 UNIVERSE *Universe_ReadAscii(const char *filename, char *errbuf)
 {
-	return Do_Read_Ascii(filename, NULL, errbuf);
+	return Do_Read_Ascii(filename, NULL, errbuf, 0, EVOLVE_MAX_DELTA_EVERY - 1);
 }
 
 //
@@ -2658,12 +3121,104 @@ UNIVERSE *Universe_ReadAscii(const char *filename, char *errbuf)
 //
 UNIVERSE *Universe_ReadAscii_CB(const char *name, intptr_t (*rcb)(char *buf, intptr_t reqlen), char *errbuf)
 {
-	return Do_Read_Ascii(name, (PhasciiReadCB)rcb, errbuf);
+	return Do_Read_Ascii(name, (PhasciiReadCB)rcb, errbuf, 0, EVOLVE_MAX_DELTA_EVERY - 1);
+}
+
+/*
+ * Largest TILE_HASH trailer write_tile_hash() can produce.
+ */
+#define TILE_HASH_MAX_TRAILER	( ((EVOLVE_MAX_BOUNDS + UNIVERSE_TILE_SIZE - 1) / UNIVERSE_TILE_SIZE)	\
+								* ((EVOLVE_MAX_BOUNDS + UNIVERSE_TILE_SIZE - 1) / UNIVERSE_TILE_SIZE)	\
+								* 18 + 1000 )
+
+/*
+ * Read just the TILE_HASH trailer of a simulation file. Only the end
+ * of the file is read, so this is cheap no matter how big the file is.
+ *
+ * Returns NULL (and sets 'errbuf') if the file has no trailer.
+ */
+UNIVERSE_TILE_HASH *Universe_ReadTileHash(const char *filename, char *errbuf)
+{
+	UNIVERSE_TILE_HASH *th;
+	FILE *fp;
+	long size, window;
+	char *buf, *p, *q, *end;
+	unsigned long long state;
+	int tile_size, ntx, nty, ntiles, i;
+
+	ASSERT( filename != NULL );
+	ASSERT( errbuf != NULL );
+
+	fp = fopen(filename, "rb");
+	if( fp == NULL ) {
+		errfmt(errbuf, "%s: %s", filename, strerror(errno));
+		return NULL;
+	}
+
+	fseek(fp, 0, SEEK_END);
+	size = ftell(fp);
+
+	window = (size < TILE_HASH_MAX_TRAILER) ? size : TILE_HASH_MAX_TRAILER;
+
+	buf = (char *) MALLOC(window + 1);
+	ASSERT( buf != NULL );
+
+	fseek(fp, size - window, SEEK_SET);
+	window = (long) fread(buf, 1, window, fp);
+	buf[window] = '\0';
+	fclose(fp);
+
+	/*
+	 * find the last line that starts with TILE_HASH
+	 */
+	p = NULL;
+	for(q=strstr(buf, "TILE_HASH "); q != NULL; q=strstr(q+1, "TILE_HASH ")) {
+		if( q == buf || q[-1] == '\n' )
+			p = q;
+	}
+
+	if( p == NULL
+			|| sscanf(p, "TILE_HASH %d %d %d %llx %d", &tile_size, &ntx, &nty, &state, &ntiles) != 5
+			|| tile_size <= 0 || ntx <= 0 || nty <= 0 || ntiles != ntx * nty ) {
+		errfmt(errbuf, "%s: no TILE_HASH trailer", filename);
+		FREE(buf);
+		return NULL;
+	}
+
+	th = Universe_Tile_Hash_Alloc(ntx, nty);
+	th->tile_size = tile_size;
+	th->state = state;
+
+	p = strchr(p, '\n');
+	for(i=0; p != NULL && i < ntiles; i++) {
+		th->tile[i] = strtoull(p, &end, 16);
+		if( end == p )
+			break;
+		p = end;
+	}
+
+	FREE(buf);
+
+	if( i != ntiles ) {
+		errfmt(errbuf, "%s: TILE_HASH trailer is truncated", filename);
+		Universe_Tile_Hash_Delete(th);
+		return NULL;
+	}
+
+	return th;
 }
 
 int Universe_WriteAscii(UNIVERSE *u, const char *filename, char *errbuf)
 {
-	return Do_Write_Ascii(u, filename, NULL, errbuf);
+	return Do_Write_Ascii(u, filename, NULL, NULL, 0, errbuf);
+}
+
+int Universe_WriteAsciiDelta(UNIVERSE *u, const char *filename, const char *base_filename, int every, char *errbuf)
+{
+	ASSERT( u->dirty_tiles != NULL );
+	ASSERT( every >= 2 && every <= EVOLVE_MAX_DELTA_EVERY );
+
+	return Do_Write_Ascii(u, filename, NULL, base_filename, every, errbuf);
 }
 
 intptr_t Universe_WriteAscii_CB( UNIVERSE *u,
@@ -2671,7 +3226,7 @@ intptr_t Universe_WriteAscii_CB( UNIVERSE *u,
 						intptr_t (*wcb)(const char *buf, intptr_t len),
 						char *errbuf)
 {
-	return Do_Write_Ascii(u, name, (PhasciiWriteCB)wcb, errbuf);
+	return Do_Write_Ascii(u, name, (PhasciiWriteCB)wcb, NULL, 0, errbuf);
 }
 
 static int read_evolve_preferences(PHASCII_INSTANCE pi, EVOLVE_PREFERENCES *ep, char *errmsg, int *got_ep)
@@ -3357,6 +3912,53 @@ static void transform(UNIVERSE *u, int x, int y, UNIVERSE *u2, int *x2, int *y2)
  *		1 on success
  *
  */
+typedef struct {
+	int		top;
+	int		bottom;
+	int		left;
+	int		right;
+} STRAIN_RECT;
+
+/*
+ * Grow the bounding box of each strain (acc is STRAIN_RECT[8])
+ */
+static void strain_rect_rows(UNIVERSE *u, int y1, int y2, void *acc, void *arg)
+{
+	STRAIN_RECT *srect;
+	UNIVERSE_GRID ugrid;
+	int x, y, s;
+
+	srect = (STRAIN_RECT *) acc;
+
+	for(y=y1; y < y2; y++) {
+		for(x=0; x < u->width; x++) {
+			if( Grid_Get(u, x, y, &ugrid) == GT_CELL ) {
+				s = ugrid.u.cell->organism->strain;
+				if( x > srect[s].right )	srect[s].right = x;
+				if( x < srect[s].left )		srect[s].left = x;
+				if( y < srect[s].bottom )	srect[s].bottom = y;
+				if( y > srect[s].top )		srect[s].top = y;
+			}
+		}
+	}
+}
+
+static void strain_rect_merge(void *acc, void *part, void *arg)
+{
+	STRAIN_RECT *srect, *p;
+	int s;
+
+	srect = (STRAIN_RECT *) acc;
+	p = (STRAIN_RECT *) part;
+
+	for(s=0; s < 8; s++) {
+		if( p[s].right > srect[s].right )	srect[s].right = p[s].right;
+		if( p[s].left < srect[s].left )		srect[s].left = p[s].left;
+		if( p[s].bottom < srect[s].bottom )	srect[s].bottom = p[s].bottom;
+		if( p[s].top > srect[s].top )		srect[s].top = p[s].top;
+	}
+}
+
 int Terrain_Read(UNIVERSE *u, const char *filename, char *errbuf)
 {
 	PHASCII_FILE phf;
@@ -3364,7 +3966,7 @@ int Terrain_Read(UNIVERSE *u, const char *filename, char *errbuf)
 	char errmsg[1000];
 	UNIVERSE* univ;
 	int cc_x, cc_y;
-	struct { int top, bottom, left, right; } srect[8];
+	STRAIN_RECT srect[8];
 	int s, x, y, x2, y2, found, success, got_u;
 	GRID_TYPE gt;
 	UNIVERSE_GRID ugrid;
@@ -3384,7 +3986,7 @@ int Terrain_Read(UNIVERSE *u, const char *filename, char *errbuf)
 	got_u = 0;
 	while( (pi = Phascii_GetInstance(phf)) ) {
 		if( Phascii_IsInstance(pi, "UNIVERSE") ) {
-			success = read_universe(pi, &univ, errmsg, &cc_x, &cc_y);
+			success = read_universe(pi, "UNIVERSE", &univ, errmsg, &cc_x, &cc_y);
 			got_u = 1;
 		} else if( Phascii_IsInstance(pi, "BARRIER") ) {
 			success = read_barrier(pi, univ, errmsg);
@@ -3421,21 +4023,10 @@ int Terrain_Read(UNIVERSE *u, const char *filename, char *errbuf)
 		srect[s].right = 0;
 	}
 
-	for(x=0; x < u->width; x++) {
-		for(y=0; y < u->height; y++) {
-			gt = Grid_Get(u, x, y, &ugrid);
-			if( gt == GT_CELL ) {
-				s = ugrid.u.cell->organism->strain;
-				if( x > srect[s].right )	srect[s].right = x;
-				if( x < srect[s].left )		srect[s].left = x;
-				if( y < srect[s].bottom )	srect[s].bottom = y;
-				if( y > srect[s].top )		srect[s].top = y;
-			}
-		}
-	}
+	Grid_Reduce(u, strain_rect_rows, strain_rect_merge, srect, sizeof(srect), NULL);
 
-	for(x=0; x < u->width; x++) {
-		for(y=0; y < u->height; y++) {
+	for(y=0; y < u->height; y++) {
+		for(x=0; x < u->width; x++) {
 			gt = Grid_Get(u, x, y, &ugrid);
 			if( gt != GT_BLANK )
 				continue;
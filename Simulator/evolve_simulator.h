@@ -12,6 +12,7 @@
  * create a simulation, and simulate it, include this file.
  *
  */
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -44,11 +45,28 @@ typedef int16_t KFORTH_INTEGER;
  * 'nprotected' should be: 0 <= nprotected <= nblocks.
  * This fields designates the first 'nprotected' code blocks as "protected".
  *
+ * 'version' goes up every time the instructions of the program change. Code that
+ * changes them must call kforth_program_changed().
+ *
+ * 'translation' is the pre-decoded form of the program used by kforth_machine_run(),
+ * or NULL (see kforth_translate.cpp).
+ *
+ * 'packed' is 0 when the block array and every code block were allocated on their own
+ * (the compiler does this). Programs made by copying, merging and mutation are packed:
+ * the block array and all the code blocks are a single allocation of 'packed' bytes,
+ * starting at 'block'. A code block that is replaced later (READ, WRITE) is allocated
+ * on its own, use kforth_program_replace_cb() to do this.
+ *
  */
+typedef struct kforth_translation KFORTH_TRANSLATION;
+
 typedef struct {
 	int					nblocks;
 	int					nprotected;
 	KFORTH_INTEGER		**block;
+	KFORTH_TRANSLATION	*translation;
+	unsigned int		version;
+	size_t				packed;
 } KFORTH_PROGRAM;
 
 /***********************************************************************
@@ -67,20 +85,6 @@ typedef struct {
 	KFORTH_DISASSEMBLY_POS	*pos;
 } KFORTH_DISASSEMBLY;
 
-/***********************************************************************
- * KFORTH SYMBOL TABLE - for faster parsing of kforth programs
- */
-#define KF_HASH_SIZE	(127*127)
-#define KF_CHAIN_LEN	3
-
-typedef struct {
-	int16_t list[ KF_CHAIN_LEN ];		// use -1 to terminate list
-} KFORTH_SYMLIST;
-
-typedef struct {
-	KFORTH_SYMLIST hash[ KF_HASH_SIZE ];
-} KFORTH_SYMTAB;
-
 /***********************************************************************
  * KFORTH MACHINE
  */
@@ -92,21 +96,39 @@ typedef struct {
 #define KF_MAX_CALL	64		// maximum call stack size
 #define KF_MAX_DATA	64		// maximum data stack size
 
+#define KF_INLINE_CALL	8		// call stack entries stored inside the machine
+#define KF_INLINE_DATA	16		// data stack entries stored inside the machine
+
+/*
+ * 'call_stack' and 'data_stack' point at the small inline arrays. When a
+ * stack gets deeper than its inline array, it is moved to an overflow buffer
+ * big enough for KF_MAX_CALL/KF_MAX_DATA entries (see kforth_execute.cpp).
+ * 'ccap' and 'dcap' say how many entries the stacks can currently hold.
+ *
+ * Because of the self-referencing pointers, never copy a KFORTH_MACHINE
+ * with '=', use kforth_machine_copy2().
+ */
 typedef struct {
 	KFORTH_LOC			loc;							// program location
 	KFORTH_INTEGER		R[10];							/* R0 - R9 */
 	int16_t				csp;							// call stack pointer
 	int16_t				dsp;							// data stack pointer
-	KFORTH_LOC			call_stack[ KF_MAX_CALL ];
-	KFORTH_INTEGER		data_stack[ KF_MAX_DATA ];
+	int16_t				ccap;							// call stack capacity
+	int16_t				dcap;							// data stack capacity
+	KFORTH_LOC			*call_stack;
+	KFORTH_INTEGER		*data_stack;
+	KFORTH_LOC			call_inline[ KF_INLINE_CALL ];
+	KFORTH_INTEGER		data_inline[ KF_INLINE_DATA ];
 } KFORTH_MACHINE;
 
 /***********************************************************************
  * KFORTH OPERATIONS
  */
 #define KFORTH_OPS_LEN	250	/* maximum number of instructions supported */
+#define KF_OPCODE_HASH_SIZE	256	/* slots in the instruction name hash (see kforth_opcode_hash.cpp) */
 
 typedef struct kforth_operations KFORTH_OPERATIONS;
+typedef struct kforth_profile KFORTH_PROFILE;
 
 typedef void (*KFORTH_FUNCTION)(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data);
 
@@ -122,6 +144,10 @@ struct kforth_operations {
 	int					count;						// number of enrties in 'table'
 	int					nprotected;					// number of protected instructions (from start of table)
 	KFORTH_OPERATION	table[KFORTH_OPS_LEN];		// a table of kforth instructions
+	KFORTH_PROFILE		*profile;					// opcode profile to update, or NULL (see kforth_profile.cpp)
+	unsigned int		serial;						// new value every time 'table' changes
+	uint8_t				hash[KF_OPCODE_HASH_SIZE];	// opcode+1 of the instruction in each name hash slot, 0 for none
+	int					nunhashed;					// number of instructions whose names are not in the name hash
 };
 
 /***********************************************************************
@@ -142,6 +168,33 @@ typedef struct {
 										// which eventually gets propogated into kfp->nprotected.
 } KFORTH_MUTATE_OPTIONS;
 
+/***********************************************************************
+ * KFORTH MUTATE SCRATCH
+ *
+ * Work space for merging and mutating programs (see kforth_mutate.cpp).
+ * It is kept between calls, so once it has grown big enough mutations
+ * don't allocate anything until the result is made.
+ *
+ * A zeroed KFORTH_MUTATE_SCRATCH is empty and ready to use.
+ */
+typedef struct {
+	const KFORTH_INTEGER	*src;		// code shared with a source program, or NULL
+	int						off;		// where the code is in 'pool' (when src is NULL)
+	int						len;		// number of instructions
+	int						size;		// room at 'off'
+} KFORTH_MUTATE_CB;
+
+typedef struct {
+	int					nblocks;
+	int					nprotected;
+	int					changed;		// the code blocks differ from the source program
+	int					nalloc;			// number of entries allocated in 'block'
+	KFORTH_MUTATE_CB	*block;
+	KFORTH_INTEGER		*pool;			// code of the code blocks that have been changed
+	int					pool_len;
+	int					pool_size;
+} KFORTH_MUTATE_SCRATCH;
+
 #define PROBABILITY_SCALE	10000
 #define MUTATE_MAX_APPLY_LIMIT	10		/* upper limit for the max_apply setting */
 
@@ -195,10 +248,39 @@ struct cell {
 	int				y;
 	CELL			*next;
 	ORGANISM		*organism;	/* pointer to my organism */
-	CELL			*u_next;
-	CELL			*u_prev;
+	int				sidx;		/* my slot in u->sched.slot[] */
 };
 
+/***********************************************************************
+ * CELL SCHEDULE
+ *
+ * The order in which cells get simulated. Cells are executed from
+ * the highest slot down to slot 0, then the universe 'age' increments
+ * and execution resumes at the top.
+ *
+ *                                              u->current_cell
+ *                                                    |
+ *                                                    v
+ *            +------+------+------+------+------+------+------+
+ *  slot      |  c1  |  c2  | NULL |  c4  | NULL |  c6  |  c7  |
+ *            +------+------+------+------+------+------+------+
+ *               0      1      2      3      4      5      6     len=7
+ *
+ * New cells are appended after slot[len-1], so they first run when the
+ * next age begins (just like pushing onto the head of a linked list).
+ *
+ * A removed cell leaves a NULL tombstone behind, so that 'sidx' stays
+ * valid for all the other cells. Tombstones are squeezed out at the
+ * end of every age.
+ *
+ */
+typedef struct {
+	CELL			**slot;
+	int				len;		/* slots in use (including tombstones) */
+	int				alloc;		/* slots allocated */
+	int				ntomb;		/* number of NULL slots */
+} CELL_SCHEDULE;
+
 /***********************************************************************
  * ORGANISM
  *
@@ -215,6 +297,7 @@ struct organism {
 	int				sim_count;		/* down counter until all cells simulated */
 	KFORTH_PROGRAM	program;
 	int				ncells;			/* number of cells */
+	int				ndead;			/* number of terminated cells (removed by Kill_Dead_Cells) */
 	CELL			*cells;			/* linked list of cells in the organism */
 	ORGANISM		*next;
 	ORGANISM		*prev;
@@ -261,6 +344,63 @@ typedef struct universe_grid {
 	} u;
 } UNIVERSE_GRID;
 
+/***********************************************************************
+ * Running totals of what is on the grid. Every Grid_XXX() routine
+ * subtracts the old contents of a square and adds the new contents.
+ * Code that changes a spore, or the stacks of a cell, while it sits on
+ * the grid must adjust these totals too.
+ *
+ * This lets Universe_Information() avoid visiting every grid square.
+ */
+typedef struct {
+	int		num_cells;
+	int		call_stack_nodes;
+	int		data_stack_nodes;
+	int		num_organic;
+	int		organic_energy;
+	int		num_spores;
+	int		spore_energy;
+	int		spore_instructions;
+	int		spore_program_memory;
+} GRID_TOTALS;
+
+/***********************************************************************
+ * PHASE TIMER
+ *
+ * Attributes wall time, and on Linux hardware counters, to the phases
+ * of a simulation. Phases nest: time spent in an inner phase is not
+ * charged to the phase around it. See phase_timer.cpp.
+ */
+enum {
+	PHASE_EXECUTE,				// running KFORTH instructions (everything not in another phase)
+	PHASE_KILL_DEAD_CELLS,		// Kill_Dead_Cells() and its connectivity check
+	PHASE_KILL_ORGANISM,		// Kill_Organism(), removing a dead organism
+	PHASE_MUTATE,				// spore fertilization and spawning (kforth_merge_mutate/kforth_mutate)
+	PHASE_CHECKPOINT,			// reading and writing simulation files
+	PHASE_COUNT
+};
+
+enum {
+	PHASE_COUNTER_CYCLES,
+	PHASE_COUNTER_LLC_MISSES,
+	PHASE_COUNTER_BRANCH_MISSES,
+	PHASE_NCOUNTERS
+};
+
+#define PHASE_MAX_DEPTH		8
+
+typedef struct {
+	LONG_LONG	calls[PHASE_COUNT];
+	LONG_LONG	nsec[PHASE_COUNT];
+	LONG_LONG	counter[PHASE_COUNT][PHASE_NCOUNTERS];
+	int			have_counters;						// hardware counters are being sampled
+	int			fd[PHASE_NCOUNTERS];				// perf events (fd[0] leads the group), or -1
+	int			depth;
+	int			stack[PHASE_MAX_DEPTH];
+	LONG_LONG	last_nsec;
+	LONG_LONG	last_counter[PHASE_NCOUNTERS];
+} PHASE_TIMER;
+
 /**********************************************************************
  * SIMULATION and STRAIN OPTIONS
  */
@@ -310,24 +450,30 @@ struct universe {
 	int						strpop[8];		/* # of organisms by strain */
 	LONG_LONG				nborn;			/* # of organisms born in this simulation */
 	LONG_LONG				ndie;			/* # of organisms died in this simulation */
+	LONG_LONG				ninstructions;	/* # of instructions executed since loaded, not saved */
 	EVOLVE_RANDOM			er;				/* random number generator state */
 	SIMULATION_OPTIONS 		so;
 	STRAIN_OPTIONS			strop[8];		/* options pertaining to a strain */
 	KFORTH_OPERATIONS		kfops[8];		/* list of instructions available to this strain */
 	KFORTH_MUTATE_OPTIONS	kfmo[8];		/* mutations probabilities can be adjusted per strain */
+	KFORTH_MUTATE_SCRATCH	kfms;			/* work space for kforth_mutate() etc., not saved */
 	ORGANISM				*organisms;
 	ORGANISM				*selected_organism;
 	int						width;
 	int						height;
 	UNIVERSE_GRID			*grid;
 	CELL					*current_cell;
-	CELL					*cells;
+	CELL_SCHEDULE			sched;			/* simulation order of all cells */
 	KFORTH_INTEGER			G0;				/* universe-wide global variable */
 	int						key;			/* KEY-PRESS */
 	int						mouse_x;		/* MOUSE-POS */
 	int						mouse_y;		/* MOUSE-POS */
 	KFORTH_INTEGER			S0[8];			/* strain-wide global variable */
 	int						barrier_flag;	/* set whenever the barrier layer changes, clients can clear, not saved */
+	GRID_TOTALS				totals;			/* running totals of grid contents, not saved */
+	PHASE_TIMER				*phase_timer;	/* NULL unless a client is timing phases, not saved */
+	unsigned char			*dirty_tiles;	/* NULL unless a client is tracking dirty tiles, not saved */
+	int						dirty_ntx;		/* tiles across, for indexing dirty_tiles[] */
 };
 
 typedef struct {
@@ -355,6 +501,25 @@ typedef struct {
 
 } UNIVERSE_INFORMATION;
 
+/***********************************************************************
+ * TILE HASHES
+ *
+ * The grid is cut into tiles of UNIVERSE_TILE_SIZE x UNIVERSE_TILE_SIZE
+ * squares (tiles on the right and bottom edges may be smaller), and each
+ * tile gets a hash of its squares. 'state' hashes everything else
+ * (organisms, programs, schedule, random number generator, options).
+ * See universe_hash.cpp.
+ */
+#define UNIVERSE_TILE_SIZE	64
+
+typedef struct {
+	int			tile_size;
+	int			ntx;			/* number of tiles across */
+	int			nty;			/* number of tiles down */
+	uint64_t	state;
+	uint64_t	*tile;			/* tile[ty * ntx + tx] */
+} UNIVERSE_TILE_HASH;
+
 typedef struct {
 	char					name[100];
 	char					seed_file[1000];
@@ -426,16 +591,29 @@ extern KFORTH_MUTATE_OPTIONS *kforth_mutate_options_copy(KFORTH_MUTATE_OPTIONS *
 extern void		kforth_mutate_options_defaults(KFORTH_MUTATE_OPTIONS *kfmo);
 extern void		kforth_mutate_options_delete(KFORTH_MUTATE_OPTIONS *kfmoxo);
 
+extern void		kforth_mutate_scratch_init(KFORTH_MUTATE_SCRATCH *kfms);
+extern void		kforth_mutate_scratch_deinit(KFORTH_MUTATE_SCRATCH *kfms);
+
 extern void		kforth_mutate(KFORTH_OPERATIONS *kfops,
 					KFORTH_MUTATE_OPTIONS *kfmo,
 					EVOLVE_RANDOM *er,
+					KFORTH_MUTATE_SCRATCH *kfms,
 					KFORTH_PROGRAM *kfp);
 
 extern void		kforth_mutate_cb(KFORTH_OPERATIONS *kfops,
 					KFORTH_MUTATE_OPTIONS *kfmo,
 					EVOLVE_RANDOM *er,
+					KFORTH_MUTATE_SCRATCH *kfms,
 					KFORTH_INTEGER **block);
 
+extern void		kforth_merge_mutate(KFORTH_OPERATIONS *kfops,
+					KFORTH_MUTATE_OPTIONS *kfmo,
+					EVOLVE_RANDOM *er,
+					KFORTH_MUTATE_SCRATCH *kfms,
+					KFORTH_PROGRAM *kfp1,
+					KFORTH_PROGRAM *kfp2,
+					KFORTH_PROGRAM *kfp);
+
 extern void kforth_merge2(EVOLVE_RANDOM *er,
 						  KFORTH_MUTATE_OPTIONS *kfmo,
 						  KFORTH_PROGRAM *kfp1,
@@ -451,6 +629,8 @@ extern void kforth_copy2(KFORTH_PROGRAM *kfp, KFORTH_PROGRAM *kfp2);
 extern KFORTH_PROGRAM	*kforth_copy(KFORTH_PROGRAM *kfp);
 extern void				kforth_program_init(KFORTH_PROGRAM *kfp);
 extern void				kforth_program_deinit(KFORTH_PROGRAM *kfp);
+extern void				kforth_program_replace_cb(KFORTH_PROGRAM *kfp, int cb, KFORTH_INTEGER *block);
+extern void				kforth_program_changed(KFORTH_PROGRAM *kfp);
 extern int				kforth_program_cblen(KFORTH_PROGRAM *kfp, int cb);
 
 /*
@@ -463,6 +643,7 @@ extern void		kforth_machine_delete(KFORTH_MACHINE *kfm);
 extern void		kforth_machine_copy2(KFORTH_MACHINE *kfm, KFORTH_MACHINE *kfm2);
 extern KFORTH_MACHINE	*kforth_machine_copy(KFORTH_MACHINE *kfm);
 extern void		kforth_machine_execute(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *program, KFORTH_MACHINE *kfm, void *client_data);
+extern int		kforth_machine_run(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *program, KFORTH_MACHINE *kfm, void *client_data, int max_steps);
 extern void		kforth_machine_reset(KFORTH_MACHINE *kfm);
 extern int		kforth_machine_terminated(KFORTH_MACHINE *kfm);
 extern void		kforth_machine_terminate(KFORTH_MACHINE *kfm);
@@ -479,10 +660,81 @@ extern void		kforth_ops_del(KFORTH_OPERATIONS *kfops, const char *name);
 extern KFORTH_OPERATION* kforth_ops_get(KFORTH_OPERATIONS *kfops, int idx);
 extern void		kforth_ops_set_protected(KFORTH_OPERATIONS *kfops, const char *name);
 extern void		kforth_ops_set_unprotected(KFORTH_OPERATIONS *kfops, const char *name);
+extern void		kforth_ops_set_function(KFORTH_OPERATIONS *kfops, const char *name, KFORTH_FUNCTION func);
 
 extern KFORTH_INTEGER	kforth_data_stack_pop(KFORTH_MACHINE *kfm);
 extern void		kforth_data_stack_push(KFORTH_MACHINE *kfm, KFORTH_INTEGER value);
 extern void		kforth_call_stack_push(KFORTH_MACHINE *kfm, int cb, int pc);
+extern void		kforth_data_stack_grow(KFORTH_MACHINE *kfm);
+extern void		kforth_call_stack_grow(KFORTH_MACHINE *kfm);
+
+/***********************************************************************
+ * KFORTH PROFILE
+ *
+ * Per-opcode counters filled in by kforth_machine_execute() for every
+ * KFORTH_OPERATIONS that has a profile attached. Only collected when
+ * the simulator is compiled with KFORTH_PROFILER defined.
+ *
+ * 'ticks' is the time spent inside the instruction, in cpu cycles
+ * (rdtsc) on x86, otherwise in nanoseconds.
+ *
+ * 'skipped' counts instructions that were not executed because
+ * the data stack had too few arguments (or no room for the results).
+ */
+struct kforth_profile {
+	LONG_LONG	executed[KFORTH_OPS_LEN];
+	LONG_LONG	skipped[KFORTH_OPS_LEN];
+	LONG_LONG	ticks[KFORTH_OPS_LEN];
+	LONG_LONG	literals;						// numbers pushed
+	LONG_LONG	literals_skipped;				// numbers not pushed, data stack was full
+};
+
+/*
+ * kforth_profile.cpp
+ */
+extern int				kforth_profile_enabled(void);
+extern KFORTH_PROFILE	*kforth_profile_make(void);
+extern void				kforth_profile_delete(KFORTH_PROFILE *kfprof);
+extern void				kforth_profile_clear(KFORTH_PROFILE *kfprof);
+extern void				kforth_profile_attach(KFORTH_OPERATIONS *kfops, KFORTH_PROFILE *kfprof);
+extern int				kforth_profile_sort(KFORTH_OPERATIONS *kfops, KFORTH_PROFILE *kfprof, int *order);
+
+/***********************************************************************
+ * KFORTH TRANSLATE
+ *
+ * Pre-decoded code blocks for kforth_machine_run() (see kforth_translate.cpp).
+ * There is one KFORTH_XOP per instruction: literals are already sign
+ * extended, and instructions carry their function and stack counts.
+ *
+ * 'block[cb]' is NULL until code block 'cb' has been translated. The
+ * translation is only valid for the program 'version' and KFORTH_OPERATIONS
+ * 'serial' it was made for.
+ */
+typedef struct {
+	KFORTH_FUNCTION		func;		// NULL for a literal
+	KFORTH_INTEGER		value;		// the literal
+	int8_t				in;
+	int8_t				diff;		// out - in
+} KFORTH_XOP;
+
+struct kforth_translation {
+	unsigned int		serial;
+	unsigned int		version;
+	int					nblocks;
+	KFORTH_XOP			**block;
+};
+
+/*
+ * kforth_translate.cpp
+ */
+extern KFORTH_XOP	*kforth_translate_block(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, int cb);
+extern void			kforth_translate_delete(KFORTH_TRANSLATION *kft);
+
+/*
+ * kforth_opcode_hash.cpp
+ */
+extern int			kforth_opcode_hash(const char *name);
+extern void			kforth_ops_hash(KFORTH_OPERATIONS *kfops);
 
 /*
  * kforth_compiler.cpp
@@ -499,9 +751,6 @@ extern void		kforth_disassembly_delete(KFORTH_DISASSEMBLY *kfd);
 extern int		kforth_program_find_symbol(const char *program, const char *symbol);
 extern int		kforth_remap_instructions(KFORTH_OPERATIONS* kfops1, KFORTH_OPERATIONS* kfops2, KFORTH_PROGRAM *kfp);
 extern int		kforth_remap_instructions_cb(KFORTH_OPERATIONS* kfops1, KFORTH_OPERATIONS* kfops2, KFORTH_INTEGER *block);
-extern KFORTH_SYMTAB *kforth_symtab_make(KFORTH_OPERATIONS *kfops);
-extern void		kforth_symtab_delete(KFORTH_SYMTAB *kfst);
-extern KFORTH_PROGRAM *kforth_compile_kfst(const char *program_text, KFORTH_SYMTAB *kfst, KFORTH_OPERATIONS *kfops, char *errbuf);
 
 extern char *kforth_metadata_comment_make(int strain, STRAIN_OPTIONS *strop, KFORTH_MUTATE_OPTIONS *kfmo, KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp);
 extern void kforth_metadata_comment_delete(char *str);
@@ -563,8 +812,28 @@ extern ORGANISM	*Organism_Make(
 				const char *program_text,
 				char *errbuf );
 
+extern ORGANISM	*Organism_Make_Program(
+				int x, int y,
+				int strain, int energy,
+				int protected_codeblocks,
+				KFORTH_PROGRAM *kfp );
+
 extern void		Organism_delete(ORGANISM *o);
 
+typedef struct {
+	LONG_LONG	id;
+	int			nchildren;		/* living organisms with 'id' as parent1 or parent2 */
+} LINEAGE_ENTRY;
+
+typedef struct {
+	int				n;
+	LINEAGE_ENTRY	*entries;	/* one per living organism, sorted by id */
+} LINEAGE_INDEX;
+
+extern LINEAGE_INDEX	*Lineage_Index_Make(UNIVERSE *u);
+extern void				Lineage_Index_Delete(LINEAGE_INDEX *li);
+extern int				Lineage_Index_NChildren(LINEAGE_INDEX *li, LONG_LONG id);
+
 /*
  * spore.cpp
  */
@@ -578,6 +847,7 @@ extern void		Spore_fertilize(UNIVERSE *u, ORGANISM *o, SPORE *spore, int x, int
 extern UNIVERSE	*Universe_Make(uint32_t seed, int width, int height);
 extern void		Universe_Delete(UNIVERSE *u);
 extern void		Universe_Simulate(UNIVERSE *u);
+extern void		Universe_Execute_Cell(UNIVERSE *u, CELL *cell);
 extern void		Universe_Information(UNIVERSE *u, UNIVERSE_INFORMATION *uinfo);
 
 
@@ -626,7 +896,41 @@ extern void		Grid_SetCell(UNIVERSE *u, CELL *cell);
 extern void		Grid_SetOrganic(UNIVERSE *u, int x, int y, int energy);
 extern void		Grid_SetSpore(UNIVERSE *u, int x, int y, SPORE *spore);
 
+extern void		Universe_Track_Dirty_Tiles(UNIVERSE *u, int on);
+extern void		Universe_Clear_Dirty_Tiles(UNIVERSE *u);
+
+/*
+ * grid_reduce.cpp
+ */
+typedef void (*GRID_REDUCE_ROWS)(UNIVERSE *u, int y1, int y2, void *acc, void *arg);
+typedef void (*GRID_REDUCE_MERGE)(void *acc, void *part, void *arg);
+
+extern void		Grid_Reduce(UNIVERSE *u, GRID_REDUCE_ROWS rows, GRID_REDUCE_MERGE merge,
+							void *acc, int acc_size, void *arg);
+
+/*
+ * universe_hash.cpp
+ */
+extern uint64_t		Universe_Hash(UNIVERSE *u);
+extern UNIVERSE_TILE_HASH	*Universe_Tile_Hash_Alloc(int ntx, int nty);
+extern UNIVERSE_TILE_HASH	*Universe_Tile_Hash_Make(UNIVERSE *u);
+extern void			Universe_Tile_Hash_Delete(UNIVERSE_TILE_HASH *th);
+extern int			Universe_Tile_Hash_Compare(UNIVERSE_TILE_HASH *th1, UNIVERSE_TILE_HASH *th2,
+							char *diff, int *ndiff, int *state_diff);
+
+/*
+ * phase_timer.cpp
+ */
+extern PHASE_TIMER	*Phase_Timer_Make(int want_counters);
+extern void			Phase_Timer_Delete(PHASE_TIMER *pt);
+extern void			Phase_Timer_Begin(PHASE_TIMER *pt, int phase);
+extern void			Phase_Timer_End(PHASE_TIMER *pt);
+extern const char	*Phase_Timer_Name(int phase);
+extern const char	*Phase_Timer_Counter_Name(int counter);
+
 extern KFORTH_OPERATIONS *EvolveOperations(void);
+extern void EvolveOperations_Specialize(KFORTH_OPERATIONS *kfops, STRAIN_OPTIONS *strop);
+extern void Universe_Specialize_Operations(UNIVERSE *u);
 extern void SimulationOptions_Init(SIMULATION_OPTIONS *so);
 extern void StrainOptions_Init(STRAIN_OPTIONS *strain);
 
@@ -642,6 +946,7 @@ extern void		Universe_update_protections(UNIVERSE *u, int strain, KFORTH_OPERATI
 extern void NewUniverseOptions_Init(NEW_UNIVERSE_OPTIONS *nuo);
 extern STRAIN_PROFILE *NewUniverse_Get_StrainProfile(NEW_UNIVERSE_OPTIONS *nuo, int i);
 extern UNIVERSE *CreateUniverse(NEW_UNIVERSE_OPTIONS *nuo, char *errbuf);
+extern UNIVERSE *CreateUniverse_Programs(NEW_UNIVERSE_OPTIONS *nuo, KFORTH_PROGRAM **programs, char *errbuf);
 
 extern STRAIN_PROFILE* StrainProfile_Make();
 extern void StrainProfile_Init(STRAIN_PROFILE *sp);
@@ -669,12 +974,16 @@ extern char* Evolve_Version();
  */
 extern UNIVERSE		*Universe_Read(const char *filename, char *errbuf);
 extern int			Universe_Write(UNIVERSE *u, const char *filename, char *errbuf);
+extern int			Universe_WriteDelta(UNIVERSE *u, const char *filename, const char *base_filename, int every, char *errbuf);
+
+#define EVOLVE_MAX_DELTA_EVERY	32		/* longest delta checkpoint chain, plus the full one */
 
 /*
  * evolve_io_ascii.cpp
  */
 extern int			EvolvePreferences_Read(EVOLVE_PREFERENCES *ep, const char *filename, char *errbuf);
 extern int			EvolvePreferences_Write(EVOLVE_PREFERENCES *ep, const char *filename, char *errbuf);
+extern UNIVERSE_TILE_HASH *Universe_ReadTileHash(const char *filename, char *errbuf);
 
 //
 // Read and Write Ascii represention of the simulation using a external call back to read/write the data
@@ -719,9 +1028,11 @@ typedef struct {
 	int				max_age;
 	int				avg_age;
 	int				max_num_cells;
+	LONG_LONG		total_energy;
 	int				reset_tracers;
 	KFORTH_PROGRAM	*kfp;
 	UNIVERSE		*u;
+	LINEAGE_INDEX	*lineage;		// made by execute() when the expression uses NCHILDREN
 } ORGANISM_FINDER;
 
 void 				OrganismFinder_init(ORGANISM_FINDER *of, const char *find_expr, int reset_tracers);
@@ -729,6 +1040,8 @@ ORGANISM_FINDER*	OrganismFinder_make(const char *find_expr, int reset_tracers);
 void				OrganismFinder_deinit(ORGANISM_FINDER *of);
 void				OrganismFinder_delete(ORGANISM_FINDER *of);
 void				OrganismFinder_execute(ORGANISM_FINDER *of, UNIVERSE *u);
+ORGANISM**			OrganismFinder_select(ORGANISM_FINDER *of, UNIVERSE *u, int *nmatch);
+int					OrganismFinder_test(ORGANISM_FINDER *of, UNIVERSE *u);
 const char *		OrganismFinder_get_error(ORGANISM_FINDER *of);
 
 /*
@@ -3,6 +3,13 @@
 
 #define KFORTH_COMPILE_FAST
 
+/*
+ * Define this (or pass -DKFORTH_PROFILER) to build the opcode profiler
+ * into kforth_machine_execute(). When it is not defined the profiler
+ * API still exists, but no counters are ever updated.
+ */
+//#define KFORTH_PROFILER
+
 /*
  * Copyright (c) 2022 Stauffer Computer Consulting
  */
@@ -23,13 +30,17 @@ typedef struct {
 
 //
 // These macros access the KFORTH_MACHINE directly instead of calling a function
+// (the push macros move the stack to its overflow buffer when the inline part is full)
 //
 #define Kforth_Data_Stack_Top(kfm)				( (kfm)->data_stack[ (kfm)->dsp-1 ] 			)
 #define Kforth_Data_Stack_2nd(kfm)				( (kfm)->data_stack[ (kfm)->dsp-2 ] 			)
 #define Kforth_Data_Stack_Pop(kfm)				( (kfm)->data_stack[ --(kfm)->dsp ] 			)
+#define Kforth_Data_Stack_Drop(kfm)				do { --(kfm)->dsp;								} while(0) // force stmt usage
 #define Kforth_Machine_Terminated(kfm)			( (kfm)->loc.cb == -1 							)
-#define Kforth_Data_Stack_Push(kfm, value)		do { (kfm)->data_stack[(kfm)->dsp++] = value;	} while(0) // force stmt usage
-#define Kforth_Call_Stack_Push(kfm, loc)		do { (kfm)->call_stack[(kfm)->csp++] = loc;		} while(0) // force stmt usage
+#define Kforth_Data_Stack_Push(kfm, value)		do { if( (kfm)->dsp >= (kfm)->dcap ) kforth_data_stack_grow(kfm);	\
+													(kfm)->data_stack[(kfm)->dsp++] = value;	} while(0) // force stmt usage
+#define Kforth_Call_Stack_Push(kfm, loc)		do { if( (kfm)->csp >= (kfm)->ccap ) kforth_call_stack_grow(kfm);	\
+													(kfm)->call_stack[(kfm)->csp++] = loc;		} while(0) // force stmt usage
 #define Kforth_Machine_Terminate(kfm)			do { (kfm)->loc.cb = -1;						} while(0) // force stmt usage
 
 /***********************************************************************
@@ -42,17 +53,51 @@ typedef struct {
 extern int	Mark_Reachable_Cells(UNIVERSE *u, CELL *cell, int color);
 extern int	Mark_Reachable_Cells_Alive(UNIVERSE *u, CELL *cell, int color);
 
+/*
+ * cell_schedule.cpp
+ */
+extern void	Schedule_Insert(UNIVERSE *u, CELL *cell);
+extern void	Schedule_Remove(UNIVERSE *u, CELL *cell);
+extern CELL	*Schedule_First(UNIVERSE *u);
+extern CELL	*Schedule_Next(UNIVERSE *u, CELL *cell);
+extern void	Schedule_Compact(UNIVERSE *u);
+extern void	Schedule_Prefetch(UNIVERSE *u, CELL *cell);
+extern void	Schedule_Deinit(UNIVERSE *u);
+
 /*
  * organism.cpp
  */
 int Kill_Dead_Cells(UNIVERSE *u, ORGANISM *o);
 int Kill_Organism(UNIVERSE *u, ORGANISM *o, int ex, int ey);
 
+/*
+ * Mark the start and end of a phase, when a client is timing phases (phase_timer.cpp)
+ */
+#define PHASE_BEGIN(u, phase)	do { if( (u)->phase_timer != NULL ) Phase_Timer_Begin((u)->phase_timer, phase);	} while(0)
+#define PHASE_END(u)			do { if( (u)->phase_timer != NULL ) Phase_Timer_End((u)->phase_timer);			} while(0)
+
+/*
+ * Mark the tile holding (x,y) as dirty, when a client is tracking dirty tiles.
+ * Only changes to organic, barriers and odor need to be marked, delta
+ * checkpoints write all organisms and spores (see Universe_Track_Dirty_Tiles).
+ */
+#define GRID_DIRTY(u, x, y)		do { if( (u)->dirty_tiles != NULL )																\
+										(u)->dirty_tiles[ ((y) / UNIVERSE_TILE_SIZE) * (u)->dirty_ntx + ((x) / UNIVERSE_TILE_SIZE) ] = 1;	\
+								} while(0)
+
+#define GRID_STATIC(type)		( (type) == GT_ORGANIC || (type) == GT_BARRIER )
+
+/*
+ * kforth_profile.cpp
+ */
+extern LONG_LONG		kforth_profile_ticks(void);
+
 /*
  * evolve_io_ascii.cpp
  */
 extern UNIVERSE			*Universe_ReadAscii(const char *filename, char *errbuf);
 extern int				Universe_WriteAscii(UNIVERSE *u, const char *filename, char *errbuf);
+extern int				Universe_WriteAsciiDelta(UNIVERSE *u, const char *filename, const char *base_filename, int every, char *errbuf);
 
 //////////////////////////////////////////////////////////////////////
 ///
@@ -101,6 +146,18 @@ extern int				Universe_WriteAscii(UNIVERSE *u, const char *filename, char *errbu
 #define FREE(x)				free(x)
 #define STRDUP(x)			strdup(x)
 
+#if defined(__GNUC__) || defined(__clang__)
+#define PREFETCH(p)			__builtin_prefetch(p)
+#else
+#define PREFETCH(p)
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define KFORTH_PROFILE_TICKS()	((LONG_LONG) __builtin_ia32_rdtsc())
+#else
+#define KFORTH_PROFILE_TICKS()	kforth_profile_ticks()
+#endif
+
 //////////////////////////////////////////////////////////////////////
 ///
 /// PORTING END
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2022 Ken Stauffer
+ */
+
+/***********************************************************************
+ * GRID REDUCE
+ *
+ * Visit every square of the universe grid, in row-major order
+ * (the order the squares are stored in memory), and combine the
+ * results.
+ *
+ * The rows are split into contiguous bands. On big grids each band
+ * is handed to its own thread, with a private copy of the accumulator.
+ * When all the bands are done, the band accumulators are merged into
+ * the caller's accumulator from the top band to the bottom band, so
+ * the merge order never depends on thread timing.
+ *
+ * Example (count organic squares):
+ *
+ *	static void count_rows(UNIVERSE *u, int y1, int y2, void *acc, void *arg)
+ *	{
+ *		for(y=y1; y < y2; y++)
+ *			for(x=0; x < u->width; x++)
+ *				if( Grid_Get(u, x, y, &ugrid) == GT_ORGANIC )
+ *					*(int*)acc += 1;
+ *	}
+ *
+ *	static void count_merge(void *acc, void *part, void *arg)
+ *	{
+ *		*(int*)acc += *(int*)part;
+ *	}
+ *
+ *	n = 0;
+ *	Grid_Reduce(u, count_rows, count_merge, &n, sizeof(n), NULL);
+ *
+ * Each band starts with a copy of the initial accumulator, so
+ * the initial value must be an identity for 'merge' (0 for sums,
+ * INT_MAX for minimums, and so on).
+ *
+ * 'rows' must only modify its band of the grid and its accumulator.
+ *
+ */
+#include <thread>
+
+#include "evolve_simulator.h"
+#include "evolve_simulator_private.h"
+
+#define GRID_REDUCE_MAX_THREADS		64
+
+/*
+ * Grids smaller than this are done on the calling thread,
+ * starting threads would cost more than it saves.
+ */
+#define GRID_REDUCE_MIN_SQUARES		(512*512)
+
+static int grid_reduce_nthreads(UNIVERSE *u)
+{
+	int n;
+
+	if( u->width * u->height < GRID_REDUCE_MIN_SQUARES )
+		return 1;
+
+	n = (int) std::thread::hardware_concurrency();
+
+	if( n < 1 )
+		n = 1;
+
+	if( n > GRID_REDUCE_MAX_THREADS )
+		n = GRID_REDUCE_MAX_THREADS;
+
+	if( n > u->height )
+		n = u->height;
+
+	return n;
+}
+
+/***********************************************************************
+ * Call 'rows' for every row of 'u', and combine the results in 'acc'
+ * with 'merge'. 'merge' may be NULL if 'acc_size' is 0.
+ *
+ */
+void Grid_Reduce(UNIVERSE *u, GRID_REDUCE_ROWS rows, GRID_REDUCE_MERGE merge,
+					void *acc, int acc_size, void *arg)
+{
+	std::thread workers[ GRID_REDUCE_MAX_THREADS ];
+	char *parts;
+	void *part;
+	int nthreads, i, y1, y2;
+
+	ASSERT( u != NULL );
+	ASSERT( rows != NULL );
+	ASSERT( acc_size == 0 || (acc != NULL && merge != NULL) );
+
+	nthreads = grid_reduce_nthreads(u);
+
+	if( nthreads == 1 ) {
+		rows(u, 0, u->height, acc, arg);
+		return;
+	}
+
+	parts = NULL;
+	if( acc_size > 0 ) {
+		parts = (char *) MALLOC(nthreads * acc_size);
+		ASSERT( parts != NULL );
+	}
+
+	/*
+	 * The last band runs on this thread.
+	 */
+	for(i=0; i < nthreads; i++) {
+		y1 = (int) ((LONG_LONG) u->height * i / nthreads);
+		y2 = (int) ((LONG_LONG) u->height * (i+1) / nthreads);
+
+		part = NULL;
+		if( acc_size > 0 ) {
+			part = parts + i * acc_size;
+			memcpy(part, acc, acc_size);
+		}
+
+		if( i < nthreads-1 ) {
+			workers[i] = std::thread(rows, u, y1, y2, part, arg);
+		} else {
+			rows(u, y1, y2, part, arg);
+		}
+	}
+
+	for(i=0; i < nthreads-1; i++) {
+		workers[i].join();
+	}
+
+	if( acc_size > 0 ) {
+		for(i=0; i < nthreads; i++) {
+			merge(acc, parts + i * acc_size, arg);
+		}
+		FREE(parts);
+	}
+}
@@ -1479,6 +1479,55 @@ static KFORTH_IHELP Kforth_Instruction_Help_Table[] =
 	"Constant: for all organisms return the MAXIMUM number of cells an organism has. ",
 
 
+	MASK_FIND | MASK_F,
+	"STEP",
+	"Find_STEP",
+	"( -- n)",
+	"Constant: the universe step number (divided by 1,000). ",
+
+
+	MASK_FIND | MASK_F,
+	"MEGA-STEP",
+	"Find_MEGA_STEP",
+	"( -- n)",
+	"Constant: the universe step number (divided by 1,000,000). ",
+
+
+	MASK_FIND | MASK_F,
+	"UNIVERSE-AGE",
+	"Find_UNIVERSE_AGE",
+	"( -- n)",
+	"Constant: the age of the universe (divided by 1,000). ",
+
+
+	MASK_FIND | MASK_F,
+	"NUM-ORGANISMS",
+	"Find_NUM_ORGANISMS",
+	"( -- n)",
+	"Constant: the number of organisms in the universe. ",
+
+
+	MASK_FIND | MASK_F,
+	"STRAIN-POP",
+	"Find_STRAIN_POP",
+	"(s -- n)",
+	"Return the number of organisms belonging to strain 's'. ",
+
+
+	MASK_FIND | MASK_F,
+	"NUM-STRAINS",
+	"Find_NUM_STRAINS",
+	"( -- n)",
+	"Constant: the number of strains that have living organisms. ",
+
+
+	MASK_FIND | MASK_F,
+	"TOTAL-ENERGY",
+	"Find_TOTAL_ENERGY",
+	"( -- n)",
+	"Constant: the energy of all organisms added together (divided by 1,000). ",
+
+
 
 };
 
@@ -60,160 +60,153 @@ static int is_kforth_operand(char *word)
 	return ( strlen(word) == len );
 }
 
-//
-// derived from: djb2
-//
-static int hash(const char *str)
-{
-	unsigned long hash = 5381;
-	int ch;
-
-	while( (ch = *str++) ) {
-		ch = tolower(ch);
-		hash = ((hash << 5) + hash) + ch;		// hash * 33 + c
-	}
-
-    return hash % (KF_HASH_SIZE);
-}
-
-KFORTH_SYMTAB *kforth_symtab_make(KFORTH_OPERATIONS *kfops)
-{
-	KFORTH_SYMTAB *result;
-	int hc;
-	const char *name;
-	int16_t *list;
-	int i, j;
-
-	ASSERT( kfops != NULL );
-
-	result = (KFORTH_SYMTAB*) CALLOC(1, sizeof(KFORTH_SYMTAB) );
-	ASSERT( result != NULL );
+/*
+ * All the memory used while compiling one program comes from an arena
+ * owned by the KFORTH_COMPILER. The first chunk is inside the compiler
+ * itself (which lives on the stack of kforth_compile), so most programs
+ * compile without calling MALLOC for anything except the finished program.
+ * Larger programs add chunks, and everything is freed in one shot.
+ *
+ * Nothing is static, so different threads can compile at the same time.
+ */
+#define KF_ARENA_FIRST		(16*1024)
+#define KF_ARENA_CHUNK		(64*1024)
 
-	for(i=0; i < KF_HASH_SIZE; i++) {
-		result->hash[i].list[0] = -1;
-	}
+typedef struct kforth_arena_chunk {
+	struct kforth_arena_chunk *next;
+} KFORTH_ARENA_CHUNK;
 
-	for(i=0; i < kfops->count; i++) {
-		name = kfops->table[i].name;
-		hc = hash(name);
+struct kforth_label_usage {
+	int lineno;
+	int cb;
+	int pc;
+	struct kforth_label_usage *next;
+};
 
-		list = result->hash[hc].list;
+struct kforth_label {
+	char	*name;
+	int	lineno;
+	int	cb;
 
-		j = 0;
-		while( list[j] != -1 )
-		{
-			j += 1;
-			ASSERT( j < KF_CHAIN_LEN );		// increase KF_CHAIN_LEN if this happens
-		}
+	struct 	kforth_label_usage *usage;
+	struct 	kforth_label_usage **usage_tail;
+	struct kforth_label *next;
+};
 
-		list[j] = i;
-		ASSERT( j+1 < KF_CHAIN_LEN );		// increate KF_CHAIN_LEN if this happens
-		list[j+1] = -1;
-	}
+/*
+ * A code block being compiled. 'len' is the code block length,
+ * 'size' is how much room 'code' has.
+ */
+typedef struct {
+	KFORTH_INTEGER	*code;
+	int		len;
+	int		size;
+} KFORTH_COMPILER_CB;
+
+typedef struct {
+	char			*avail;				/* free space in the current chunk */
+	size_t			navail;
+	KFORTH_ARENA_CHUNK	*chunks;		/* MALLOC'd chunks */
+
+	struct kforth_label	*labels;
+	struct kforth_label	**labels_tail;
+
+	int			nblocks;
+	int			nalloc;
+	KFORTH_COMPILER_CB	*block;
+
+	union {
+		char		bytes[ KF_ARENA_FIRST ];
+		void		*align;
+		int64_t		align64;
+	} first;
+} KFORTH_COMPILER;
+
+static void compiler_init(KFORTH_COMPILER *kfc)
+{
+	kfc->avail = kfc->first.bytes;
+	kfc->navail = sizeof(kfc->first.bytes);
+	kfc->chunks = NULL;
 
-	return result;
-}
+	kfc->labels = NULL;
+	kfc->labels_tail = &kfc->labels;
 
-void kforth_symtab_delete(KFORTH_SYMTAB *kfst)
-{
-	ASSERT( kfst != NULL );
-	FREE( kfst );
+	kfc->nblocks = 0;
+	kfc->nalloc = 0;
+	kfc->block = NULL;
 }
 
-static int lookup_opcode_sym(KFORTH_SYMTAB *kfst, KFORTH_OPERATIONS *kfops, char *word)
+static void compiler_deinit(KFORTH_COMPILER *kfc)
 {
-	int16_t* list;
-	const char *name;
-	int hc;
-	int opcode;
-	int i;
-
-	hc = hash(word);
-	list = kfst->hash[hc].list;
-	i = 0;
-	while( list[i] != -1 )
-	{
-		opcode = list[i];
-		name = kfops->table[ opcode ].name;
+	KFORTH_ARENA_CHUNK *chunk, *next;
 
-		if( stricmp(name, word) == 0 )
-		{
-			return opcode;
-		}
-
-		i += 1;
+	for(chunk=kfc->chunks; chunk; chunk=next) {
+		next = chunk->next;
+		FREE(chunk);
 	}
-
-	return -1;
 }
 
-#ifndef KFORTH_COMPILE_FAST
 /*
- * Return the opcode that corresponds to 'word' (or return -1).
+ * Allocate 'size' bytes from the arena. The memory is not cleared.
  */
-static int lookup_opcode(KFORTH_OPERATIONS *kfops, char *word)
+static void *arena_alloc(KFORTH_COMPILER *kfc, size_t size)
 {
-	int i;
+	KFORTH_ARENA_CHUNK *chunk;
+	size_t csize;
+	void *result;
 
-	ASSERT( kfops != NULL );
-	ASSERT( word != NULL );
+	size = (size + 7) & ~((size_t) 7);
 
-	for(i=0; i<kfops->count; i++) {
-		if( stricmp(kfops->table[i].name, word) == 0 ) {
-			return i;
-		}
-	}
+	if( size > kfc->navail ) {
+		csize = (size > KF_ARENA_CHUNK) ? size : KF_ARENA_CHUNK;
 
-	return -1;
-}
-#endif
+		chunk = (KFORTH_ARENA_CHUNK *) MALLOC(sizeof(KFORTH_ARENA_CHUNK) + 8 + csize);
+		ASSERT( chunk != NULL );
 
-struct kforth_label_usage {
-	int lineno;
-	int cb;
-	int pc;
-	struct kforth_label_usage *next;
-};
+		chunk->next = kfc->chunks;
+		kfc->chunks = chunk;
 
-struct kforth_label {
-	char	*name;
-	int	lineno;
-	int	cb;
+		kfc->avail = ((char *) chunk) + ((sizeof(KFORTH_ARENA_CHUNK) + 7) & ~((size_t) 7));
+		kfc->navail = csize;
+	}
 
-	struct 	kforth_label_usage *usage;
-	struct kforth_label *next;
-};
+	result = kfc->avail;
+	kfc->avail += size;
+	kfc->navail -= size;
 
-static struct kforth_label *LabelList;
+	return result;
+}
 
-static struct kforth_label *create_label(char *word)
+static struct kforth_label *create_label(KFORTH_COMPILER *kfc, char *word)
 {
-	struct kforth_label *label, *lp;
+	struct kforth_label *label;
+	size_t len;
 
 	ASSERT( word != NULL );
 
-	label = (struct kforth_label*) CALLOC(1, sizeof(struct kforth_label));
-	ASSERT( label != NULL );
-	label->name = STRDUP(word);
+	len = strlen(word);
 
-	if( LabelList == NULL ) {
-		LabelList = label;
-	} else {
-		for(lp=LabelList; lp->next; lp=lp->next)
-			;
-		lp->next = label;
-	}
+	label = (struct kforth_label*) arena_alloc(kfc, sizeof(struct kforth_label));
+	memset(label, 0, sizeof(struct kforth_label));
+
+	label->name = (char *) arena_alloc(kfc, len+1);
+	memcpy(label->name, word, len+1);
+
+	label->usage_tail = &label->usage;
+
+	*kfc->labels_tail = label;
+	kfc->labels_tail = &label->next;
 
 	return label;
 }
 
-static struct kforth_label *lookup_label(char *word)
+static struct kforth_label *lookup_label(KFORTH_COMPILER *kfc, char *word)
 {
 	struct kforth_label *label;
 
 	ASSERT( word != NULL );
 
-	for(label=LabelList; label; label=label->next) {
+	for(label=kfc->labels; label; label=label->next) {
 		if( stricmp(label->name, word) == 0 )
 			break;
 	}
@@ -221,45 +214,21 @@ static struct kforth_label *lookup_label(char *word)
 	return label;
 }
 
-static void add_label_usage(struct kforth_label *label, int lineno, int cb, int pc)
+static void add_label_usage(KFORTH_COMPILER *kfc, struct kforth_label *label, int lineno, int cb, int pc)
 {
-	struct kforth_label_usage *usage, *up;
+	struct kforth_label_usage *usage;
 
 	ASSERT( label != NULL );
 
-	usage = (struct kforth_label_usage*) CALLOC(1, sizeof(struct kforth_label_usage));
-	ASSERT( usage != NULL );
+	usage = (struct kforth_label_usage*) arena_alloc(kfc, sizeof(struct kforth_label_usage));
 
 	usage->lineno = lineno;
 	usage->cb = cb;
 	usage->pc = pc;
+	usage->next = NULL;
 
-	if( label->usage == NULL ) {
-		label->usage = usage;
-	} else {
-		for(up=label->usage; up->next; up=up->next)
-			;
-
-		up->next = usage;
-	}
-}
-
-static void delete_labels(void)
-{
-	struct kforth_label *label, *label_next;
-	struct kforth_label_usage *usage, *usage_next;
-
-	for(label=LabelList; label; label=label_next) {
-		for(usage=label->usage; usage; usage=usage_next) {
-			usage_next = usage->next;
-			FREE(usage);
-		}
-		label_next = label->next;
-		FREE(label->name);
-		FREE(label);
-	}
-
-	LabelList = NULL;
+	*label->usage_tail = usage;
+	label->usage_tail = &usage->next;
 }
 
 typedef enum {
@@ -277,13 +246,18 @@ typedef enum {
  *
  * opcode_type=ENDCB is called when '} for end of code block. make sure the empty code blocks are created.
  *
+ * Code blocks (and the table of code blocks) double in size in the arena
+ * when they run out of room.
+ *
  */
-static void compile_opcode(KFORTH_PROGRAM *kfp, int cb, int pc, OPCODE_TYPE opcode_type, KFORTH_INTEGER value,
+static void compile_opcode(KFORTH_COMPILER *kfc, int cb, int pc, OPCODE_TYPE opcode_type, KFORTH_INTEGER value,
 									int *out_of_bounds, char *errbuf)
 {
-	int i, len;
+	KFORTH_COMPILER_CB *cbp, *block;
+	KFORTH_INTEGER *code;
+	int nalloc, size;
 
-	ASSERT( kfp != NULL );
+	ASSERT( kfc != NULL );
 	ASSERT( cb >= 0 );
 	ASSERT( pc >= 0 );
 	ASSERT( opcode_type == OPCODE || opcode_type == NUMBER || opcode_type == ENDCB );
@@ -309,15 +283,22 @@ static void compile_opcode(KFORTH_PROGRAM *kfp, int cb, int pc, OPCODE_TYPE opco
 	/*
 	 * Grow program to fit code block 'cb'.
 	 */
-	if( cb >= kfp->nblocks ) {
-		kfp->block = (KFORTH_INTEGER**)
-				REALLOC(kfp->block, sizeof(KFORTH_INTEGER*) * (cb+1) );
-
-		for(i=kfp->nblocks; i<cb+1; i++) {
-			kfp->block[i] = ((KFORTH_INTEGER*) CALLOC(1, sizeof(KFORTH_INTEGER))) + 1;
-			kfp->block[i][-1] = 0;
+	if( cb >= kfc->nblocks ) {
+		if( cb >= kfc->nalloc ) {
+			nalloc = (kfc->nalloc == 0) ? 16 : kfc->nalloc * 2;
+			while( nalloc <= cb )
+				nalloc *= 2;
+
+			block = (KFORTH_COMPILER_CB *) arena_alloc(kfc, nalloc * sizeof(KFORTH_COMPILER_CB));
+			if( kfc->nblocks > 0 )
+				memcpy(block, kfc->block, kfc->nblocks * sizeof(KFORTH_COMPILER_CB));
+
+			kfc->block = block;
+			kfc->nalloc = nalloc;
 		}
-		kfp->nblocks = cb+1;
+
+		memset(&kfc->block[kfc->nblocks], 0, (cb+1 - kfc->nblocks) * sizeof(KFORTH_COMPILER_CB));
+		kfc->nblocks = cb+1;
 	}
 
 	if( opcode_type == ENDCB )
@@ -327,12 +308,24 @@ static void compile_opcode(KFORTH_PROGRAM *kfp, int cb, int pc, OPCODE_TYPE opco
 	else
 	{
 		/*
-		 * Grow code block (include room for the length prefix)
+		 * Grow code block
 		 */
-		len = kforth_program_cblen(kfp, cb);
-		if( pc >= len ) {
-			kfp->block[cb] = ((KFORTH_INTEGER*) REALLOC(kfp->block[cb]-1, sizeof(KFORTH_INTEGER) * (pc+2) )) + 1;
-			kfp->block[cb][-1] = pc+1;
+		cbp = &kfc->block[cb];
+		if( pc >= cbp->size ) {
+			size = (cbp->size == 0) ? 32 : cbp->size * 2;
+			while( size <= pc )
+				size *= 2;
+
+			code = (KFORTH_INTEGER *) arena_alloc(kfc, size * sizeof(KFORTH_INTEGER));
+			if( cbp->len > 0 )
+				memcpy(code, cbp->code, cbp->len * sizeof(KFORTH_INTEGER));
+
+			cbp->code = code;
+			cbp->size = size;
+		}
+
+		if( pc >= cbp->len ) {
+			cbp->len = pc+1;
 		}
 
 		/*
@@ -344,16 +337,47 @@ static void compile_opcode(KFORTH_PROGRAM *kfp, int cb, int pc, OPCODE_TYPE opco
 			ASSERT( value >= 0 && value < KFORTH_OPS_LEN );
 			value = value;
 		}
-		kfp->block[cb][pc] = value;
+		cbp->code[pc] = value;
+	}
+
+}
+
+/*
+ * Copy the compiled code blocks into a new KFORTH_PROGRAM.
+ * Every code block is allocated once, at its final size.
+ */
+static KFORTH_PROGRAM *compiler_program(KFORTH_COMPILER *kfc)
+{
+	KFORTH_PROGRAM *kfp;
+	KFORTH_COMPILER_CB *cbp;
+	int cb;
+
+	kfp = (KFORTH_PROGRAM*) CALLOC(1, sizeof(KFORTH_PROGRAM));
+	ASSERT( kfp != NULL );
+
+	kfp->nblocks = kfc->nblocks;
+	kfp->block = (KFORTH_INTEGER**) MALLOC(kfc->nblocks * sizeof(KFORTH_INTEGER*));
+	ASSERT( kfp->block != NULL );
+
+	for(cb=0; cb < kfc->nblocks; cb++) {
+		cbp = &kfc->block[cb];
+
+		kfp->block[cb] = ((KFORTH_INTEGER*) MALLOC((cbp->len+1) * sizeof(KFORTH_INTEGER))) + 1;
+		kfp->block[cb][-1] = cbp->len;
+
+		if( cbp->len > 0 )
+			memcpy(kfp->block[cb], cbp->code, cbp->len * sizeof(KFORTH_INTEGER));
 	}
 
+	return kfp;
 }
 
 /***********************************************************************
  * Compile the kforth program in the string: 'program_text' 
  */
-KFORTH_PROGRAM *kforth_compile_kfst(const char *program_text, KFORTH_SYMTAB *kfst, KFORTH_OPERATIONS *kfops, char *errbuf)
+KFORTH_PROGRAM *kforth_compile(const char *program_text, KFORTH_OPERATIONS *kfops, char *errbuf)
 {
+	KFORTH_COMPILER kfc;
 	KFORTH_PROGRAM *kfp;
 	int lineno, in_comment, error;
 	int save_cb, cb, pc, sp, opcode;
@@ -369,18 +393,13 @@ KFORTH_PROGRAM *kforth_compile_kfst(const char *program_text, KFORTH_SYMTAB *kfs
 	char bbuf[500];		/* out of bounds error buffer */
 
 	ASSERT( program_text != NULL );
-	ASSERT( kfst != NULL );
 	ASSERT( kfops != NULL );
 	ASSERT( errbuf != NULL );
 
-	kfp = (KFORTH_PROGRAM*) CALLOC(1, sizeof(KFORTH_PROGRAM));
-	ASSERT( kfp != NULL );
+	compiler_init(&kfc);
 
-	kfp->nblocks = 1;
-	kfp->block = (KFORTH_INTEGER**) CALLOC(1, sizeof(KFORTH_INTEGER*));
-
-	kfp->block[0] = ((KFORTH_INTEGER*) CALLOC(1, sizeof(KFORTH_INTEGER))) + 1;
-	kfp->block[0][-1] = 0;
+	oob = 0;
+	compile_opcode(&kfc, 0, 0, ENDCB, 0, &oob, bbuf);
 
 	next_code_block = 0;
 	sp = 0;
@@ -390,7 +409,6 @@ KFORTH_PROGRAM *kforth_compile_kfst(const char *program_text, KFORTH_SYMTAB *kfs
 	in_comment = 0;
 	error = 0;
 	p = program_text;
-	oob = 0;
 	while( *p != '\0' && !error ) {
 		if( isspace(*p) || in_comment ) {
 			if( *p == '\n' ) {
@@ -414,7 +432,7 @@ KFORTH_PROGRAM *kforth_compile_kfst(const char *program_text, KFORTH_SYMTAB *kfs
 			p++;
 
 		} else if( *p == '}' ) {
-			compile_opcode(kfp, cb, pc, ENDCB, 0, &oob, bbuf);
+			compile_opcode(&kfc, cb, pc, ENDCB, 0, &oob, bbuf);
 			sp--;
 			if( sp < 0 ) {
 				errfmt(errbuf, "Line: %d, too many close braces", lineno);
@@ -425,7 +443,7 @@ KFORTH_PROGRAM *kforth_compile_kfst(const char *program_text, KFORTH_SYMTAB *kfs
 				pc = pc_stack[sp];
 
 				/* compile absolute code block number */
-				compile_opcode(kfp, cb, pc, NUMBER, save_cb, &oob, bbuf);
+				compile_opcode(&kfc, cb, pc, NUMBER, save_cb, &oob, bbuf);
 				pc++;
 			}
 			p++;
@@ -442,11 +460,7 @@ KFORTH_PROGRAM *kforth_compile_kfst(const char *program_text, KFORTH_SYMTAB *kfs
 			*w = '\0';
 
 			if( *p == ':' ) {
-#ifndef KFORTH_COMPILE_FAST
-				opcode = lookup_opcode(kfops, word);
-#else
-				opcode = lookup_opcode_sym(kfst, kfops, word);
-#endif
+				opcode = kforth_ops_find(kfops, word);
 				if( opcode >= 0 ) {
 					errfmt(errbuf, "Line: %d, label '%s' clashes with instruction",
 						lineno, word);
@@ -459,9 +473,9 @@ KFORTH_PROGRAM *kforth_compile_kfst(const char *program_text, KFORTH_SYMTAB *kfs
 
 				} else {
 					p++;
-					label = lookup_label(word);
+					label = lookup_label(&kfc, word);
 					if( label == NULL ) {
-						label = create_label(word);
+						label = create_label(&kfc, word);
 						label->cb = next_code_block;
 						label->lineno = lineno;
 					} else {
@@ -484,13 +498,9 @@ KFORTH_PROGRAM *kforth_compile_kfst(const char *program_text, KFORTH_SYMTAB *kfs
 				error = 1;
 
 			} else {
-#ifndef KFORTH_COMPILE_FAST
-				opcode = lookup_opcode(kfops, word);
-#else
-				opcode = lookup_opcode_sym(kfst, kfops, word);
-#endif
+				opcode = kforth_ops_find(kfops, word);
 				if( opcode >= 0 ) {
-					compile_opcode(kfp, cb, pc, OPCODE, opcode, &oob, bbuf);
+					compile_opcode(&kfc, cb, pc, OPCODE, opcode, &oob, bbuf);
 
 				} else if( is_kforth_operand(word) ) {
 					value = atoll(word);
@@ -506,22 +516,23 @@ KFORTH_PROGRAM *kforth_compile_kfst(const char *program_text, KFORTH_SYMTAB *kfs
 							error = 1;
 					}
 					operand = value;
-					compile_opcode(kfp, cb, pc, NUMBER, operand, &oob, bbuf);
+					compile_opcode(&kfc, cb, pc, NUMBER, operand, &oob, bbuf);
 
 				} else {
-					label = lookup_label(word);
+					label = lookup_label(&kfc, word);
 					if( label == NULL ) {
-						label = create_label(word);
+						label = create_label(&kfc, word);
 						label->lineno = -1;
 						label->cb = 0;
-						add_label_usage(label, lineno, cb, pc);
-						compile_opcode(kfp, cb, pc, NUMBER, 0, &oob, bbuf);
+						add_label_usage(&kfc, label, lineno, cb, pc);
+						compile_opcode(&kfc, cb, pc, NUMBER, 0, &oob, bbuf);
 					} else {
 						if( label->lineno == -1 ) {
-							add_label_usage(label, lineno, cb, pc);
+							add_label_usage(&kfc, label, lineno, cb, pc);
+							compile_opcode(&kfc, cb, pc, NUMBER, 0, &oob, bbuf);
 						} else {
 							/* compile absolute code block number */
-							compile_opcode(kfp, cb, pc, NUMBER, label->cb, &oob, bbuf);
+							compile_opcode(&kfc, cb, pc, NUMBER, label->cb, &oob, bbuf);
 						}
 					}
 				}
@@ -531,21 +542,18 @@ KFORTH_PROGRAM *kforth_compile_kfst(const char *program_text, KFORTH_SYMTAB *kfs
 	}
 
 	if( error ) {
-		delete_labels();
-		kforth_delete(kfp);
+		compiler_deinit(&kfc);
 		return NULL;
 	}
 
 	if( sp > 0 ) {
-		delete_labels();
-		kforth_delete(kfp);
+		compiler_deinit(&kfc);
 		errfmt(errbuf, "Line: %d, missing close braces", lineno);
 		return NULL;
 	}
 
 	if( oob != 0 ) {
-		delete_labels();
-		kforth_delete(kfp);
+		compiler_deinit(&kfc);
 		errfmt(errbuf, "Line: %d, %s", lineno, bbuf);
 		return NULL;
 	}
@@ -553,12 +561,11 @@ KFORTH_PROGRAM *kforth_compile_kfst(const char *program_text, KFORTH_SYMTAB *kfs
 	/*
 	 * Make sure all labels are defined
 	 */
-	for(label=LabelList; label; label=label->next) {
+	for(label=kfc.labels; label; label=label->next) {
 		if( label->lineno == -1 ) {
 			lineno = label->usage->lineno;
 			errfmt(errbuf, "Line: %d, undefined label '%s'", lineno, label->name);
-			kforth_delete(kfp);
-			delete_labels();
+			compiler_deinit(&kfc);
 			return NULL;
 		}
 
@@ -568,25 +575,13 @@ KFORTH_PROGRAM *kforth_compile_kfst(const char *program_text, KFORTH_SYMTAB *kfs
 		for(usage=label->usage; usage; usage=usage->next) {
 			cb = usage->cb;
 			pc = usage->pc;
-			kfp->block[cb][pc] = (0x8000 | label->cb);
+			kfc.block[cb].code[pc] = (0x8000 | label->cb);
 		}
 	}
 
-	delete_labels();
+	kfp = compiler_program(&kfc);
 
-	return kfp;
-}
-
-KFORTH_PROGRAM *kforth_compile(const char *program_text, KFORTH_OPERATIONS *kfops, char *errbuf)
-{
-	KFORTH_PROGRAM *kfp;
-	KFORTH_SYMTAB *kfst;
-
-	kfst = kforth_symtab_make(kfops);
-
-	kfp = kforth_compile_kfst(program_text, kfst, kfops, errbuf);
-
-	kforth_symtab_delete(kfst);
+	compiler_deinit(&kfc);
 
 	return kfp;
 }
@@ -596,6 +591,18 @@ void kforth_program_init(KFORTH_PROGRAM *kfp)
 	memset(kfp, 0, sizeof(KFORTH_PROGRAM));
 }
 
+/*
+ * Is 'block' part of the single allocation of a packed program?
+ */
+static int program_packed_cb(KFORTH_PROGRAM *kfp, KFORTH_INTEGER *block)
+{
+	const char *p;
+
+	p = (const char *) (block-1);
+
+	return p >= (const char *) kfp->block && p < (const char *) kfp->block + kfp->packed;
+}
+
 /*
  * De-allocate sub-objects inside of a 'kfp' but don't delete kfp.
  * Remember, this is the structure being used:
@@ -613,10 +620,47 @@ void kforth_program_deinit(KFORTH_PROGRAM *kfp)
 	int cb;
 
 	for(cb=0; cb < kfp->nblocks; cb++ ) {
-		FREE( kfp->block[cb]-1 );
+		if( ! program_packed_cb(kfp, kfp->block[cb]) ) {
+			FREE( kfp->block[cb]-1 );
+		}
 	}
 
 	FREE( kfp->block );
+
+	if( kfp->translation != NULL ) {
+		kforth_translate_delete(kfp->translation);
+	}
+}
+
+/*
+ * Replace code block 'cb' of 'kfp' with 'block', a MALLOC'd code block
+ * (the pointer is shifted by 1, like kfp->block[cb]). The old code block
+ * is freed, unless it belongs to the allocation of a packed program.
+ *
+ * The caller must call kforth_program_changed().
+ */
+void kforth_program_replace_cb(KFORTH_PROGRAM *kfp, int cb, KFORTH_INTEGER *block)
+{
+	ASSERT( kfp != NULL );
+	ASSERT( cb >= 0 && cb < kfp->nblocks );
+	ASSERT( block != NULL );
+
+	if( ! program_packed_cb(kfp, kfp->block[cb]) ) {
+		FREE( kfp->block[cb]-1 );
+	}
+
+	kfp->block[cb] = block;
+}
+
+/*
+ * The instructions of 'kfp' have changed. Bump the version, so
+ * an old translation of the program isn't used anymore.
+ */
+void kforth_program_changed(KFORTH_PROGRAM *kfp)
+{
+	ASSERT( kfp != NULL );
+
+	kfp->version += 1;
 }
 
 /***********************************************************************
@@ -1208,6 +1252,8 @@ int kforth_remap_instructions(KFORTH_OPERATIONS* kfops1, KFORTH_OPERATIONS* kfop
 		}
 	}
 
+	kforth_program_changed(kfp);
+
 	return ! fail;
 }
 
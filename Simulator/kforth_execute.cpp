@@ -10,6 +10,7 @@
 #include "evolve_simulator.h"
 #include "evolve_simulator_private.h"
 #include <ctype.h>
+#include <atomic>
 
 // is the machine terminated (halted)?
 int kforth_machine_terminated(KFORTH_MACHINE *kfm)
@@ -25,13 +26,133 @@ void kforth_machine_terminate(KFORTH_MACHINE *kfm)
 	kfm->loc.cb = -1;
 }
 
+/***********************************************************************
+ * OVERFLOW STACKS
+ *
+ * A machine keeps the first KF_INLINE_CALL/KF_INLINE_DATA stack entries
+ * inside itself. Most cells never go deeper than that. When a stack
+ * does, it moves to an overflow buffer sized for KF_MAX_CALL/KF_MAX_DATA
+ * entries, and stays there until the machine is reset or deleted.
+ *
+ * Overflow buffers are recycled through a free list (one per thread, so
+ * universes simulated on different threads don't contend). The buffers
+ * left on a thread's free list are freed when the thread exits, worker
+ * threads (find bands, tours, ...) come and go.
+ *
+ */
+#define KF_CALL_OVERFLOW_SIZE	(KF_MAX_CALL * sizeof(KFORTH_LOC))
+#define KF_DATA_OVERFLOW_SIZE	(KF_MAX_DATA * sizeof(KFORTH_INTEGER))
+#define KF_OVERFLOW_SIZE		( (KF_CALL_OVERFLOW_SIZE > KF_DATA_OVERFLOW_SIZE) \
+									? KF_CALL_OVERFLOW_SIZE : KF_DATA_OVERFLOW_SIZE )
+
+typedef union kforth_overflow {
+	union kforth_overflow	*next;
+	char					buf[ KF_OVERFLOW_SIZE ];
+} KFORTH_OVERFLOW;
+
+struct kforth_overflow_list {
+	KFORTH_OVERFLOW		*head;
+
+	~kforth_overflow_list()
+	{
+		KFORTH_OVERFLOW *p;
+
+		while( head != NULL ) {
+			p = head;
+			head = p->next;
+			FREE(p);
+		}
+	}
+};
+
+static thread_local struct kforth_overflow_list kforth_overflow_free_list = { NULL };
+
+static void *kforth_overflow_alloc(void)
+{
+	KFORTH_OVERFLOW *p;
+
+	p = kforth_overflow_free_list.head;
+	if( p != NULL ) {
+		kforth_overflow_free_list.head = p->next;
+	} else {
+		p = (KFORTH_OVERFLOW *) MALLOC(sizeof(KFORTH_OVERFLOW));
+		ASSERT( p != NULL );
+	}
+
+	return p;
+}
+
+static void kforth_overflow_free(void *ptr)
+{
+	KFORTH_OVERFLOW *p;
+
+	p = (KFORTH_OVERFLOW *) ptr;
+	p->next = kforth_overflow_free_list.head;
+	kforth_overflow_free_list.head = p;
+}
+
+/*
+ * Move the data stack from the inline array to an overflow buffer.
+ */
+void kforth_data_stack_grow(KFORTH_MACHINE *kfm)
+{
+	KFORTH_INTEGER *overflow;
+
+	ASSERT( kfm != NULL );
+	ASSERT( kfm->data_stack == kfm->data_inline );
+	ASSERT( kfm->dcap == KF_INLINE_DATA );
+
+	overflow = (KFORTH_INTEGER *) kforth_overflow_alloc();
+	memcpy(overflow, kfm->data_inline, kfm->dsp * sizeof(KFORTH_INTEGER));
+
+	kfm->data_stack = overflow;
+	kfm->dcap = KF_MAX_DATA;
+}
+
+/*
+ * Move the call stack from the inline array to an overflow buffer.
+ */
+void kforth_call_stack_grow(KFORTH_MACHINE *kfm)
+{
+	KFORTH_LOC *overflow;
+
+	ASSERT( kfm != NULL );
+	ASSERT( kfm->call_stack == kfm->call_inline );
+	ASSERT( kfm->ccap == KF_INLINE_CALL );
+
+	overflow = (KFORTH_LOC *) kforth_overflow_alloc();
+	memcpy(overflow, kfm->call_inline, kfm->csp * sizeof(KFORTH_LOC));
+
+	kfm->call_stack = overflow;
+	kfm->ccap = KF_MAX_CALL;
+}
+
+/*
+ * Return overflow buffers (if any) and go back to the inline arrays.
+ * The stacks must be empty.
+ */
+static void kforth_machine_release_overflow(KFORTH_MACHINE *kfm)
+{
+	if( kfm->call_stack != kfm->call_inline ) {
+		kforth_overflow_free(kfm->call_stack);
+	}
+
+	if( kfm->data_stack != kfm->data_inline ) {
+		kforth_overflow_free(kfm->data_stack);
+	}
+
+	kfm->call_stack	= kfm->call_inline;
+	kfm->data_stack	= kfm->data_inline;
+	kfm->ccap		= KF_INLINE_CALL;
+	kfm->dcap		= KF_INLINE_DATA;
+}
+
 void kforth_data_stack_push(KFORTH_MACHINE *kfm, KFORTH_INTEGER value)
 {
 	ASSERT( kfm != NULL );
 	ASSERT( kfm->dsp < KF_MAX_DATA );
 
-	kfm->data_stack[ kfm->dsp ] = value;
-	kfm->dsp++;
+	Kforth_Data_Stack_Push(kfm, value);
 }
 
 KFORTH_INTEGER kforth_data_stack_pop(KFORTH_MACHINE *kfm)
@@ -53,8 +174,7 @@ void kforth_call_stack_push(KFORTH_MACHINE *kfm, int cb, int pc)
 	loc.cb = cb;
 	loc.pc = pc;
 
-	kfm->call_stack[ kfm->csp ] = loc;
-	kfm->csp++;
+	Kforth_Call_Stack_Push(kfm, loc);
 }
 
 /***********************************************************************
@@ -66,6 +186,11 @@ void kforth_machine_init(KFORTH_MACHINE *kfm)
 	ASSERT( kfm != NULL );
 	
 	memset(kfm, 0, sizeof(KFORTH_MACHINE));
+
+	kfm->call_stack	= kfm->call_inline;
+	kfm->data_stack	= kfm->data_inline;
+	kfm->ccap		= KF_INLINE_CALL;
+	kfm->dcap		= KF_INLINE_DATA;
 }
 
 /***********************************************************************
@@ -81,6 +206,8 @@ KFORTH_MACHINE *kforth_machine_make()
 	kfm = (KFORTH_MACHINE*) CALLOC(1, sizeof(KFORTH_MACHINE));
 	ASSERT( kfm != NULL );
 
+	kforth_machine_init(kfm);
+
 	return kfm;
 }
 
@@ -89,7 +216,9 @@ KFORTH_MACHINE *kforth_machine_make()
  */
 void kforth_machine_deinit(KFORTH_MACHINE *kfm)
 {
-	// nothing to deinit
+	ASSERT( kfm != NULL );
+
+	kforth_machine_release_overflow(kfm);
 }
 
 /***********************************************************************
@@ -108,7 +237,7 @@ void kforth_machine_delete(KFORTH_MACHINE *kfm)
 
 /***********************************************************************
  * Make a copy of 'kfm' in 'kfm2'
- * kfm2 is assumed to be empty.
+ * kfm2 is assumed to be empty. (Whatever it contains is overwritten, not freed)
  *
  */
 void kforth_machine_copy2(KFORTH_MACHINE *kfm, KFORTH_MACHINE *kfm2)
@@ -116,7 +245,24 @@ void kforth_machine_copy2(KFORTH_MACHINE *kfm, KFORTH_MACHINE *kfm2)
 	ASSERT( kfm != NULL );
 	ASSERT( kfm2 != NULL );
 
-	*kfm2		= *kfm;
+	kforth_machine_init(kfm2);
+
+	kfm2->loc = kfm->loc;
+	memcpy(kfm2->R, kfm->R, sizeof(kfm->R));
+
+	if( kfm->csp > kfm2->ccap ) {
+		kforth_call_stack_grow(kfm2);
+	}
+
+	if( kfm->dsp > kfm2->dcap ) {
+		kforth_data_stack_grow(kfm2);
+	}
+
+	memcpy(kfm2->call_stack, kfm->call_stack, kfm->csp * sizeof(KFORTH_LOC));
+	memcpy(kfm2->data_stack, kfm->data_stack, kfm->dsp * sizeof(KFORTH_INTEGER));
+
+	kfm2->csp = kfm->csp;
+	kfm2->dsp = kfm->dsp;
 }
 
 /***********************************************************************
@@ -157,12 +303,20 @@ void kforth_machine_execute(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *program, K
 	KFORTH_FUNCTION func;
 	KFORTH_OPERATION *kfop;
 	int diff;
+#ifdef KFORTH_PROFILER
+	KFORTH_PROFILE *kfprof;
+	LONG_LONG t0;
+#endif
 
 	ASSERT( kfops != NULL );
 	ASSERT( program != NULL );
 	ASSERT( kfm != NULL );
 	ASSERT( ! Kforth_Machine_Terminated(kfm) );
 
+#ifdef KFORTH_PROFILER
+	kfprof = kfops->profile;
+#endif
+
 	cb = kfm->loc.cb;
 	pc = kfm->loc.pc;
 
@@ -192,7 +346,13 @@ void kforth_machine_execute(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *program, K
 			value = opcode & 0x7fff;
 			if( value & 0x4000 )
 				value |= 0x8000; // sign extention
-			kfm->data_stack[kfm->dsp++] = value;		// PUSH number
+			Kforth_Data_Stack_Push(kfm, value);			// PUSH number
+#ifdef KFORTH_PROFILER
+			if( kfprof != NULL )
+				kfprof->literals += 1;
+		} else if( kfprof != NULL ) {
+			kfprof->literals_skipped += 1;
+#endif
 		}
 	} else {											// DECODED as a instruction
 		ASSERT( opcode >= 0 && opcode < KFORTH_OPS_LEN );
@@ -202,13 +362,120 @@ void kforth_machine_execute(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *program, K
 		diff = kfop->out - kfop->in;
 		if( (kfm->dsp >= kfop->in) && (kfm->dsp + diff <= KF_MAX_DATA) )
 		{
+#ifdef KFORTH_PROFILER
+			if( kfprof != NULL ) {
+				t0 = KFORTH_PROFILE_TICKS();
+				(*func)(kfops, program, kfm, client_data);		// EXECUTE instruction
+				kfprof->ticks[opcode] += KFORTH_PROFILE_TICKS() - t0;
+				kfprof->executed[opcode] += 1;
+			} else
+#endif
 			(*func)(kfops, program, kfm, client_data);			// EXECUTE instruction
 		}
+#ifdef KFORTH_PROFILER
+		else if( kfprof != NULL ) {
+			kfprof->skipped[opcode] += 1;
+		}
+#endif
 	}
 
 	kfm->loc.pc += 1;
 }
 
+/***********************************************************************
+ * Execute up to 'max_steps' execution steps, stopping early if the program
+ * terminates. Returns the number of steps executed.
+ *
+ * The machine ends up exactly where 'max_steps' calls to
+ * kforth_machine_execute() would have left it. This is only for callers that
+ * run one machine by itself (find expressions, 'k' mode). The simulator has
+ * to interleave the cells one step at a time, so it can't use this.
+ *
+ * Code blocks are run from their translation (see kforth_translate.cpp),
+ * which has the literals and the instruction table lookups decoded. A
+ * code block is run straight through, instruction after instruction,
+ * until an instruction moves the machine to another code block or
+ * changes the program. Then the machine's location is fetched again, as
+ * kforth_machine_execute() would. Every instruction still counts as
+ * one step and does its own stack check.
+ *
+ */
+int kforth_machine_run(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *program, KFORTH_MACHINE *kfm, void *client_data, int max_steps)
+{
+	KFORTH_TRANSLATION *kft;
+	KFORTH_XOP *xop, *x;
+	unsigned int version;
+	int steps, cb, pc, len;
+
+	ASSERT( kfops != NULL );
+	ASSERT( program != NULL );
+	ASSERT( kfm != NULL );
+	ASSERT( max_steps >= 0 );
+
+	steps = 0;
+
+#ifdef KFORTH_PROFILER
+	if( kfops->profile != NULL ) {
+		while( steps < max_steps && ! Kforth_Machine_Terminated(kfm) ) {
+			kforth_machine_execute(kfops, program, kfm, client_data);
+			steps++;
+		}
+		return steps;
+	}
+#endif
+
+	while( steps < max_steps && ! Kforth_Machine_Terminated(kfm) ) {
+		cb = kfm->loc.cb;
+		pc = kfm->loc.pc;
+		ASSERT( cb < program->nblocks );
+
+		len = program->block[cb][-1];
+
+		if( pc >= len ) {
+			kforth_machine_execute(kfops, program, kfm, client_data);	// return from code block
+			steps++;
+			continue;
+		}
+
+		kft = program->translation;
+		if( kft != NULL && kft->serial == kfops->serial && kft->version == program->version
+						&& kft->block[cb] != NULL ) {
+			xop = kft->block[cb];
+		} else {
+			xop = kforth_translate_block(kfops, program, cb);
+		}
+
+		version = program->version;
+
+		while( pc < len && steps < max_steps ) {
+			x = &xop[pc];
+			steps++;
+
+			if( x->func == NULL ) {
+				if( kfm->dsp < KF_MAX_DATA )
+					Kforth_Data_Stack_Push(kfm, x->value);
+
+			} else if( (kfm->dsp >= x->in) && (kfm->dsp + x->diff <= KF_MAX_DATA) ) {
+				kfm->loc.pc = pc;
+				(*x->func)(kfops, program, kfm, client_data);
+
+				if( kfm->loc.cb != cb || program->version != version )
+					break;
+
+				pc = kfm->loc.pc;							// ?loop, ?exit, ...
+			}
+			pc++;
+		}
+
+		if( kfm->loc.cb == cb && program->version == version )
+			kfm->loc.pc = pc;
+		else
+			kfm->loc.pc += 1;
+	}
+
+	return steps;
+}
+
 /***********************************************************************
  * Reset the kforth machine so that is can restart
  * execution of the program.
@@ -225,6 +492,8 @@ void kforth_machine_reset(KFORTH_MACHINE *kfm)
 	kfm->dsp = 0;
 	kfm->csp = 0;
 
+	kforth_machine_release_overflow(kfm);
+
 	for(i=0; i<10; i++)
 		kfm->R[i] = 0;
 }
@@ -542,8 +811,8 @@ static void kfop_2dup(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACH
  */
 static void kfop_2pop(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 }
 
 /*
@@ -554,7 +823,7 @@ static void kfop_nip(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHI
 	KFORTH_INTEGER value;
 
 	value = Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 	Kforth_Data_Stack_Push(kfm, value);
 }
 
@@ -663,7 +932,7 @@ static void kfop_sqrt(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACH
 	n = Kforth_Data_Stack_Top(kfm);
 	if( n >= 0 )
 	{
-		Kforth_Data_Stack_Pop(kfm);
+		Kforth_Data_Stack_Drop(kfm);
 		d = (double)n;
 		d = sqrt(d);
 		value = (KFORTH_INTEGER)d;
@@ -721,7 +990,7 @@ static void kfop_divide(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MA
 	b = Kforth_Data_Stack_Top(kfm);
 	if( b != 0 )
 	{
-		Kforth_Data_Stack_Pop(kfm);
+		Kforth_Data_Stack_Drop(kfm);
 		a = Kforth_Data_Stack_Pop(kfm);
 		Kforth_Data_Stack_Push(kfm, a/b);
 	}
@@ -738,7 +1007,7 @@ static void kfop_modulos(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_M
 	b = Kforth_Data_Stack_Top(kfm);
 	if( b != 0 )
 	{
-		Kforth_Data_Stack_Pop(kfm);
+		Kforth_Data_Stack_Drop(kfm);
 		a = Kforth_Data_Stack_Pop(kfm);
 		Kforth_Data_Stack_Push(kfm, a%b);
 	}
@@ -755,7 +1024,7 @@ static void kfop_divmod(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MA
 	b = Kforth_Data_Stack_Top(kfm);
 	if( b != 0 )
 	{
-		Kforth_Data_Stack_Pop(kfm);
+		Kforth_Data_Stack_Drop(kfm);
 		a = Kforth_Data_Stack_Pop(kfm);
 
 		Kforth_Data_Stack_Push(kfm, a%b);
@@ -1532,6 +1801,7 @@ static void kfop_set_number(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORT
 	}
 
 	kfp->block[cb][pc] = (0x8000 | value);
+	kforth_program_changed(kfp);
 }
 
 static void kfop_test_set_number(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
@@ -1585,6 +1855,7 @@ static void kfop_test_set_number(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp,
 	}
 
 	kfp->block[cb][pc] = (0x8000 | number);
+	kforth_program_changed(kfp);
 
 	value = number;
 	if( value & 0x4000 )
@@ -1673,6 +1944,7 @@ static void kfop_set_opcode(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORT
 	}
 
 	kfp->block[cb][pc] = opcode;
+	kforth_program_changed(kfp);
 }
 
 // ( -- opcode )
@@ -1863,6 +2135,22 @@ static void kfop_nop(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHI
 {
 }
 
+/***********************************************************************
+ * Give 'kfops' a new serial number. Must be called whenever the
+ * instructions in the table might have changed.
+ *
+ * Serial numbers are never reused, so two tables with the same serial
+ * have the same instructions (one was copied from the other).
+ *
+ */
+static std::atomic<unsigned int> kforth_ops_serial(0);
+
+static void kforth_ops_changed(KFORTH_OPERATIONS *kfops)
+{
+	kfops->serial = ++kforth_ops_serial;
+	kforth_ops_hash(kfops);
+}
+
 /***********************************************************************
  * Create a KFORTH_OPERATIONS table, and
  * add all the KFORTH_OPERATION
@@ -2008,6 +2296,8 @@ void kforth_ops_init(KFORTH_OPERATIONS *kfops)
 {
 	kfops->count = 0;
 	kfops->nprotected = 0;
+	kfops->profile = NULL;
+	kforth_ops_changed(kfops);
 
 	/*
 	 * the first entry (opcde=0) is special.
@@ -2252,6 +2542,8 @@ static void kforth_ops_add_impl(KFORTH_OPERATIONS *kfops, const char *name, int
 	kfops->table[i].key		= key;
 	kfops->table[i].in		= in;
 	kfops->table[i].out		= out;
+
+	kforth_ops_changed(kfops);
 }
 
 /***********************************************************************
@@ -2288,13 +2580,29 @@ int kforth_ops_max_opcode(KFORTH_OPERATIONS *kfops)
 	return kfops->count - 1;
 }
 
+/*
+ * Return the opcode of the instruction 'name', or -1.
+ *
+ * Names from EvolveOperations() take one probe of the name hash (see
+ * kforth_opcode_hash.cpp). Only tables with other names need to be searched.
+ */
 int kforth_ops_find(KFORTH_OPERATIONS *kfops, const char *name)
 {
-	int i;
-	
-	for(i=0; i < kfops->count; i++) {
-		if( stricmp(name, kfops->table[i].name) == 0 ) {
-			return i;
+	int i, slot;
+
+	ASSERT( kfops != NULL );
+	ASSERT( name != NULL );
+
+	slot = kforth_opcode_hash(name);
+	if( slot >= 0 ) {
+		return kfops->hash[slot] - 1;
+	}
+
+	if( kfops->nunhashed > 0 ) {
+		for(i=0; i < kfops->count; i++) {
+			if( stricmp(name, kfops->table[i].name) == 0 ) {
+				return i;
+			}
 		}
 	}
 	return -1;
@@ -2319,6 +2627,8 @@ void kforth_ops_del(KFORTH_OPERATIONS *kfops, const char *name)
 	for(i=del_idx; i < kfops->count; i++) {
 		kfops->table[i] = kfops->table[i+1];
 	}
+
+	kforth_ops_changed(kfops);
 }
 
 KFORTH_OPERATION* kforth_ops_get(KFORTH_OPERATIONS *kfops, int idx)
@@ -2375,6 +2685,8 @@ void kforth_ops_set_protected(KFORTH_OPERATIONS *kfops, const char *name)
 	kfops->table[insert_idx] = tmp;
 	kfops->nprotected += 1;
 	kfops->count += 1;
+
+	kforth_ops_changed(kfops);
 }
 
 /***********************************************************************
@@ -2419,4 +2731,32 @@ void kforth_ops_set_unprotected(KFORTH_OPERATIONS *kfops, const char *name)
 	kfops->table[insert_idx] = tmp;
 //	kfops->nprotected -= 1;
 	kfops->count += 1;
+
+	kforth_ops_changed(kfops);
+}
+
+/***********************************************************************
+ * Change the function that runs instruction 'name'.
+ *
+ * Precondition: 'name' must exist in table.
+ *
+ */
+void kforth_ops_set_function(KFORTH_OPERATIONS *kfops, const char *name, KFORTH_FUNCTION func)
+{
+	int idx;
+
+	ASSERT( kfops != NULL );
+	ASSERT( name != NULL );
+	ASSERT( func != NULL );
+
+	idx = kforth_ops_find(kfops, name);
+
+	ASSERT( idx != -1 );
+
+	if( kfops->table[idx].func == func )
+		return;
+
+	kfops->table[idx].func = func;
+
+	kforth_ops_changed(kfops);
 }
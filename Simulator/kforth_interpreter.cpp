@@ -69,8 +69,8 @@ static void KforthInterpreter_CHOOSE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *k
 		return;
 	}
 
-	Kforth_Data_Stack_Pop(kfm);
-	Kforth_Data_Stack_Pop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
+	Kforth_Data_Stack_Drop(kfm);
 
 	value = (KFORTH_INTEGER) CHOOSE(er, low, high);
 
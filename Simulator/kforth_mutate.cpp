@@ -6,6 +6,28 @@
 /***********************************************************************
  * MUTATE/MERGE KFORTH PROGRAMS
  *
+ * Mutations and merges are not done to a KFORTH_PROGRAM directly.
+ * They are done to a KFORTH_MUTATE_SCRATCH, which describes each code block
+ * of the program being built:
+ *
+ *	- a code block that hasn't changed still points at the code block
+ *	  of the program it came from (merging or loading a program into the
+ *	  scratch copies nothing).
+ *
+ *	- the first time a code block is changed its code is copied into the
+ *	  scratch 'pool', with room to grow. Later changes are done in place.
+ *
+ *	- duplicating, deleting, inserting and transposing code blocks only
+ *	  moves the (small) code block descriptors around.
+ *
+ * When all the mutations are done the size of the new program is known,
+ * and it is made with a single allocation (a packed program, see
+ * KFORTH_PROGRAM). The pool and the descriptors are kept for the next
+ * time, each universe has one scratch (u->kfms).
+ *
+ * Random numbers are drawn in the same order, and for the same
+ * reasons, as when each mutation was done to the program itself,
+ * so the same mutations happen.
  *
  */
 #include "evolve_simulator.h"
@@ -27,6 +49,258 @@
  */
 #define CHOOSE(er,a,b)	( (sim_random(er) % ((b)-(a)+1) ) + (a) )
 
+/***********************************************************************
+ * SCRATCH
+ *
+ */
+void kforth_mutate_scratch_init(KFORTH_MUTATE_SCRATCH *kfms)
+{
+	ASSERT( kfms != NULL );
+
+	memset(kfms, 0, sizeof(KFORTH_MUTATE_SCRATCH));
+}
+
+void kforth_mutate_scratch_deinit(KFORTH_MUTATE_SCRATCH *kfms)
+{
+	ASSERT( kfms != NULL );
+
+	if( kfms->block != NULL ) {
+		FREE( kfms->block );
+	}
+
+	if( kfms->pool != NULL ) {
+		FREE( kfms->pool );
+	}
+
+	memset(kfms, 0, sizeof(KFORTH_MUTATE_SCRATCH));
+}
+
+/*
+ * Start building a new program, with 'nprotected' protected code blocks.
+ */
+static void scratch_begin(KFORTH_MUTATE_SCRATCH *kfms, int nprotected)
+{
+	kfms->nblocks = 0;
+	kfms->nprotected = nprotected;
+	kfms->changed = 0;
+	kfms->pool_len = 0;
+}
+
+/*
+ * Make sure the 'block' array has room for 'n' code blocks.
+ */
+static void scratch_reserve(KFORTH_MUTATE_SCRATCH *kfms, int n)
+{
+	int nalloc;
+
+	if( n <= kfms->nalloc )
+		return;
+
+	nalloc = (kfms->nalloc > 0) ? kfms->nalloc : 64;
+	while( nalloc < n ) {
+		nalloc *= 2;
+	}
+
+	kfms->block = (KFORTH_MUTATE_CB *) REALLOC(kfms->block, nalloc * sizeof(KFORTH_MUTATE_CB));
+	ASSERT( kfms->block != NULL );
+
+	kfms->nalloc = nalloc;
+}
+
+/*
+ * Take room for 'n' instructions from the pool, return its offset.
+ * (the pool may move, so code blocks in the pool are found by offset)
+ */
+static int scratch_alloc(KFORTH_MUTATE_SCRATCH *kfms, int n)
+{
+	int off, size;
+
+	if( kfms->pool_len + n > kfms->pool_size ) {
+		size = (kfms->pool_size > 0) ? kfms->pool_size : 4096;
+		while( size < kfms->pool_len + n ) {
+			size *= 2;
+		}
+
+		kfms->pool = (KFORTH_INTEGER *) REALLOC(kfms->pool, size * sizeof(KFORTH_INTEGER));
+		ASSERT( kfms->pool != NULL );
+
+		kfms->pool_size = size;
+	}
+
+	off = kfms->pool_len;
+	kfms->pool_len += n;
+
+	return off;
+}
+
+/*
+ * Add code block 'code' (of some program) to the end.
+ * It is shared with that program until it is changed.
+ */
+static void scratch_append(KFORTH_MUTATE_SCRATCH *kfms, const KFORTH_INTEGER *code)
+{
+	KFORTH_MUTATE_CB *b;
+
+	scratch_reserve(kfms, kfms->nblocks+1);
+
+	b = &kfms->block[kfms->nblocks];
+	b->src	= code;
+	b->off	= 0;
+	b->len	= code[-1];
+	b->size	= 0;
+
+	kfms->nblocks += 1;
+}
+
+/*
+ * Start building a new program from the code blocks of 'kfp'.
+ */
+static void scratch_load(KFORTH_MUTATE_SCRATCH *kfms, KFORTH_PROGRAM *kfp)
+{
+	int cb;
+
+	scratch_begin(kfms, kfp->nprotected);
+
+	scratch_reserve(kfms, kfp->nblocks);
+	for(cb=0; cb < kfp->nblocks; cb++) {
+		scratch_append(kfms, kfp->block[cb]);
+	}
+}
+
+static int scratch_cblen(KFORTH_MUTATE_SCRATCH *kfms, int cb)
+{
+	return kfms->block[cb].len;
+}
+
+/*
+ * The instructions of code block 'cb' (read only)
+ */
+static const KFORTH_INTEGER *scratch_code(KFORTH_MUTATE_SCRATCH *kfms, int cb)
+{
+	KFORTH_MUTATE_CB *b;
+
+	b = &kfms->block[cb];
+
+	return (b->src != NULL) ? b->src : kfms->pool + b->off;
+}
+
+/*
+ * Return the instructions of code block 'cb' so they can be changed,
+ * with room for 'len' instructions. The first change to a code block
+ * copies it into the pool.
+ *
+ * The pointer is good until the next scratch_alloc().
+ */
+static KFORTH_INTEGER *scratch_edit(KFORTH_MUTATE_SCRATCH *kfms, int cb, int len)
+{
+	KFORTH_MUTATE_CB *b;
+	int off, size;
+
+	b = &kfms->block[cb];
+
+	kfms->changed = 1;
+
+	if( b->src != NULL || len > b->size ) {
+		size = (b->src != NULL) ? len : 2*len;
+		off = scratch_alloc(kfms, size);
+
+		if( b->len > 0 ) {
+			memcpy(kfms->pool + off, scratch_code(kfms, cb), b->len * sizeof(KFORTH_INTEGER));
+		}
+
+		b->src	= NULL;
+		b->off	= off;
+		b->size	= size;
+	}
+
+	return kfms->pool + b->off;
+}
+
+/*
+ * Make room for a new code block at 'cb' (shifting all code blocks at 'cb')
+ */
+static KFORTH_MUTATE_CB *scratch_insert_cb(KFORTH_MUTATE_SCRATCH *kfms, int cb)
+{
+	scratch_reserve(kfms, kfms->nblocks+1);
+
+	if( cb < kfms->nblocks ) {
+		memmove(&kfms->block[cb+1], &kfms->block[cb],
+				(kfms->nblocks - cb) * sizeof(KFORTH_MUTATE_CB));
+	}
+
+	kfms->nblocks += 1;
+	kfms->changed = 1;
+
+	return &kfms->block[cb];
+}
+
+static void scratch_delete_cb(KFORTH_MUTATE_SCRATCH *kfms, int cb)
+{
+	if( cb < kfms->nblocks-1 ) {
+		memmove(&kfms->block[cb], &kfms->block[cb+1],
+				(kfms->nblocks - cb - 1) * sizeof(KFORTH_MUTATE_CB));
+	}
+
+	kfms->nblocks -= 1;
+	kfms->changed = 1;
+}
+
+/*
+ * Allocate the storage of a packed program 'kfp' with 'nblocks' code blocks
+ * and 'ninstructions' instructions in all. Returns where the length of
+ * the first code block goes, the code blocks are laid out one after the other.
+ */
+static KFORTH_INTEGER *kforth_program_alloc(KFORTH_PROGRAM *kfp, int nblocks, int ninstructions)
+{
+	size_t size;
+
+	size = nblocks * sizeof(KFORTH_INTEGER*) + (nblocks + ninstructions) * sizeof(KFORTH_INTEGER);
+
+	kfp->block = (KFORTH_INTEGER**) MALLOC(size);
+	ASSERT( kfp->block != NULL );
+
+	kfp->nblocks		= nblocks;
+	kfp->packed			= size;
+	kfp->translation	= NULL;
+	kfp->version		= 0;
+
+	return (KFORTH_INTEGER*) (kfp->block + nblocks);
+}
+
+/*
+ * Make the program in the scratch area into 'kfp' (a packed program).
+ */
+static void scratch_program(KFORTH_MUTATE_SCRATCH *kfms, KFORTH_PROGRAM *kfp)
+{
+	KFORTH_INTEGER *p;
+	int cb, len, ninstructions;
+
+	ninstructions = 0;
+	for(cb=0; cb < kfms->nblocks; cb++) {
+		ninstructions += kfms->block[cb].len;
+	}
+
+	p = kforth_program_alloc(kfp, kfms->nblocks, ninstructions);
+	kfp->nprotected = kfms->nprotected;
+
+	for(cb=0; cb < kfms->nblocks; cb++) {
+		len = kfms->block[cb].len;
+
+		p[0] = len;
+		kfp->block[cb] = p+1;
+
+		if( len > 0 ) {
+			memcpy(p+1, scratch_code(kfms, cb), len * sizeof(KFORTH_INTEGER));
+		}
+
+		p += len+1;
+	}
+}
+
+/***********************************************************************
+ * MUTATIONS
+ *
+ */
 static void choose_instruction(EVOLVE_RANDOM *er, KFORTH_OPERATIONS *kfops, KFORTH_MUTATE_OPTIONS *kfmo, KFORTH_INTEGER *value)
 {
 	long x;
@@ -73,20 +347,21 @@ static void choose_instruction(EVOLVE_RANDOM *er, KFORTH_OPERATIONS *kfops, KFOR
  */
 static void modify_single_instruction(EVOLVE_RANDOM *er, KFORTH_MUTATE_OPTIONS *kfmo,
 				KFORTH_OPERATIONS *kfops,
-				KFORTH_PROGRAM *kfp, int cb, int pc )
+				KFORTH_MUTATE_SCRATCH *kfms, int cb, int pc )
 {
-	int delta;
+	int delta, len;
 	int NUMB = 4;		/* new numbers are picked from -NUMB ... +NUMB */
 	KFORTH_INTEGER value;
 
 	ASSERT( er != NULL );
 	ASSERT( kfops != NULL );
 	ASSERT( kfmo != NULL );
-	ASSERT( kfp != NULL );
-	ASSERT( cb >= 0 && cb < kfp->nblocks );
+	ASSERT( kfms != NULL );
+	ASSERT( cb >= 0 && cb < kfms->nblocks );
 	ASSERT( pc >= 0 );
 
-	value = kfp->block[cb][pc];
+	len = scratch_cblen(kfms, cb);
+	value = scratch_code(kfms, cb)[pc];
 
 	if( value & 0x8000 ) {
 		value = value & 0x7fff;
@@ -114,11 +389,11 @@ static void modify_single_instruction(EVOLVE_RANDOM *er, KFORTH_MUTATE_OPTIONS *
 			value = 0;
 		}
 
-		kfp->block[cb][pc] = 0x8000 | value;
+		scratch_edit(kfms, cb, len)[pc] = 0x8000 | value;
 
 	} else {
 		if( kfops->nprotected <= kfops->count-1 ) {
-			kfp->block[cb][pc] = (unsigned char) CHOOSE(er, kfops->nprotected, kfops->count-1);
+			scratch_edit(kfms, cb, len)[pc] = (unsigned char) CHOOSE(er, kfops->nprotected, kfops->count-1);
 		}
 	}
 
@@ -142,15 +417,15 @@ int kforth_program_cblen(KFORTH_PROGRAM *kfp, int cb)
 /*
  * Pick random code block insert it into a random spot.
  */
-static void duplicate_code_block(KFORTH_PROGRAM *kfp, KFORTH_MUTATE_OPTIONS *kfmo, EVOLVE_RANDOM *er)
+static void duplicate_code_block(KFORTH_MUTATE_SCRATCH *kfms, KFORTH_MUTATE_OPTIONS *kfmo, EVOLVE_RANDOM *er)
 {
-	int cb, nblocks, pc, i, len;
-	KFORTH_INTEGER *block;
+	int cb, nblocks, off;
+	KFORTH_MUTATE_CB dup, *b;
 
-	ASSERT( kfp != NULL );
+	ASSERT( kfms != NULL );
 	ASSERT( er != NULL );
 
-	nblocks = kfp->nblocks;
+	nblocks = kfms->nblocks;
 
 	if( nblocks == 0 )
 		return;
@@ -158,65 +433,63 @@ static void duplicate_code_block(KFORTH_PROGRAM *kfp, KFORTH_MUTATE_OPTIONS *kfm
 	/*
 	 * do not do proceed, if program has max_code_blocks (unprotected) code blocks
 	 */
-	if( nblocks - kfp->nprotected >= kfmo->max_code_blocks )
+	if( nblocks - kfms->nprotected >= kfmo->max_code_blocks )
 		return;
 
 	/*
 	 * do not do proceed, if program does not contain any unprotected code blocks to duplicate.
 	 */
-	if( nblocks <= kfp->nprotected )
+	if( nblocks <= kfms->nprotected )
 		return;
 
 	/*
 	 * Pick a code block to duplicate (and remember it)
 	 */
-	cb	= CHOOSE(er, kfp->nprotected, nblocks-1);
-	len	= kforth_program_cblen(kfp, cb);
-	block = kfp->block[cb];
+	cb	= CHOOSE(er, kfms->nprotected, nblocks-1);
+	dup	= kfms->block[cb];
 
 	/*
-	 * Grow program to fit 1 more code block
+	 * Shift all code blocks at 'cb'
 	 */
-	kfp->block = (KFORTH_INTEGER**) REALLOC(kfp->block, (nblocks+1) * sizeof(KFORTH_INTEGER*));
-	kfp->nblocks = nblocks+1;
+	cb = CHOOSE(er, kfms->nprotected, nblocks);
+	b = scratch_insert_cb(kfms, cb);
+	*b = dup;
 
 	/*
-	 * Shift all code blocks at 'cb'
+	 * A code block in the pool gets its own copy, so the two
+	 * can be changed separately.
 	 */
-	cb = CHOOSE(er, kfp->nprotected, nblocks);
-	if( cb < nblocks ) {
-		for(i=nblocks; i>cb; i--) {
-			kfp->block[i] = kfp->block[i-1];
+	if( dup.src == NULL ) {
+		off = scratch_alloc(kfms, dup.len);
+		if( dup.len > 0 ) {
+			memcpy(kfms->pool + off, kfms->pool + dup.off, dup.len * sizeof(KFORTH_INTEGER));
 		}
+		b->off	= off;
+		b->size	= dup.len;
 	}
-
-	kfp->block[cb] = ((KFORTH_INTEGER*) CALLOC(len+1, sizeof(KFORTH_INTEGER)) + 1);
-
-	for(pc=0; pc<len; pc++) {
-		kfp->block[cb][pc] = block[pc];
-	}
-	kfp->block[cb][-1] = len;
 }
 
 /*
  * Pick a random sequence of 1 - XLEN instructions and insert it at a random spot
  */
-static void duplicate_instruction(KFORTH_PROGRAM *kfp, KFORTH_MUTATE_OPTIONS *kfmo, EVOLVE_RANDOM *er)
+static void duplicate_instruction(KFORTH_MUTATE_SCRATCH *kfms, KFORTH_MUTATE_OPTIONS *kfmo, EVOLVE_RANDOM *er)
 {
 	int cb, pc, block_len, len, i;
 	KFORTH_INTEGER save[XLEN_MAX];
+	const KFORTH_INTEGER *code;
+	KFORTH_INTEGER *block;
 
-	ASSERT( kfp != NULL );
+	ASSERT( kfms != NULL );
 	ASSERT( er != NULL );
 
 	/*
  	 * do not proceed, if program has no unproteced code blocks to duplicate instructions from/into
 	 */
-	if( kfp->nblocks <= kfp->nprotected )
+	if( kfms->nblocks <= kfms->nprotected )
 		return;
 
-	cb = CHOOSE(er, kfp->nprotected, kfp->nblocks-1);
-	block_len = kforth_program_cblen(kfp, cb);
+	cb = CHOOSE(er, kfms->nprotected, kfms->nblocks-1);
+	block_len = scratch_cblen(kfms, cb);
 
 	if( block_len == 0 )
 		return;
@@ -228,20 +501,21 @@ static void duplicate_instruction(KFORTH_PROGRAM *kfp, KFORTH_MUTATE_OPTIONS *kf
 	 */
 	pc = CHOOSE(er, 0, block_len-len);
 
+	code = scratch_code(kfms, cb);
 	for(i=0; i<len; i++) {
-		save[i] = kfp->block[cb][pc+i];
+		save[i] = code[pc+i];
 	}
 
 	/*
 	 * pick random code block to insert
 	 */
-	cb = CHOOSE(er, kfp->nprotected, kfp->nblocks-1);
-	block_len = kforth_program_cblen(kfp, cb);
+	cb = CHOOSE(er, kfms->nprotected, kfms->nblocks-1);
+	block_len = scratch_cblen(kfms, cb);
 
 	/*
 	 * Grow program to fit len more instructions in 'cb'
 	 */
-	kfp->block[cb] = ((KFORTH_INTEGER*) REALLOC(kfp->block[cb]-1, (block_len+len+1) * sizeof(KFORTH_INTEGER))) + 1;
+	block = scratch_edit(kfms, cb, block_len+len);
 
 	/*
 	 * make gap at 'pc' for len instructions
@@ -249,38 +523,38 @@ static void duplicate_instruction(KFORTH_PROGRAM *kfp, KFORTH_MUTATE_OPTIONS *kf
 	pc = CHOOSE(er, 0, block_len);
 	if( pc < block_len ) {
 		for(i=block_len+len-1; i > pc+len-1; i--) {
-			kfp->block[cb][i] = kfp->block[cb][i-len];
+			block[i] = block[i-len];
 		}
 	}
-	kfp->block[cb][-1] = block_len+len;
+	kfms->block[cb].len = block_len+len;
 
 	/*
 	 * Insert copy of instruction
 	 */
 	for(i=0; i<len; i++){
-		kfp->block[cb][pc+i] = save[i];
+		block[pc+i] = save[i];
 	}
 }
 
 /*
  * Remove an entire code block
  */
-static void delete_code_block(KFORTH_PROGRAM *kfp, KFORTH_MUTATE_OPTIONS *kfmo, EVOLVE_RANDOM *er)
+static void delete_code_block(KFORTH_MUTATE_SCRATCH *kfms, KFORTH_MUTATE_OPTIONS *kfmo, EVOLVE_RANDOM *er)
 {
-	int cb, nblocks, i;
+	int cb, nblocks;
 
-	ASSERT( kfp != NULL );
+	ASSERT( kfms != NULL );
 	ASSERT( er != NULL );
 
 	/*
 	 * Delete entire code block and move subsequent code blocks up.
 	 */
-	nblocks = kfp->nblocks;
+	nblocks = kfms->nblocks;
 
 	/*
 	 * do not do proceed, if program has no unprotected code blocks to delete
 	 */
-	if( nblocks <= kfp->nprotected )
+	if( nblocks <= kfms->nprotected )
 		return;
 
 	/*
@@ -289,36 +563,31 @@ static void delete_code_block(KFORTH_PROGRAM *kfp, KFORTH_MUTATE_OPTIONS *kfmo,
 	if( nblocks <= 1 )
 		return;
 
-	cb = CHOOSE(er, kfp->nprotected, nblocks-1);
+	cb = CHOOSE(er, kfms->nprotected, nblocks-1);
 
-	FREE( kfp->block[cb]-1 );
-
-	for(i=cb; i<nblocks-1; i++) {
-		kfp->block[i] = kfp->block[i+1];
-	}
-
-	kfp->nblocks = nblocks-1;
+	scratch_delete_cb(kfms, cb);
 }
 
 /*
  * Delete 1 - XLEN instructions from a random place in a random code block
  */
-static void delete_instruction(KFORTH_PROGRAM *kfp, KFORTH_MUTATE_OPTIONS *kfmo, EVOLVE_RANDOM *er)
+static void delete_instruction(KFORTH_MUTATE_SCRATCH *kfms, KFORTH_MUTATE_OPTIONS *kfmo, EVOLVE_RANDOM *er)
 {
 	int cb, pc, block_len, len, i;
+	KFORTH_INTEGER *block;
 
-	ASSERT( kfp != NULL );
+	ASSERT( kfms != NULL );
 	ASSERT( er != NULL );
 
 	/*
 	 * do not proceed, if program has no unprotected code blocks to delete instructions from
 	 */
-	if( kfp->nblocks <= kfp->nprotected )
+	if( kfms->nblocks <= kfms->nprotected )
 		return;
 
-	cb = CHOOSE(er, kfp->nprotected, kfp->nblocks-1);
+	cb = CHOOSE(er, kfms->nprotected, kfms->nblocks-1);
 
-	block_len = kforth_program_cblen(kfp, cb);
+	block_len = scratch_cblen(kfms, cb);
 
 	if( block_len == 0 )
 		return;
@@ -327,10 +596,11 @@ static void delete_instruction(KFORTH_PROGRAM *kfp, KFORTH_MUTATE_OPTIONS *kfmo,
 
 	pc = CHOOSE(er, 0, block_len - len);
 
+	block = scratch_edit(kfms, cb, block_len);
 	for(i=pc; i < block_len - len; i++) {
-		kfp->block[cb][i] = kfp->block[cb][i+len];
+		block[i] = block[i+len];
 	}
-	kfp->block[cb][-1] = block_len - len;
+	kfms->block[cb].len = block_len - len;
 }
 
 /*
@@ -338,44 +608,34 @@ static void delete_instruction(KFORTH_PROGRAM *kfp, KFORTH_MUTATE_OPTIONS *kfmo,
  * will contain random instructions. Length of new code block
  * will be randomly between 0 and XLEN.
  */
-static void insert_code_block(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MUTATE_OPTIONS *kfmo, EVOLVE_RANDOM *er)
+static void insert_code_block(KFORTH_OPERATIONS *kfops, KFORTH_MUTATE_SCRATCH *kfms, KFORTH_MUTATE_OPTIONS *kfmo, EVOLVE_RANDOM *er)
 {
-	int cb, pc, nblocks, i, len;
+	int cb, pc, nblocks, len, off;
 	KFORTH_INTEGER value;
+	KFORTH_MUTATE_CB *b;
 
-	ASSERT( kfp != NULL );
+	ASSERT( kfms != NULL );
 	ASSERT( er != NULL );
 
-	/*
-	 * Grow program to fit 1 more code block
-	 */
-	nblocks = kfp->nblocks;
+	nblocks = kfms->nblocks;
 
 	/*
 	 * do not do proceed, if program has max_code_blocks (unprotected) code blocks
 	 */
-	if( nblocks - kfp->nprotected >= kfmo->max_code_blocks )
+	if( nblocks - kfms->nprotected >= kfmo->max_code_blocks )
 		return;
 
 	/*
 	 * do not do proceed, if program is smaller than the size of the protected region.
 	 * (adding a code block would require modifying protected code blocks)
 	 */
-	if( nblocks < kfp->nprotected )
+	if( nblocks < kfms->nprotected )
 		return;
 
-	kfp->block = (KFORTH_INTEGER**)REALLOC(kfp->block, (nblocks+1) * sizeof(KFORTH_INTEGER*));
-	kfp->nblocks = nblocks+1;
-
 	if( nblocks == 0 ) {
 		cb = 0;
 	} else {
-		cb = CHOOSE(er, kfp->nprotected, nblocks);
-		if( cb < nblocks ) {
-			for(i=nblocks; i>cb; i--) {
-				kfp->block[i] = kfp->block[i-1];
-			}
-		}
+		cb = CHOOSE(er, kfms->nprotected, nblocks);
 	}
 
 	/*
@@ -383,37 +643,43 @@ static void insert_code_block(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFO
 	 * Random length between 0 and XLEN.
 	 */
 	len = CHOOSE(er, 0, kfmo->xlen);
-	kfp->block[cb] = ((KFORTH_INTEGER*) CALLOC(len+1, sizeof(KFORTH_INTEGER))) + 1;
+	off = scratch_alloc(kfms, len);
+
+	b = scratch_insert_cb(kfms, cb);
+	b->src	= NULL;
+	b->off	= off;
+	b->len	= len;
+	b->size	= len;
 
 	for(pc=0; pc < len; pc++) {
 		choose_instruction(er, kfops, kfmo, &value);
-		kfp->block[cb][pc] = value;
+		kfms->pool[off+pc] = value;
 	}
-	kfp->block[cb][-1] = len;
 }
 
 /*
  * Pick random code block and insert some random instructions 1 - XLEN
  * into code block at a random spot.
  */
-static void insert_instruction(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MUTATE_OPTIONS *kfmo, EVOLVE_RANDOM *er)
+static void insert_instruction(KFORTH_OPERATIONS *kfops, KFORTH_MUTATE_SCRATCH *kfms, KFORTH_MUTATE_OPTIONS *kfmo, EVOLVE_RANDOM *er)
 {
 	int cb, pc, block_len, len, i;
 	KFORTH_INTEGER value[XLEN_MAX];
+	KFORTH_INTEGER *block;
 
-	ASSERT( kfp != NULL );
+	ASSERT( kfms != NULL );
 	ASSERT( kfops != NULL );
 	ASSERT( er != NULL );
 
 	/*
 	 * do not do proceed, if program has no unprotected code blocks to delete instructions from
 	 */
-	if( kfp->nblocks <= kfp->nprotected )
+	if( kfms->nblocks <= kfms->nprotected )
 		return;
 
-	cb = CHOOSE(er, kfp->nprotected, kfp->nblocks-1);
+	cb = CHOOSE(er, kfms->nprotected, kfms->nblocks-1);
 
-	block_len = kforth_program_cblen(kfp, cb);
+	block_len = scratch_cblen(kfms, cb);
 
 	/*
 	 * Pick 1 to XLEN random instructions.
@@ -426,7 +692,7 @@ static void insert_instruction(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KF
 	/*
 	 * Grow program to fit len more instructions in 'cb'
 	 */
-	kfp->block[cb] = ((KFORTH_INTEGER*) REALLOC(kfp->block[cb]-1, (block_len+len+1) * sizeof(KFORTH_INTEGER))) + 1;
+	block = scratch_edit(kfms, cb, block_len+len);
 
 	/*
 	 * make gap at 'pc' for len instructions
@@ -434,77 +700,80 @@ static void insert_instruction(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KF
 	pc = CHOOSE(er, 0, block_len);
 	if( pc < block_len ) {
 		for(i=block_len+len-1; i > pc+len-1; i--) {
-			kfp->block[cb][i] = kfp->block[cb][i-len];
+			block[i] = block[i-len];
 		}
 
 	}
-	kfp->block[cb][-1] = block_len+len;
+	kfms->block[cb].len = block_len+len;
 
 	/*
  	 * fill in new instructions
 	 */
 	for(i=0; i < len; i++) {
-		kfp->block[cb][pc+i] = value[i];
+		block[pc+i] = value[i];
 	}
 }
 
 /*
  * Swap 2 randomly chosen code blocks
  */
-static void transpose_code_block(KFORTH_PROGRAM *kfp, KFORTH_MUTATE_OPTIONS *kfmo, EVOLVE_RANDOM *er)
+static void transpose_code_block(KFORTH_MUTATE_SCRATCH *kfms, KFORTH_MUTATE_OPTIONS *kfmo, EVOLVE_RANDOM *er)
 {
 	int cb1, cb2;
-	KFORTH_INTEGER *save_block;
+	KFORTH_MUTATE_CB save_block;
 
-	ASSERT( kfp != NULL );
+	ASSERT( kfms != NULL );
 	ASSERT( er != NULL );
 
 	/*
 	 * If program doesn't have at least 2 unprotected code blocks to transpose, then do nothing
 	 */
-	if( kfp->nblocks - kfp->nprotected < 2 )
+	if( kfms->nblocks - kfms->nprotected < 2 )
 		return;
 
-	cb1 = CHOOSE(er, kfp->nprotected, kfp->nblocks-1);
-	cb2 = CHOOSE(er, kfp->nprotected, kfp->nblocks-1);
+	cb1 = CHOOSE(er, kfms->nprotected, kfms->nblocks-1);
+	cb2 = CHOOSE(er, kfms->nprotected, kfms->nblocks-1);
 
 	if( cb1 == cb2 )
 		return;
 
-	save_block			= kfp->block[cb1];
-	kfp->block[cb1]		= kfp->block[cb2];
-	kfp->block[cb2]		= save_block;
+	save_block			= kfms->block[cb1];
+	kfms->block[cb1]	= kfms->block[cb2];
+	kfms->block[cb2]	= save_block;
+
+	kfms->changed = 1;
 }
 
 /*
  * Pick 2 random instruction segments (1 to XLEN long) and swap them.
  */
-static void transpose_instruction(KFORTH_PROGRAM *kfp, KFORTH_MUTATE_OPTIONS *kfmo, EVOLVE_RANDOM *er)
+static void transpose_instruction(KFORTH_MUTATE_SCRATCH *kfms, KFORTH_MUTATE_OPTIONS *kfmo, EVOLVE_RANDOM *er)
 {
 	int cb1, pc1;
 	int cb2, pc2;
 	int block_len1, block_len2;
 	int len, i;
+	KFORTH_INTEGER *block1, *block2;
 
 	KFORTH_INTEGER save_value[XLEN_MAX];
 
-	ASSERT( kfp != NULL );
+	ASSERT( kfms != NULL );
 	ASSERT( er != NULL );
 
 	/*
 	 * If program doesn't have at least 1 unprotected code block to transpose instructions from, then do nothing
 	 */
-	if( kfp->nblocks <= kfp->nprotected )
+	if( kfms->nblocks <= kfms->nprotected )
 		return;
 
-	cb1 = CHOOSE(er, kfp->nprotected, kfp->nblocks-1);
-	block_len1 = kforth_program_cblen(kfp, cb1);
+	cb1 = CHOOSE(er, kfms->nprotected, kfms->nblocks-1);
+	block_len1 = scratch_cblen(kfms, cb1);
 
 	if( block_len1 == 0 )
 		return;
 
-	cb2 = CHOOSE(er, kfp->nprotected, kfp->nblocks-1);
-	block_len2 = kforth_program_cblen(kfp, cb2);
+	cb2 = CHOOSE(er, kfms->nprotected, kfms->nblocks-1);
+	block_len2 = scratch_cblen(kfms, cb2);
 
 	if( block_len2 == 0 )
 		return;
@@ -521,47 +790,55 @@ static void transpose_instruction(KFORTH_PROGRAM *kfp, KFORTH_MUTATE_OPTIONS *kf
 	pc1 = CHOOSE(er, 0, block_len1-len);
 	pc2 = CHOOSE(er, 0, block_len2-len);
 
+	/*
+	 * Bring both code blocks into the pool first, then
+	 * neither pointer moves.
+	 */
+	scratch_edit(kfms, cb1, block_len1);
+	block2 = scratch_edit(kfms, cb2, block_len2);
+	block1 = scratch_edit(kfms, cb1, block_len1);
+
 	for(i=0; i<len; i++) {
-		save_value[i] = kfp->block[cb1][pc1+i];
+		save_value[i] = block1[pc1+i];
 	}
 
 	for(i=0; i<len; i++) {
-		kfp->block[cb1][pc1+i] = kfp->block[cb2][pc2+i];
+		block1[pc1+i] = block2[pc2+i];
 	}
 
 	for(i=0; i<len; i++) {
-		kfp->block[cb2][pc2+i] = save_value[i];
+		block2[pc2+i] = save_value[i];
 	}
 }
 
 /*
  * Pick a random code block and modify all numbers in it. instructions unchanged.
- * numbers are increased/decreased by a tiny amount, 
+ * numbers are increased/decreased by a tiny amount,
  */
-static void modify_code_block(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MUTATE_OPTIONS *kfmo, EVOLVE_RANDOM *er)
+static void modify_code_block(KFORTH_OPERATIONS *kfops, KFORTH_MUTATE_SCRATCH *kfms, KFORTH_MUTATE_OPTIONS *kfmo, EVOLVE_RANDOM *er)
 {
 	int cb, pc, len;
 
 	ASSERT( kfops != NULL );
-	ASSERT( kfp != NULL );
+	ASSERT( kfms != NULL );
 	ASSERT( kfmo != NULL );
 	ASSERT( er != NULL );
 
 	/*
 	 * If program doesn't have at least 1 unprotected code block to modify, then do nothing
 	 */
-	if( kfp->nblocks - kfp->nprotected < 1 )
+	if( kfms->nblocks - kfms->nprotected < 1 )
 		return;
 
-	cb = CHOOSE(er, kfp->nprotected, kfp->nblocks-1);
-	len = kforth_program_cblen(kfp, cb);
+	cb = CHOOSE(er, kfms->nprotected, kfms->nblocks-1);
+	len = scratch_cblen(kfms, cb);
 
 	if( len == 0 )
 		return;
 
 	for(pc=0; pc < len; pc++) {
-		if( kfp->block[cb][pc] & 0x8000 ) {
-			modify_single_instruction(er, kfmo, kfops, kfp, cb, pc);
+		if( scratch_code(kfms, cb)[pc] & 0x8000 ) {
+			modify_single_instruction(er, kfmo, kfops, kfms, cb, pc);
 		}
 	}
 }
@@ -569,24 +846,24 @@ static void modify_code_block(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFO
 /*
  * Pick a random starting instruction and modify 1 - XLEN sequential instructions.
  */
-static void modify_instruction(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MUTATE_OPTIONS *kfmo, EVOLVE_RANDOM *er)
+static void modify_instruction(KFORTH_OPERATIONS *kfops, KFORTH_MUTATE_SCRATCH *kfms, KFORTH_MUTATE_OPTIONS *kfmo, EVOLVE_RANDOM *er)
 {
 	int cb, pc, block_len, len, i;
 
 	ASSERT( kfops != NULL );
-	ASSERT( kfp != NULL );
+	ASSERT( kfms != NULL );
 	ASSERT( kfmo != NULL );
 	ASSERT( er != NULL );
 
 	/*
 	 * If program doesn't have at least 1 unprotected code block to modify, then do nothing
 	 */
-	if( kfp->nblocks - kfp->nprotected < 1 )
+	if( kfms->nblocks - kfms->nprotected < 1 )
 		return;
 
-	cb = CHOOSE(er, kfp->nprotected, kfp->nblocks-1);
+	cb = CHOOSE(er, kfms->nprotected, kfms->nblocks-1);
 
-	block_len = kforth_program_cblen(kfp, cb);
+	block_len = scratch_cblen(kfms, cb);
 
 	if( block_len == 0 )
 		return;
@@ -595,15 +872,12 @@ static void modify_instruction(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KF
 	pc = CHOOSE(er, 0, block_len - len);
 
 	for(i=0; i<len; i++) {
-		modify_single_instruction(er, kfmo, kfops, kfp, cb, pc+i);
+		modify_single_instruction(er, kfmo, kfops, kfms, cb, pc+i);
 	}
 }
 
-
-/***********************************************************************
- * Using the mutation options 'kfmo' and
- * the random number generator 'er' make a tiny
- * random change to kfp.
+/*
+ * Apply the mutation algorithm to the program in the scratch area.
  *
  * The first step is to determine if we will act at the instruction-level or
  * the codeblock-level. Once this determiniation is made, we check to
@@ -611,26 +885,22 @@ static void modify_instruction(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KF
  * out they we perfom NO mutations at all).
  *
  */
-void kforth_mutate(KFORTH_OPERATIONS *kfops,
+static void mutate(KFORTH_OPERATIONS *kfops,
 			KFORTH_MUTATE_OPTIONS *kfmo,
 			EVOLVE_RANDOM *er,
-			KFORTH_PROGRAM *kfp)
+			KFORTH_MUTATE_SCRATCH *kfms)
 {
 	long x;
 	int mutate_code_block;
 	int napply, i;
 
-	ASSERT( kfops != NULL );
-	ASSERT( kfp != NULL );
-	ASSERT( kfmo != NULL );
-	ASSERT( er != NULL );
-	ASSERT( kfp->nblocks > 0 );
+	ASSERT( kfms->nblocks > 0 );
 
 	/*
 	 * Program is smaller than the protected region by 1 code block,
 	 * no mutations will change this, so we can exit now.
  	 */
-	if( kfp->nblocks < kfp->nprotected )
+	if( kfms->nblocks < kfms->nprotected )
 		return;
 
 	if( kfmo->max_apply == 1 ) {
@@ -659,9 +929,9 @@ void kforth_mutate(KFORTH_OPERATIONS *kfops,
 		x = CHOOSE(er, 0, PROBABILITY_SCALE);
 		if( x < kfmo->prob_duplicate ) {
 			if( mutate_code_block )
-				duplicate_code_block(kfp, kfmo, er);
+				duplicate_code_block(kfms, kfmo, er);
 			else
-				duplicate_instruction(kfp, kfmo, er);
+				duplicate_instruction(kfms, kfmo, er);
 		}
 
 		/*
@@ -670,9 +940,9 @@ void kforth_mutate(KFORTH_OPERATIONS *kfops,
 		x = CHOOSE(er, 0, PROBABILITY_SCALE);
 		if( x < kfmo->prob_delete ) {
 			if( mutate_code_block )
-				delete_code_block(kfp, kfmo, er);
+				delete_code_block(kfms, kfmo, er);
 			else
-				delete_instruction(kfp, kfmo, er);
+				delete_instruction(kfms, kfmo, er);
 		}
 
 		/*
@@ -681,9 +951,9 @@ void kforth_mutate(KFORTH_OPERATIONS *kfops,
 		x = CHOOSE(er, 0, PROBABILITY_SCALE);
 		if( x < kfmo->prob_insert ) {
 			if( mutate_code_block )
-				insert_code_block(kfops, kfp, kfmo, er);
+				insert_code_block(kfops, kfms, kfmo, er);
 			else
-				insert_instruction(kfops, kfp, kfmo, er);
+				insert_instruction(kfops, kfms, kfmo, er);
 		}
 
 		/*
@@ -692,9 +962,9 @@ void kforth_mutate(KFORTH_OPERATIONS *kfops,
 		x = CHOOSE(er, 0, PROBABILITY_SCALE);
 		if( x < kfmo->prob_transpose ) {
 			if( mutate_code_block )
-				transpose_code_block(kfp, kfmo, er);
+				transpose_code_block(kfms, kfmo, er);
 			else
-				transpose_instruction(kfp, kfmo, er);
+				transpose_instruction(kfms, kfmo, er);
 		}
 
 		/*
@@ -703,13 +973,52 @@ void kforth_mutate(KFORTH_OPERATIONS *kfops,
 		x = CHOOSE(er, 0, PROBABILITY_SCALE);
 		if( x < kfmo->prob_modify ) {
 			if( mutate_code_block )
-				modify_code_block(kfops, kfp, kfmo, er);
+				modify_code_block(kfops, kfms, kfmo, er);
 			else
-				modify_instruction(kfops, kfp, kfmo, er);
+				modify_instruction(kfops, kfms, kfmo, er);
 		}
 	}
 }
 
+/***********************************************************************
+ * Using the mutation options 'kfmo' and
+ * the random number generator 'er' make a tiny
+ * random change to kfp.
+ *
+ * 'kfms' is the work space. If anything changed, 'kfp' is replaced
+ * by a packed program (made with one allocation).
+ *
+ */
+void kforth_mutate(KFORTH_OPERATIONS *kfops,
+			KFORTH_MUTATE_OPTIONS *kfmo,
+			EVOLVE_RANDOM *er,
+			KFORTH_MUTATE_SCRATCH *kfms,
+			KFORTH_PROGRAM *kfp)
+{
+	KFORTH_PROGRAM np;
+
+	ASSERT( kfops != NULL );
+	ASSERT( kfp != NULL );
+	ASSERT( kfmo != NULL );
+	ASSERT( er != NULL );
+	ASSERT( kfms != NULL );
+	ASSERT( kfp->nblocks > 0 );
+
+	kforth_program_changed(kfp);
+
+	scratch_load(kfms, kfp);
+
+	mutate(kfops, kfmo, er, kfms);
+
+	if( kfms->changed ) {
+		scratch_program(kfms, &np);
+		np.version = kfp->version;
+
+		kforth_program_deinit(kfp);
+		*kfp = np;
+	}
+}
+
 /*
  * Apply the mutation algorthm to 'block'
  *
@@ -719,34 +1028,48 @@ void kforth_mutate(KFORTH_OPERATIONS *kfops,
 void kforth_mutate_cb(KFORTH_OPERATIONS *kfops,
 			KFORTH_MUTATE_OPTIONS *kfmo,
 			EVOLVE_RANDOM *er,
+			KFORTH_MUTATE_SCRATCH *kfms,
 			KFORTH_INTEGER **block )
 {
-	KFORTH_PROGRAM kfp;
-	KFORTH_INTEGER *blocks[1];
 	KFORTH_MUTATE_OPTIONS new_kfmo;
+	KFORTH_INTEGER *new_block;
+	int len;
 
 	ASSERT( kfops != NULL );
 	ASSERT( kfmo != NULL );
 	ASSERT( er != NULL );
+	ASSERT( kfms != NULL );
 	ASSERT( block != NULL );
 	ASSERT( *block != NULL );
 
-	kfp.nblocks = 1;
-	kfp.nprotected = 0;
-	kfp.block = blocks;
-	blocks[0] = *block;
+	scratch_begin(kfms, 0);
+	scratch_append(kfms, *block);
 
 	new_kfmo = *kfmo;
 
 	// don't mutate at code block level
-	new_kfmo.prob_mutate_codeblock = 0;		
+	new_kfmo.prob_mutate_codeblock = 0;
 
 	// don't use the max_apply full amount, it may be too much for a single code block.
-	new_kfmo.max_apply = (new_kfmo.max_apply) ? 1 : 0;	
+	new_kfmo.max_apply = (new_kfmo.max_apply) ? 1 : 0;
 
-	kforth_mutate(kfops, &new_kfmo, er, &kfp);
+	mutate(kfops, &new_kfmo, er, kfms);
 
-	*block = blocks[0];		// 'block' may have been reallocated
+	ASSERT( kfms->nblocks == 1 );
+
+	if( kfms->changed ) {
+		len = scratch_cblen(kfms, 0);
+
+		new_block = ((KFORTH_INTEGER*) MALLOC((len+1) * sizeof(KFORTH_INTEGER))) + 1;
+		new_block[-1] = len;
+
+		if( len > 0 ) {
+			memcpy(new_block, scratch_code(kfms, 0), len * sizeof(KFORTH_INTEGER));
+		}
+
+		FREE( *block-1 );
+		*block = new_block;
+	}
 }
 
 /*
@@ -762,7 +1085,7 @@ void kforth_mutate_cb(KFORTH_OPERATIONS *kfops,
  *
  * Merge two kforth program.
  *
- * Merge kfp1 and kfp2 and put the result into kfp
+ * Merge kfp1 and kfp2 and put the result into the scratch area
  *
  * Algorithm:
  * - Pick a 16-bit 'mask' parameter (based on mode/random)
@@ -787,25 +1110,26 @@ void kforth_mutate_cb(KFORTH_OPERATIONS *kfops,
  *	HHUUPP					HHUUPP
  *	JJJJJJ					JJJJJJ
  *
- * Create a new program from 'kfp1' and 'kfp2'. 
- *
  * If programs have different number of code blocks, then
  * extra code blocks from the longer program are appended
  * to the new program.
  *
+ * The code blocks are shared with kfp1 and kfp2 until they change.
+ *
  */
-void kforth_merge2(EVOLVE_RANDOM *er, KFORTH_MUTATE_OPTIONS *kfmo, KFORTH_PROGRAM *kfp1, KFORTH_PROGRAM *kfp2, KFORTH_PROGRAM *kfp)
+static void scratch_merge(EVOLVE_RANDOM *er, KFORTH_MUTATE_OPTIONS *kfmo,
+			KFORTH_MUTATE_SCRATCH *kfms, KFORTH_PROGRAM *kfp1, KFORTH_PROGRAM *kfp2)
 {
 	int mask;
 	KFORTH_PROGRAM *p;
-	int cb, pc, len;
+	int cb, nblocks;
 	int bit, curmask;
 
 	ASSERT( er != NULL );
 	ASSERT( kfmo != NULL );
+	ASSERT( kfms != NULL );
 	ASSERT( kfp1 != NULL );
 	ASSERT( kfp2 != NULL );
-	ASSERT( kfp != NULL );
 
 	if( kfmo->merge_mode == 0 ) {
 		// Merge using a random 16-bit bit string.
@@ -821,18 +1145,17 @@ void kforth_merge2(EVOLVE_RANDOM *er, KFORTH_MUTATE_OPTIONS *kfmo, KFORTH_PROGRA
 	}
 
 	if( kfp1->nblocks > kfp2->nblocks ) {
-		kfp->nblocks = kfp1->nblocks;
+		nblocks = kfp1->nblocks;
 	} else {
-		kfp->nblocks = kfp2->nblocks;
+		nblocks = kfp2->nblocks;
 	}
 
-	kfp->nprotected = (kfp1->nprotected > kfp2->nprotected) ? kfp1->nprotected : kfp2->nprotected ;
-
-	kfp->block = (KFORTH_INTEGER**) CALLOC(kfp->nblocks, sizeof(KFORTH_INTEGER**));
+	scratch_begin(kfms, (kfp1->nprotected > kfp2->nprotected) ? kfp1->nprotected : kfp2->nprotected);
+	scratch_reserve(kfms, nblocks);
 
 	bit = 0;
 	curmask = mask;
-	for(cb=0; cb < kfp->nblocks; cb++) {
+	for(cb=0; cb < nblocks; cb++) {
 		if( (curmask & 0x0001) == 0 ) {
 			if( cb < kfp1->nblocks )
 				p = kfp1;
@@ -845,14 +1168,7 @@ void kforth_merge2(EVOLVE_RANDOM *er, KFORTH_MUTATE_OPTIONS *kfmo, KFORTH_PROGRA
 				p = kfp1;
 		}
 
-		len = kforth_program_cblen(p, cb);
-
-		kfp->block[cb] = ((KFORTH_INTEGER*) CALLOC(len+1, sizeof(KFORTH_INTEGER))) + 1;
-
-		for(pc=0; pc < len; pc++) {
-			kfp->block[cb][pc] = p->block[cb][pc];
-		}
-		kfp->block[cb][-1] = len;
+		scratch_append(kfms, p->block[cb]);
 
 		curmask = curmask >> 1;
 		bit += 1;
@@ -862,6 +1178,27 @@ void kforth_merge2(EVOLVE_RANDOM *er, KFORTH_MUTATE_OPTIONS *kfmo, KFORTH_PROGRA
 	}
 }
 
+/*
+ * Merge kfp1 and kfp2 and put the result into kfp
+ */
+void kforth_merge2(EVOLVE_RANDOM *er, KFORTH_MUTATE_OPTIONS *kfmo, KFORTH_PROGRAM *kfp1, KFORTH_PROGRAM *kfp2, KFORTH_PROGRAM *kfp)
+{
+	KFORTH_MUTATE_SCRATCH kfms;
+
+	ASSERT( er != NULL );
+	ASSERT( kfmo != NULL );
+	ASSERT( kfp1 != NULL );
+	ASSERT( kfp2 != NULL );
+	ASSERT( kfp != NULL );
+
+	kforth_mutate_scratch_init(&kfms);
+
+	scratch_merge(er, kfmo, &kfms, kfp1, kfp2);
+	scratch_program(&kfms, kfp);
+
+	kforth_mutate_scratch_deinit(&kfms);
+}
+
 KFORTH_PROGRAM *kforth_merge(EVOLVE_RANDOM *er, KFORTH_MUTATE_OPTIONS *kfmo, KFORTH_PROGRAM *kfp1, KFORTH_PROGRAM *kfp2)
 {
 	KFORTH_PROGRAM *kfp;
@@ -879,38 +1216,59 @@ KFORTH_PROGRAM *kforth_merge(EVOLVE_RANDOM *er, KFORTH_MUTATE_OPTIONS *kfmo, KFO
 	return kfp;
 }
 
-// Copy code block cb1 to cb2, including 
-static void kforth_program_cbcpy(KFORTH_INTEGER *cb1, KFORTH_INTEGER *cb2)
+/***********************************************************************
+ * Merge kfp1 and kfp2, then mutate the result and put it into kfp.
+ *
+ * Same as kforth_merge2() followed by kforth_mutate(), but the merged
+ * program is only made once, after the mutations are done.
+ *
+ */
+void kforth_merge_mutate(KFORTH_OPERATIONS *kfops,
+			KFORTH_MUTATE_OPTIONS *kfmo,
+			EVOLVE_RANDOM *er,
+			KFORTH_MUTATE_SCRATCH *kfms,
+			KFORTH_PROGRAM *kfp1,
+			KFORTH_PROGRAM *kfp2,
+			KFORTH_PROGRAM *kfp)
 {
-	int pc, len;
-
-	len = cb1[-1];
+	ASSERT( kfops != NULL );
+	ASSERT( kfmo != NULL );
+	ASSERT( er != NULL );
+	ASSERT( kfms != NULL );
+	ASSERT( kfp1 != NULL );
+	ASSERT( kfp2 != NULL );
+	ASSERT( kfp != NULL );
 
-	for(pc=0; pc < len; pc++)			// 	CHANGED
-	{
-		cb2[pc] = cb1[pc];
-	}
-	//cb2[pc] = 0; // ENDCB instruction		// DELETED
-	cb2[-1] = cb1[-1];						// ADDED
+	scratch_merge(er, kfmo, kfms, kfp1, kfp2);
+	mutate(kfops, kfmo, er, kfms);
+	scratch_program(kfms, kfp);
 }
 
+/*
+ * Copy 'kfp' into 'kfp2' (a packed program)
+ */
 void kforth_copy2(KFORTH_PROGRAM *kfp, KFORTH_PROGRAM *kfp2)
 {
-	int cb, len;
+	KFORTH_INTEGER *p;
+	int cb, len, ninstructions;
 
 	ASSERT( kfp != NULL );
 	ASSERT( kfp2 != NULL );
 
-	kfp2->nblocks = kfp->nblocks;
+	ninstructions = 0;
+	for(cb=0; cb < kfp->nblocks; cb++) {
+		ninstructions += kforth_program_cblen(kfp, cb);
+	}
+
+	p = kforth_program_alloc(kfp2, kfp->nblocks, ninstructions);
 	kfp2->nprotected = kfp->nprotected;
-	kfp2->block = (KFORTH_INTEGER**) CALLOC(kfp->nblocks, sizeof(KFORTH_INTEGER**));
 
 	for(cb=0; cb < kfp->nblocks; cb++)
 	{
 		len = kforth_program_cblen(kfp, cb);
-		kfp2->block[cb] = ((KFORTH_INTEGER*) CALLOC(len+1, sizeof(KFORTH_INTEGER))) + 1;		// CHANGED
-		kforth_program_cbcpy(kfp->block[cb], kfp2->block[cb]);
-
+		memcpy(p, kfp->block[cb]-1, (len+1) * sizeof(KFORTH_INTEGER));
+		kfp2->block[cb] = p+1;
+		p += len+1;
 	}
 }
 
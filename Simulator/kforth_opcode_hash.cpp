@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2022 Ken Stauffer
+ */
+
+/***********************************************************************
+ * KFORTH OPCODE HASH
+ *
+ * A perfect hash of the instruction names in EvolveOperations() (the CORE
+ * instructions and the cell instructions). Each name has a slot of its own
+ * in 0 .. KF_OPCODE_HASH_SIZE-1, so finding an instruction by name costs
+ * one hash of the name and one stricmp().
+ *
+ * The hash is built by the C++ compiler (constexpr), it is "hash and
+ * displace": the names are spread over KF_OPCODE_HASH_BUCKETS buckets,
+ * then for each bucket (biggest first) we search for a displacement that
+ * puts all of its names into empty slots. A name's slot is
+ *
+ *	slot = mix(h + disp[bucket] * 0x9e3779b9) % KF_OPCODE_HASH_SIZE
+ *
+ * where 'h' is a case insensitive FNV-1a hash of the name, and
+ * bucket = h % KF_OPCODE_HASH_BUCKETS.
+ *
+ * Instruction tables are all made from the EvolveOperations() names, but
+ * every strain can remove and re-order instructions. So each
+ * KFORTH_OPERATIONS has its own 'hash' array mapping slots to its opcodes.
+ * kforth_ops_hash() fills it in whenever the table changes.
+ *
+ * Tables may have instructions that are not in this list (the organism
+ * finder, the 'k' mode of evolve_batch). Those are counted in
+ * 'nunhashed' and kforth_ops_find() looks for them the slow way.
+ *
+ * When adding an instruction to EvolveOperations() or kforth_ops_init(),
+ * add its name here too (EvolveOperations() ASSERTs this).
+ *
+ */
+#include "evolve_simulator.h"
+#include "evolve_simulator_private.h"
+
+#define KF_OPCODE_HASH_BUCKETS	64
+#define KF_OPCODE_HASH_TRIES	65536
+
+static constexpr const char *kforth_opcode_names[] = {
+	/*
+	 * CORE instructions, kforth_ops_init()
+	 */
+	"call", "if", "ifelse", "?loop", "?exit", "pop", "dup", "swap",
+	"over", "rot", "?dup", "-rot", "2swap", "2over", "2dup", "2pop",
+	"nip", "tuck", "1+", "1-", "2+", "2-", "2/", "2*",
+	"abs", "sqrt", "+", "-", "*", "/", "mod", "/mod",
+	"negate", "2negate", "<<", ">>", "=", "<>", "<", ">",
+	"<=", ">=", "0=", "or", "and", "not", "invert", "xor",
+	"min", "max", "CB", "CBLEN", "CSLEN", "DSLEN", "R0", "R1",
+	"R2", "R3", "R4", "R5", "R6", "R7", "R8", "R9",
+	"R0!", "R1!", "R2!", "R3!", "R4!", "R5!", "R6!", "R7!",
+	"R8!", "R9!", "R0++", "R1++", "R2++", "R3++", "R4++", "R5++",
+	"R6++", "R7++", "R8++", "R9++", "--R0", "--R1", "--R2", "--R3",
+	"--R4", "--R5", "--R6", "--R7", "--R8", "--R9", "PEEK", "POKE",
+	"NUMBER", "NUMBER!", "?NUMBER!", "OPCODE", "OPCODE!", "OPCODE'", "TRAP1", "TRAP2",
+	"TRAP3", "TRAP4", "TRAP5", "TRAP6", "TRAP7", "TRAP8", "TRAP9", "sign",
+	"pack2", "unpack2", "MAX_INT", "MIN_INT", "HALT", "nop",
+
+	/*
+	 * Cell instructions, EvolveOperations()
+	 */
+	"CMOVE", "OMOVE", "ROTATE", "EAT", "MAKE-SPORE", "MAKE-ORGANIC",
+	"MAKE-BARRIER", "GROW", "GROW.CB", "CSHIFT", "EXUDE", "LOOK",
+	"NEAREST", "FARTHEST", "SIZE", "BIGGEST", "SMALLEST", "TEMPERATURE",
+	"HOTTEST", "COLDEST", "SMELL", "MOOD", "MOOD!", "BROADCAST",
+	"SEND", "RECV", "ENERGY", "AGE", "NUM-CELLS", "HAS-NEIGHBOR",
+	"DIST", "CHOOSE", "RND", "SEND-ENERGY", "POPULATION", "POPULATION.S",
+	"GPS", "NEIGHBORS", "SHOUT", "LISTEN", "SAY", "READ",
+	"WRITE", "KEY-PRESS", "MOUSE-POS", "SPAWN", "S0", "S0!",
+	"G0", "G0!",
+};
+
+#define KF_OPCODE_NAMES		(int) (sizeof(kforth_opcode_names) / sizeof(kforth_opcode_names[0]))
+
+static_assert( KF_OPCODE_NAMES <= KF_OPCODE_HASH_SIZE, "KF_OPCODE_HASH_SIZE is too small" );
+
+static constexpr uint32_t name_hash(const char *name)
+{
+	uint32_t h = 2166136261u;
+	int c = 0;
+
+	while( *name ) {
+		c = (unsigned char) *name++;
+		if( c >= 'A' && c <= 'Z' )
+			c = c - 'A' + 'a';
+		h = (h ^ (uint32_t) c) * 16777619u;
+	}
+
+	return h;
+}
+
+static constexpr int name_slot(uint32_t h, int disp)
+{
+	h += (uint32_t) disp * 0x9e3779b9u;
+
+	h ^= h >> 16;
+	h *= 0x85ebca6bu;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35u;
+	h ^= h >> 16;
+
+	return (int) (h % KF_OPCODE_HASH_SIZE);
+}
+
+typedef struct {
+	uint16_t	disp[ KF_OPCODE_HASH_BUCKETS ];
+	int16_t		name[ KF_OPCODE_HASH_SIZE ];		// index into kforth_opcode_names[], -1 for an empty slot
+	int			ok;
+} KFORTH_OPCODE_HASH;
+
+/*
+ * Build the perfect hash, this runs in the compiler.
+ */
+static constexpr KFORTH_OPCODE_HASH kforth_opcode_hash_make()
+{
+	KFORTH_OPCODE_HASH ph = {};
+	uint32_t h[ KF_OPCODE_NAMES ] = {};
+	int member[ KF_OPCODE_NAMES ] = {};				// names sorted by bucket
+	int start[ KF_OPCODE_HASH_BUCKETS+1 ] = {};		// bucket 'b' is member[start[b]] .. member[start[b+1]-1]
+	int fill[ KF_OPCODE_HASH_BUCKETS ] = {};
+	int order[ KF_OPCODE_HASH_BUCKETS ] = {};
+	int slot[ KF_OPCODE_NAMES ] = {};
+	int i = 0, j = 0, b = 0, k = 0, n = 0, s = 0;
+	int disp = 0, tmp = 0, fits = 0;
+
+	for(s=0; s < KF_OPCODE_HASH_SIZE; s++)
+		ph.name[s] = -1;
+
+	for(i=0; i < KF_OPCODE_NAMES; i++) {
+		h[i] = name_hash(kforth_opcode_names[i]);
+		start[ h[i] % KF_OPCODE_HASH_BUCKETS + 1 ] += 1;
+	}
+
+	for(b=0; b < KF_OPCODE_HASH_BUCKETS; b++)
+		start[b+1] += start[b];
+
+	for(i=0; i < KF_OPCODE_NAMES; i++) {
+		b = h[i] % KF_OPCODE_HASH_BUCKETS;
+		member[ start[b] + fill[b] ] = i;
+		fill[b] += 1;
+	}
+
+	/*
+	 * biggest buckets first
+	 */
+	for(b=0; b < KF_OPCODE_HASH_BUCKETS; b++)
+		order[b] = b;
+
+	for(i=0; i < KF_OPCODE_HASH_BUCKETS; i++) {
+		for(j=i+1; j < KF_OPCODE_HASH_BUCKETS; j++) {
+			if( fill[order[j]] > fill[order[i]] ) {
+				tmp = order[i];
+				order[i] = order[j];
+				order[j] = tmp;
+			}
+		}
+	}
+
+	for(i=0; i < KF_OPCODE_HASH_BUCKETS; i++) {
+		b = order[i];
+		n = fill[b];
+		if( n == 0 )
+			break;
+
+		for(disp=1; disp < KF_OPCODE_HASH_TRIES; disp++) {
+			fits = 1;
+			for(k=0; k < n && fits; k++) {
+				s = name_slot(h[ member[start[b]+k] ], disp);
+				if( ph.name[s] != -1 )
+					fits = 0;
+				for(j=0; j < k; j++) {
+					if( slot[j] == s )
+						fits = 0;
+				}
+				slot[k] = s;
+			}
+
+			if( fits )
+				break;
+		}
+
+		if( disp == KF_OPCODE_HASH_TRIES ) {
+			ph.ok = 0;
+			return ph;
+		}
+
+		ph.disp[b] = (uint16_t) disp;
+		for(k=0; k < n; k++) {
+			ph.name[ slot[k] ] = (int16_t) member[start[b]+k];
+		}
+	}
+
+	ph.ok = 1;
+	return ph;
+}
+
+static constexpr KFORTH_OPCODE_HASH kforth_opcode_hash_table = kforth_opcode_hash_make();
+
+static_assert( kforth_opcode_hash_table.ok, "no perfect hash for kforth_opcode_names[], is a name listed twice?" );
+
+/***********************************************************************
+ * Return the slot for the instruction 'name', or -1 if 'name' is not
+ * one of the EvolveOperations() instructions.
+ *
+ */
+int kforth_opcode_hash(const char *name)
+{
+	uint32_t h;
+	int slot, i;
+
+	ASSERT( name != NULL );
+
+	h = name_hash(name);
+	slot = name_slot(h, kforth_opcode_hash_table.disp[ h % KF_OPCODE_HASH_BUCKETS ]);
+
+	i = kforth_opcode_hash_table.name[slot];
+	if( i >= 0 && stricmp(name, kforth_opcode_names[i]) == 0 )
+		return slot;
+
+	return -1;
+}
+
+/***********************************************************************
+ * Fill in kfops->hash (slot -> opcode+1) and kfops->nunhashed for the
+ * current contents of 'kfops->table'.
+ *
+ */
+void kforth_ops_hash(KFORTH_OPERATIONS *kfops)
+{
+	int i, slot;
+
+	ASSERT( kfops != NULL );
+	ASSERT( kfops->count <= UINT8_MAX );
+
+	memset(kfops->hash, 0, sizeof(kfops->hash));
+	kfops->nunhashed = 0;
+
+	for(i=0; i < kfops->count; i++) {
+		slot = kforth_opcode_hash(kfops->table[i].name);
+		if( slot >= 0 ) {
+			kfops->hash[slot] = (uint8_t) (i+1);
+		} else {
+			kfops->nunhashed += 1;
+		}
+	}
+}
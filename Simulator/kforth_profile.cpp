@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2022 Ken Stauffer
+ */
+
+/***********************************************************************
+ * KFORTH PROFILE
+ *
+ * Opt-in per-opcode profiler. Attach a KFORTH_PROFILE to a
+ * KFORTH_OPERATIONS table and every instruction that
+ * kforth_machine_execute() runs through that table is counted and
+ * timed.
+ *
+ * Example (profile strain 0 of a universe):
+ *
+ *	kfprof = kforth_profile_make();
+ *	kforth_profile_attach(&u->kfops[0], kfprof);
+ *
+ *	for(i=0; i < 1000000; i++)
+ *		Universe_Simulate(u);
+ *
+ *	n = kforth_profile_sort(&u->kfops[0], kfprof, order);
+ *	for(i=0; i < n; i++)
+ *		printf("%s %lld\n", u->kfops[0].table[ order[i] ].name,
+ *					kfprof->executed[ order[i] ]);
+ *
+ *	kforth_profile_attach(&u->kfops[0], NULL);
+ *	kforth_profile_delete(kfprof);
+ *
+ * The counters are only updated when the simulator is compiled with
+ * KFORTH_PROFILER defined (see evolve_simulator_private.h). Otherwise
+ * kforth_machine_execute() contains no profiling code at all, and
+ * kforth_profile_enabled() returns false.
+ *
+ * The profile pointer is copied along with the KFORTH_OPERATIONS
+ * table, so attach the profile after the strain's instructions
+ * have been set up, and detach it before deleting the profile.
+ *
+ */
+#include "evolve_simulator.h"
+#include "evolve_simulator_private.h"
+
+#ifdef __windows__
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+/***********************************************************************
+ * Was the profiler compiled into kforth_machine_execute()?
+ *
+ */
+int kforth_profile_enabled(void)
+{
+#ifdef KFORTH_PROFILER
+	return 1;
+#else
+	return 0;
+#endif
+}
+
+KFORTH_PROFILE *kforth_profile_make(void)
+{
+	KFORTH_PROFILE *kfprof;
+
+	kfprof = (KFORTH_PROFILE *) CALLOC(1, sizeof(KFORTH_PROFILE));
+	ASSERT( kfprof != NULL );
+
+	return kfprof;
+}
+
+void kforth_profile_delete(KFORTH_PROFILE *kfprof)
+{
+	ASSERT( kfprof != NULL );
+
+	FREE(kfprof);
+}
+
+void kforth_profile_clear(KFORTH_PROFILE *kfprof)
+{
+	ASSERT( kfprof != NULL );
+
+	memset(kfprof, 0, sizeof(KFORTH_PROFILE));
+}
+
+/***********************************************************************
+ * Start profiling 'kfops' into 'kfprof'. Pass NULL for 'kfprof' to
+ * stop profiling.
+ *
+ * Several KFORTH_OPERATIONS may share one profile.
+ *
+ */
+void kforth_profile_attach(KFORTH_OPERATIONS *kfops, KFORTH_PROFILE *kfprof)
+{
+	ASSERT( kfops != NULL );
+
+	kfops->profile = kfprof;
+}
+
+/*
+ * Most ticks first, then most executions, then opcode order.
+ */
+static int profile_before(KFORTH_PROFILE *kfprof, int a, int b)
+{
+	if( kfprof->ticks[a] != kfprof->ticks[b] )
+		return kfprof->ticks[a] > kfprof->ticks[b];
+
+	if( kfprof->executed[a] != kfprof->executed[b] )
+		return kfprof->executed[a] > kfprof->executed[b];
+
+	return a < b;
+}
+
+/***********************************************************************
+ * Fill 'order' (KFORTH_OPS_LEN entries) with the opcodes of 'kfops'
+ * that were executed or skipped at least once, most expensive first.
+ *
+ * Returns the number of opcodes stored in 'order'.
+ *
+ */
+int kforth_profile_sort(KFORTH_OPERATIONS *kfops, KFORTH_PROFILE *kfprof, int *order)
+{
+	int i, n, opcode;
+
+	ASSERT( kfops != NULL );
+	ASSERT( kfprof != NULL );
+	ASSERT( order != NULL );
+
+	n = 0;
+	for(opcode=0; opcode < kfops->count; opcode++) {
+		if( kfprof->executed[opcode] == 0 && kfprof->skipped[opcode] == 0 )
+			continue;
+
+		/*
+		 * insertion sort, there are at most KFORTH_OPS_LEN entries
+		 */
+		for(i=n; i > 0; i--) {
+			if( ! profile_before(kfprof, opcode, order[i-1]) )
+				break;
+			order[i] = order[i-1];
+		}
+		order[i] = opcode;
+		n++;
+	}
+
+	return n;
+}
+
+/***********************************************************************
+ * A cheap clock for KFORTH_PROFILE_TICKS() on machines without rdtsc
+ * (also used by the phase timer). Returns nanoseconds since an
+ * arbitrary starting point.
+ *
+ */
+LONG_LONG kforth_profile_ticks(void)
+{
+#ifdef __windows__
+	LARGE_INTEGER freq, now;
+
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&now);
+
+	return (LONG_LONG) ((double)now.QuadPart * 1.0e9 / (double)freq.QuadPart);
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (LONG_LONG) ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2022 Ken Stauffer
+ */
+
+/***********************************************************************
+ * KFORTH TRANSLATE
+ *
+ * Pre-decoded code blocks for kforth_machine_run().
+ *
+ * kforth_machine_execute() decodes every instruction as it fetches it:
+ * test the literal bit, sign extend the literal, or look up the
+ * instruction in the KFORTH_OPERATIONS table. A translated code block has
+ * one KFORTH_XOP per instruction with that work already done, so the run
+ * loop only has to check the stack and call the function.
+ *
+ * Code blocks are translated the first time kforth_machine_run() enters
+ * them. Instructions are still executed by the same functions, so the
+ * results are identical to kforth_machine_execute().
+ *
+ * A translation belongs to one program version. When the program changes
+ * (NUMBER!, OPCODE!, READ, WRITE, mutation, re-mapping) kforth_program_changed()
+ * bumps kfp->version, and the next kforth_translate_block() throws the old
+ * translation away. A new instruction table (kfops->serial) does the same.
+ *
+ * kforth_machine_execute() never uses the translation. The simulator
+ * steps each cell one instruction at a time, and a run loop doesn't help there.
+ *
+ */
+#include "evolve_simulator.h"
+#include "evolve_simulator_private.h"
+
+/*
+ * The 'block' array is allocated along with the KFORTH_TRANSLATION.
+ */
+static KFORTH_TRANSLATION *kforth_translate_make(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp)
+{
+	KFORTH_TRANSLATION *kft;
+
+	kft = (KFORTH_TRANSLATION *) CALLOC(1, sizeof(KFORTH_TRANSLATION) + kfp->nblocks * sizeof(KFORTH_XOP *));
+	ASSERT( kft != NULL );
+
+	kft->serial		= kfops->serial;
+	kft->version	= kfp->version;
+	kft->nblocks	= kfp->nblocks;
+	kft->block		= (KFORTH_XOP **) (kft + 1);
+
+	return kft;
+}
+
+/*
+ * Translate the code block 'block'.
+ */
+static KFORTH_XOP *kforth_translate_cb(KFORTH_OPERATIONS *kfops, KFORTH_INTEGER *block)
+{
+	KFORTH_OPERATION *kfop;
+	KFORTH_XOP *xop, *x;
+	int pc, len, opcode;
+	KFORTH_INTEGER value;
+
+	len = block[-1];
+
+	xop = (KFORTH_XOP *) MALLOC( (len+1) * sizeof(KFORTH_XOP) );
+	ASSERT( xop != NULL );
+
+	for(pc=0; pc < len; pc++) {
+		x = &xop[pc];
+		opcode = block[pc];
+
+		if( opcode & 0x8000 ) {
+			value = opcode & 0x7fff;
+			if( value & 0x4000 )
+				value |= 0x8000; // sign extention
+
+			x->func		= NULL;
+			x->value	= value;
+			x->in		= 0;
+			x->diff		= 1;
+		} else {
+			ASSERT( opcode >= 0 && opcode < KFORTH_OPS_LEN );
+
+			kfop = &kfops->table[opcode];
+
+			x->func		= kfop->func;
+			x->value	= opcode;
+			x->in		= kfop->in;
+			x->diff		= kfop->out - kfop->in;
+		}
+	}
+
+	return xop;
+}
+
+/***********************************************************************
+ * Return the translation of code block 'cb' of 'kfp' (one KFORTH_XOP
+ * per instruction), translating it if needed.
+ *
+ */
+KFORTH_XOP *kforth_translate_block(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, int cb)
+{
+	KFORTH_TRANSLATION *kft;
+
+	ASSERT( kfops != NULL );
+	ASSERT( kfp != NULL );
+	ASSERT( cb >= 0 && cb < kfp->nblocks );
+
+	kft = kfp->translation;
+
+	if( kft != NULL && (kft->serial != kfops->serial || kft->version != kfp->version) ) {
+		kforth_translate_delete(kft);
+		kft = NULL;
+	}
+
+	if( kft == NULL ) {
+		kft = kforth_translate_make(kfops, kfp);
+		kfp->translation = kft;
+	}
+
+	ASSERT( kft->nblocks == kfp->nblocks );
+
+	if( kft->block[cb] == NULL ) {
+		kft->block[cb] = kforth_translate_cb(kfops, kfp->block[cb]);
+	}
+
+	return kft->block[cb];
+}
+
+void kforth_translate_delete(KFORTH_TRANSLATION *kft)
+{
+	int cb;
+
+	ASSERT( kft != NULL );
+
+	for(cb=0; cb < kft->nblocks; cb++) {
+		if( kft->block[cb] != NULL ) {
+			FREE( kft->block[cb] );
+		}
+	}
+
+	FREE( kft );
+}
@@ -82,59 +82,81 @@ static void color_all_cells(UNIVERSE *u, CELL *cell, int *color)
 }
 
 /*
- * Divide the organism into regions, based on
- * how the organism is divided into peices after
- * dead cells are removed.
+ * The 8 neighbors of a cell, going clockwise from north.
+ */
+static const int ring_dx[8] = {  0,  1,  1,  1,  0, -1, -1, -1 };
+static const int ring_dy[8] = { -1, -1,  0,  1,  1,  1,  0, -1 };
+
+#define RING_EDGES	0x55	/* bits for N, E, S, W */
+
+/*
+ * Can the dead cell 'cell' be removed without splitting its organism?
  *
- * The largest region lives, smaller regions
- * will be converted to dead matter.
+ * Returns 1 if none of its neighbors is dead and all of its living
+ * neighbors touch each other without going through 'cell'. Any path
+ * through 'cell' can then go around it instead.
  *
- * If two or more regions "tie" for being the
- * largest, only one of them will remain.
+ */
+static int is_leaf_cell(UNIVERSE *u, CELL *cell)
+{
+	CELL *n;
+	int alive, reached, prev, i;
+
+	ASSERT( cell != NULL );
+	ASSERT( Kforth_Machine_Terminated(&cell->kfm) );
+
+	alive = 0;
+	for(i=0; i < 8; i++) {
+		n = Cell_Neighbor(u, cell, ring_dx[i], ring_dy[i]);
+		if( n == NULL )
+			continue;
+
+		if( Kforth_Machine_Terminated(&n->kfm) )
+			return 0;
+
+		alive |= (1 << i);
+	}
+
+	if( alive == 0 )
+		return 0;
+
+	/*
+	 * Neighbors next to each other on the ring touch, and
+	 * so do N-E, E-S, S-W and W-N (diagonally).
+	 */
+	reached = alive & -alive;
+	do {
+		prev = reached;
+		reached |= (prev << 1) | (prev >> 1) | (prev << 7) | (prev >> 7);
+		reached |= ((prev & RING_EDGES) << 2) | ((prev & RING_EDGES) >> 2)
+					| ((prev & RING_EDGES) << 6) | ((prev & RING_EDGES) >> 6);
+		reached &= alive;
+	} while( reached != prev );
+
+	return (reached == alive);
+}
+
+/*
+ * Divide organism into contigous regions.
+ * Each region is assigned a unique non-zero 'color' number.
  *
- * RETURNS:
- *		0 = no cell deleted was 'u->current_cell'.
- *		1 = u->current_cell was one of the cells deleted.
- *			u->current_cell was adjusted to the next cell.
+ * Returns the number of colors, and the number of living cells
+ * in each region is stored in counts[color-1].
  */
 #define MAX_REGIONS	1000
 
-int Kill_Dead_Cells(UNIVERSE *u, ORGANISM *o)
+static int color_regions(UNIVERSE *u, ORGANISM *o, int *counts)
 {
-	int max_found;
-	long max;
-	int ndead, color, keep_color=0, i;
-	CELL *c, *prev, *nxt;
-	int counts[ MAX_REGIONS ];
-	int cc;
-	int energy = 0;
-
-	ASSERT( u != NULL );
-	ASSERT( o != NULL );
-
-	cc = 0;
+	CELL *c;
+	int color, i;
 
 	/*
 	 * Set the graph coloring field to 0.
-	 * (and count the dead)
 	 */
-	ndead = 0;
 	for(c=o->cells; c; c=c->next) {
 		c->color = 0;
-
-		if( Kforth_Machine_Terminated(&c->kfm) ) {
-			ndead += 1;
-		}
-	}
-
-	if( ndead == 0 ) {
-		return 0;
 	}
 
-	/*
-	 * Divide organism into contigous regions.
-	 * Each region is assigned a unique non-zero 'color' number.
-	 */
 	color = 0;
 	for(c=o->cells; c; c=c->next) {
 		if( Kforth_Machine_Terminated(&c->kfm) ) {
@@ -164,26 +186,138 @@ int Kill_Dead_Cells(UNIVERSE *u, ORGANISM *o)
 		counts[ c->color-1 ] += 1;
 	}
 
+	return color;
+}
+
+#ifdef EVOLVE_DEBUG
+static int count_dead_cells(ORGANISM *o)
+{
+	CELL *c;
+	int ndead;
+
+	ndead = 0;
+	for(c=o->cells; c; c=c->next) {
+		if( Kforth_Machine_Terminated(&c->kfm) ) {
+			ndead += 1;
+		}
+	}
+
+	return ndead;
+}
+
+/*
+ * Check the leaf fast path against the flood fill: every living
+ * cell must end up in one region.
+ */
+static int leaves_keep_one_region(UNIVERSE *u, ORGANISM *o)
+{
+	int counts[ MAX_REGIONS ];
+	int color, i, nregions;
+
+	color = color_regions(u, o, counts);
+
+	nregions = 0;
+	for(i=0; i < color; i++) {
+		if( counts[i] > 0 ) {
+			if( counts[i] != o->ncells - o->ndead )
+				return 0;
+			nregions += 1;
+		}
+	}
+
+	return (nregions <= 1);
+}
+#endif
+
+/*
+ * Divide the organism into regions, based on
+ * how the organism is divided into peices after
+ * dead cells are removed.
+ *
+ * The largest region lives, smaller regions
+ * will be converted to dead matter.
+ *
+ * If two or more regions "tie" for being the
+ * largest, only one of them will remain.
+ *
+ * 'o->ndead' is kept up to date whenever a cell terminates, so
+ * most calls return right away. When every dead cell is a leaf (see
+ * is_leaf_cell) the living cells stay in one region and the flood
+ * fill is skipped.
+ *
+ * RETURNS:
+ *		0 = no cell deleted was 'u->current_cell'.
+ *		1 = u->current_cell was one of the cells deleted.
+ *			u->current_cell was adjusted to the next cell.
+ */
+int Kill_Dead_Cells(UNIVERSE *u, ORGANISM *o)
+{
+	int max_found;
+	long max;
+	int color, keep_color=0, leaves, i;
+	CELL *c, *prev, *nxt;
+	int counts[ MAX_REGIONS ];
+	int cc;
+	int energy = 0;
+
+	ASSERT( u != NULL );
+	ASSERT( o != NULL );
+	ASSERT( o->ndead == count_dead_cells(o) );
+
+	cc = 0;
+
+	if( o->ndead == 0 ) {
+		return 0;
+	}
+
+	PHASE_BEGIN(u, PHASE_KILL_DEAD_CELLS);
+
 	/*
-	 * Find the largest region, set variable "keep_color" to that color.
+	 * Fast path: if all the cells are dead, or every dead cell
+	 * is a leaf, just remove the dead cells.
 	 */
-	max = 0;
+	leaves = 1;
+	if( o->ndead < o->ncells ) {
+		for(c=o->cells; c; c=c->next) {
+			if( Kforth_Machine_Terminated(&c->kfm) && !is_leaf_cell(u, c) ) {
+				leaves = 0;
+				break;
+			}
+		}
+	}
+
+	ASSERT( !leaves || leaves_keep_one_region(u, o) );
+
 	max_found = 0;
-	for(i=0; i < color; i++) {
-		if( counts[i] > max ) {
-			max_found = 1;
-			keep_color = i+1;
-			max = counts[i];
+	if( ! leaves ) {
+		color = color_regions(u, o, counts);
+
+		/*
+		 * Find the largest region, set variable "keep_color" to that color.
+		 */
+		max = 0;
+		for(i=0; i < color; i++) {
+			if( counts[i] > max ) {
+				max_found = 1;
+				keep_color = i+1;
+				max = counts[i];
+			}
 		}
 	}
 
 	/*
 	 * Kill all cells that are not in 'keep_color'
+	 * (or just the dead cells, for the fast path)
 	 */
 	prev = NULL;
 	for(c=o->cells; c; c=nxt) {
 		nxt = c->next;
 
+		if( leaves && !Kforth_Machine_Terminated(&c->kfm) ) {
+			prev = c;
+			continue;
+		}
+
 		if( max_found && c->color == keep_color ) {
 			prev = c;
 			continue;
@@ -207,24 +341,19 @@ int Kill_Dead_Cells(UNIVERSE *u, ORGANISM *o)
 			Grid_Clear(u, c->x, c->y);
 		}
 
-		if( c->u_next ) {
-			c->u_next->u_prev = c->u_prev;
-		}
-		if( c->u_prev ) {
-			c->u_prev->u_next = c->u_next;
-		}
-		if( u->cells == c ) {
-			u->cells = c->u_next;
-		}
-		
 		if( u->current_cell == c ) {
-			u->current_cell = c->u_next;
+			u->current_cell = Schedule_Next(u, c);
 			cc = 1;
 		}
 
+		Schedule_Remove(u, c);
 		Cell_delete(c);
 	}
 
+	o->ndead = 0;
+
+	PHASE_END(u);
+
 	return cc;
 }
 
@@ -243,20 +372,18 @@ static void append_organic(UNIVERSE *u, int x, int y, int energy)
 	type = Grid_GetPtr(u, x, y, &ugp);
 
 	if( type == GT_ORGANIC ) {
-		ugp->u.energy += energy;
+		Grid_SetOrganic(u, x, y, ugp->u.energy + energy);
 
 	} else if( type == GT_BLANK ) {
 		if( energy > 0 ) {
-			ugp->type = GT_ORGANIC;
-			ugp->u.energy = energy;
+			Grid_SetOrganic(u, x, y, energy);
 		}
 
 	} else if( type == GT_CELL ) {
 		if( energy > 0 ) {
-			ugp->type = GT_ORGANIC;
-			ugp->u.energy = energy;
+			Grid_SetOrganic(u, x, y, energy);
 		} else {
-			ugp->type = GT_BLANK;
+			Grid_Clear(u, x, y);
 		}
 
 	} else {
@@ -295,21 +422,12 @@ int Kill_Organism(UNIVERSE *u, ORGANISM *o, int ex, int ey)
 
 			append_organic(u, c->x, c->y, energy);
  			
-			if( c->u_next ) {
-				c->u_next->u_prev = c->u_prev;
-			}
-			if( c->u_prev ) {
-				c->u_prev->u_next = c->u_next;
-			}
-			if( u->cells == c ) {
-				u->cells = c->u_next;
-			}
-
 			if( u->current_cell == c ) {
-				u->current_cell = c->u_next;
+				u->current_cell = Schedule_Next(u, c);
 				cc = 1;
 			}
 
+			Schedule_Remove(u, c);
 			Cell_delete(c);
 			i++;
 		}
@@ -328,31 +446,14 @@ int Kill_Organism(UNIVERSE *u, ORGANISM *o, int ex, int ey)
  * organism with 1 cell at x, y.
  *
  */
-ORGANISM *Organism_Make(
-			int x, int y,
-			int strain, int energy,
-			KFORTH_OPERATIONS *kfops,
-			int protected_codeblocks,
-			const char *program_text,
-			char *errbuf )
+/*
+ * Make a one celled organism that runs 'kfp'. The organism owns the
+ * program afterwards.
+ */
+static ORGANISM *organism_make(int x, int y, int strain, int energy, KFORTH_PROGRAM *kfp)
 {
 	ORGANISM *o;
 	CELL *c;
-	KFORTH_PROGRAM *kfp;
-
-	ASSERT( x >= 0 );
-	ASSERT( y >= 0 );
-	ASSERT( strain >= 0 && strain < EVOLVE_MAX_STRAINS );
-	ASSERT( energy > 0 );
-	ASSERT( program_text != NULL );
-	ASSERT( kfops != NULL );
-	ASSERT( errbuf != NULL );
-
-	kfp = kforth_compile(program_text, kfops, errbuf);
-	if( kfp == NULL )
-		return NULL;
-
-	kfp->nprotected = protected_codeblocks;
 
 	o = (ORGANISM *) CALLOC(1, sizeof(ORGANISM));
 	ASSERT( o != NULL );
@@ -371,7 +472,6 @@ ORGANISM *Organism_Make(
 	o->next = NULL;
 	o->prev = NULL;
 	o->program = *kfp;
-	FREE(kfp);			// we need to free the root pointer, the other stuff has been copied to o->program
 
 	/*
 	 * Initialize cell
@@ -381,12 +481,66 @@ ORGANISM *Organism_Make(
 	c->y = y;
 	c->next = NULL;
 	c->organism = o;
-	c->u_next = NULL;
-	c->u_prev = NULL;
+	c->sidx = -1;
+
+	return o;
+}
+
+ORGANISM *Organism_Make(
+			int x, int y,
+			int strain, int energy,
+			KFORTH_OPERATIONS *kfops,
+			int protected_codeblocks,
+			const char *program_text,
+			char *errbuf )
+{
+	ORGANISM *o;
+	KFORTH_PROGRAM *kfp;
+
+	ASSERT( x >= 0 );
+	ASSERT( y >= 0 );
+	ASSERT( strain >= 0 && strain < EVOLVE_MAX_STRAINS );
+	ASSERT( energy > 0 );
+	ASSERT( program_text != NULL );
+	ASSERT( kfops != NULL );
+	ASSERT( errbuf != NULL );
+
+	kfp = kforth_compile(program_text, kfops, errbuf);
+	if( kfp == NULL )
+		return NULL;
+
+	kfp->nprotected = protected_codeblocks;
+
+	o = organism_make(x, y, strain, energy, kfp);
+	FREE(kfp);			// we need to free the root pointer, the other stuff has been copied to o->program
 
 	return o;
 }
 
+/*
+ * Same as Organism_Make(), but with a program that has already been
+ * compiled. 'kfp' is copied.
+ */
+ORGANISM *Organism_Make_Program(
+			int x, int y,
+			int strain, int energy,
+			int protected_codeblocks,
+			KFORTH_PROGRAM *kfp )
+{
+	KFORTH_PROGRAM np;
+
+	ASSERT( x >= 0 );
+	ASSERT( y >= 0 );
+	ASSERT( strain >= 0 && strain < EVOLVE_MAX_STRAINS );
+	ASSERT( energy > 0 );
+	ASSERT( kfp != NULL );
+
+	kforth_copy2(kfp, &np);
+	np.nprotected = protected_codeblocks;
+
+	return organism_make(x, y, strain, energy, &np);
+}
+
 void Organism_delete(ORGANISM *o)
 {
 	ASSERT( o != NULL );
@@ -395,3 +549,106 @@ void Organism_delete(ORGANISM *o)
 
 	FREE(o);
 }
+
+/***********************************************************************
+ * LINEAGE INDEX
+ *
+ * A snapshot of the parent/child relationships of the living organisms.
+ * It has one entry per living organism, sorted by id, with the number of
+ * living organisms that have it as parent1 or parent2.
+ *
+ * Making the index costs O(N log N), and each lookup is O(log N), instead
+ * of scanning every organism for each organism asked about.
+ *
+ * The index is not updated as the simulation runs, make a new one
+ * after simulating.
+ *
+ */
+static int lineage_compare(const void *a, const void *b)
+{
+	const LINEAGE_ENTRY *e1 = (const LINEAGE_ENTRY *) a;
+	const LINEAGE_ENTRY *e2 = (const LINEAGE_ENTRY *) b;
+
+	if( e1->id < e2->id )
+		return -1;
+	else if( e1->id > e2->id )
+		return 1;
+	else
+		return 0;
+}
+
+static LINEAGE_ENTRY *lineage_find(LINEAGE_INDEX *li, LONG_LONG id)
+{
+	LINEAGE_ENTRY key;
+
+	key.id = id;
+	key.nchildren = 0;
+
+	return (LINEAGE_ENTRY *) bsearch(&key, li->entries, li->n, sizeof(LINEAGE_ENTRY), lineage_compare);
+}
+
+LINEAGE_INDEX *Lineage_Index_Make(UNIVERSE *u)
+{
+	LINEAGE_INDEX *li;
+	LINEAGE_ENTRY *e;
+	ORGANISM *o;
+	int i, n;
+
+	ASSERT( u != NULL );
+
+	li = (LINEAGE_INDEX *) CALLOC(1, sizeof(LINEAGE_INDEX));
+	ASSERT( li != NULL );
+
+	n = 0;
+	for(o=u->organisms; o; o=o->next)
+		n++;
+
+	li->entries = (LINEAGE_ENTRY *) CALLOC(n + 1, sizeof(LINEAGE_ENTRY));
+	ASSERT( li->entries != NULL );
+
+	i = 0;
+	for(o=u->organisms; o; o=o->next) {
+		li->entries[i].id = o->id;
+		li->entries[i].nchildren = 0;
+		i++;
+	}
+	li->n = i;
+
+	qsort(li->entries, li->n, sizeof(LINEAGE_ENTRY), lineage_compare);
+
+	for(o=u->organisms; o; o=o->next) {
+		e = lineage_find(li, o->parent1);
+		if( e != NULL )
+			e->nchildren += 1;
+
+		if( o->parent2 != o->parent1 ) {
+			e = lineage_find(li, o->parent2);
+			if( e != NULL )
+				e->nchildren += 1;
+		}
+	}
+
+	return li;
+}
+
+void Lineage_Index_Delete(LINEAGE_INDEX *li)
+{
+	ASSERT( li != NULL );
+
+	FREE(li->entries);
+	FREE(li);
+}
+
+/*
+ * Number of living organisms that have 'id' as a parent.
+ */
+int Lineage_Index_NChildren(LINEAGE_INDEX *li, LONG_LONG id)
+{
+	LINEAGE_ENTRY *e;
+
+	ASSERT( li != NULL );
+
+	e = lineage_find(li, id);
+
+	return (e != NULL) ? e->nchildren : 0;
+}
@@ -16,19 +16,42 @@
 //
 // 'reset_tracers' will first clear any previous tracers.
 //
+// OrganismFinder_select() returns the matching organisms instead of marking them.
+//
+// OrganismFinder_test() evaluates the expression once for the whole universe,
+// for conditions like "NUM-STRAINS 1 =". The universe words (STEP, NUM-ORGANISMS,
+// STRAIN-POP, ...) and the MIN/MAX/AVG words are meaningful there, the
+// organism words (ENERGY, AGE, ...) all give 0.
+//
 // evaluates a find_expression for all organisms
 // and sets their raddioactive tracer when the expression evaluates to true.
 //
+// Large populations are split into bands of organisms, each band evaluated
+// on its own thread with its own KFORTH_MACHINE and its own copy of the
+// finder. Matches are recorded per organism and the tracers are applied
+// afterwards in list order, so the result never depends on thread timing.
+//
 #include "evolve_simulator.h"
 #include "evolve_simulator_private.h"
 
+#include <thread>
+
 /*
  * when a value to be returned back to the KFORTH_MACHINE is too big, it
  * exceeds this value. This is max_int.
  */
 #define TOO_BIG		32767
 
+#define FINDER_MAX_THREADS		64
+
+/*
+ * Populations smaller than this are evaluated on the calling thread,
+ * starting threads would cost more than it saves.
+ */
+#define FINDER_MIN_PER_THREAD	2000
+
 static KFORTH_OPERATIONS *FindOperations(void);
+static void FindOpcode_NCHILDREN(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data);
 
 void OrganismFinder_init(ORGANISM_FINDER *of, const char *find_expr, int reset_tracers)
 {
@@ -89,10 +112,9 @@ const char *OrganismFinder_get_error(ORGANISM_FINDER *of)
 // execute KFORTH program. If top of stack is non-zero then
 // return true, else return false.
 //
-static int evalute(ORGANISM_FINDER *of, KFORTH_MACHINE *kfm, ORGANISM *o)
+static int evalute(KFORTH_OPERATIONS *kfops, ORGANISM_FINDER *of, KFORTH_MACHINE *kfm, ORGANISM *o)
 {
 	KFORTH_INTEGER val;
-	int n;
 
 	ASSERT( kfm != NULL );
 	ASSERT( o != NULL );
@@ -104,12 +126,7 @@ static int evalute(ORGANISM_FINDER *of, KFORTH_MACHINE *kfm, ORGANISM *o)
 	// Run machine until terminated, or number of
 	// steps exceeds 1,000.
 	//
-	for(n=0; n < 1000; n++) {
-		kforth_machine_execute(FindOperations(), of->kfp, kfm, of);
-		if( kforth_machine_terminated(kfm) ) {
-			break;
-		}
-	}
+	kforth_machine_run(kfops, of->kfp, kfm, of, 1000);
 
 	if( kforth_machine_terminated(kfm) ) {
 		if( kfm->dsp == 1 ) {
@@ -141,79 +158,287 @@ static int evalute(ORGANISM_FINDER *of, KFORTH_MACHINE *kfm, ORGANISM *o)
 	}
 }
 
-void OrganismFinder_execute(ORGANISM_FINDER *of, UNIVERSE *u)
+//
+// Does the find expression use the instruction 'func'?
+//
+static int uses_instruction(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_FUNCTION func)
+{
+	int cb, pc, len;
+	KFORTH_INTEGER opcode;
+
+	for(cb=0; cb < kfp->nblocks; cb++) {
+		len = kfp->block[cb][-1];
+		for(pc=0; pc < len; pc++) {
+			opcode = kfp->block[cb][pc];
+			if( (opcode & 0x8000) == 0 && kfops->table[opcode].func == func ) {
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+//
+// Evaluate organisms [first, last) of 'list' and record the outcome in 'match'.
+// 'of' is private to the caller, its 'organism' field is changed.
+//
+static void evaluate_band(KFORTH_OPERATIONS *kfops, ORGANISM_FINDER *of,
+				ORGANISM **list, char *match, int first, int last)
 {
-	ORGANISM *o;
 	KFORTH_MACHINE *kfm;
-	KFORTH_INTEGER sum_energy, sum_age;
+	int i;
 
-	ASSERT( of != NULL );
-	ASSERT( u != NULL );
-	ASSERT( ! of->error );
+	kfm = kforth_machine_make();
+	ASSERT( kfm != NULL );
+
+	for(i=first; i < last; i++) {
+		match[i] = evalute(kfops, of, kfm, list[i]);
+	}
+
+	kforth_machine_delete(kfm);
+}
+
+static int finder_nthreads(int norganism)
+{
+	int n;
+
+	n = (int) std::thread::hardware_concurrency();
+	if( n < 1 )
+		n = 1;
+
+	if( n > norganism / FINDER_MIN_PER_THREAD )
+		n = norganism / FINDER_MIN_PER_THREAD;
+
+	if( n > FINDER_MAX_THREADS )
+		n = FINDER_MAX_THREADS;
+
+	if( n < 1 )
+		n = 1;
+
+	return n;
+}
+
+//
+// Gather the organisms of 'u' into an array (the caller frees it) and compute
+// the min/max/avg/total values. Kept in locals and written without
+// branches so the compiler can vectorize the loop.
+//
+static ORGANISM **finder_prepare(ORGANISM_FINDER *of, UNIVERSE *u, int *np)
+{
+	ORGANISM *o;
+	ORGANISM **list;
+	LONG_LONG sum_energy, sum_age;
+	int min_energy, max_energy, min_age, max_age, max_num_cells;
+	int n, i;
 
 	of->u = u;
+	of->lineage = NULL;
 
-	if( of->reset_tracers ) {
-		Universe_ClearTracers(u);
+	list = (ORGANISM **) MALLOC( (u->norganism + 1) * sizeof(ORGANISM*) );
+	ASSERT( list != NULL );
+
+	n = 0;
+	for(o=u->organisms; o != NULL; o=o->next) {
+		list[n++] = o;
 	}
+	ASSERT( n == u->norganism );
 
-	//
-	// Examine all organisms and compute
-	// the min/max/avg values
-	//
 	sum_energy			= 0;
 	sum_age				= 0;
 
-	of->min_energy		= 999999;
-	of->max_energy		= -1;
+	min_energy			= 999999;
+	max_energy			= -1;
 
-	of->min_age			= 999999;
-	of->max_age			= -1;
+	min_age				= 999999;
+	max_age				= -1;
 
-	of->max_num_cells	= -1;
+	max_num_cells		= -1;
+
+	for(i=0; i < n; i++) {
+		o = list[i];
 
-	for(o=u->organisms; o != NULL; o=o->next) {
-		//
-		// Find min/max/avg constants
-		//
 		sum_energy += o->energy;
 		sum_age += o->age;
 
-		if( o->energy < of->min_energy )
-			of->min_energy = o->energy;
+		min_energy		= (o->energy < min_energy) ? o->energy : min_energy;
+		max_energy		= (o->energy > max_energy) ? o->energy : max_energy;
+		min_age			= (o->age < min_age) ? o->age : min_age;
+		max_age			= (o->age > max_age) ? o->age : max_age;
+		max_num_cells	= (o->ncells > max_num_cells) ? o->ncells : max_num_cells;
+	}
+
+	of->min_energy		= min_energy;
+	of->max_energy		= max_energy;
+	of->min_age			= min_age;
+	of->max_age			= max_age;
+	of->max_num_cells	= max_num_cells;
+	of->total_energy	= sum_energy;
+
+	if( n > 0 ) {
+		of->avg_energy	= (int)(sum_energy / n);
+		of->avg_age		= (int)(sum_age / n);
+	} else {
+		of->avg_energy	= 0;
+		of->avg_age		= 0;
+	}
+
+	*np = n;
+	return list;
+}
 
-		if( o->energy > of->max_energy )
-			of->max_energy = o->energy;
+//
+// Return an array of the organisms that match (the caller frees it),
+// in list order. The number of matches is returned in 'nmatch'.
+//
+ORGANISM **OrganismFinder_select(ORGANISM_FINDER *of, UNIVERSE *u, int *nmatch)
+{
+	KFORTH_OPERATIONS *kfops;
+	ORGANISM **list;
+	char *match;
+	ORGANISM_FINDER *wof;
+	std::thread workers[ FINDER_MAX_THREADS ];
+	int n, i, j, nthreads, first, last;
 
-		if( o->age < of->min_age )
-			of->min_age = o->age;
+	ASSERT( of != NULL );
+	ASSERT( u != NULL );
+	ASSERT( nmatch != NULL );
+	ASSERT( ! of->error );
 
-		if( o->age > of->max_age )
-			of->max_age = o->age;
+	kfops = FindOperations();
 
-		if( o->ncells > of->max_num_cells )
-			of->max_num_cells = o->ncells;
+	list = finder_prepare(of, u, &n);
 
+	//
+	// The lineage index is shared by all threads, so it
+	// must be made before they start.
+	//
+	if( n > 0 && uses_instruction(kfops, of->kfp, FindOpcode_NCHILDREN) ) {
+		of->lineage = Lineage_Index_Make(u);
 	}
 
-	if( u->norganism > 0 ) {
-		of->avg_energy	= (int)(sum_energy / u->norganism);
-		of->avg_age		= (int)(sum_age / u->norganism);
+	match = (char *) CALLOC(n + 1, sizeof(char));
+	ASSERT( match != NULL );
+
+	nthreads = finder_nthreads(n);
+
+	if( nthreads == 1 ) {
+		evaluate_band(kfops, of, list, match, 0, n);
 	} else {
-		of->avg_energy	= 0;
-		of->avg_age		= 0;
+		wof = (ORGANISM_FINDER *) MALLOC(nthreads * sizeof(ORGANISM_FINDER));
+		ASSERT( wof != NULL );
+
+		/*
+		 * The last band runs on this thread. Each band gets its own
+		 * copy of the program, as kforth_machine_run() translates
+		 * the code blocks it runs (see kforth_translate.cpp).
+		 */
+		for(i=0; i < nthreads; i++) {
+			first = (int) ((LONG_LONG) n * i / nthreads);
+			last = (int) ((LONG_LONG) n * (i+1) / nthreads);
+			wof[i] = *of;
+			wof[i].kfp = kforth_copy(of->kfp);
+
+			if( i < nthreads-1 ) {
+				workers[i] = std::thread(evaluate_band, kfops, &wof[i], list, match, first, last);
+			} else {
+				evaluate_band(kfops, &wof[i], list, match, first, last);
+			}
+		}
+
+		for(i=0; i < nthreads-1; i++) {
+			workers[i].join();
+		}
+
+		for(i=0; i < nthreads; i++) {
+			kforth_delete(wof[i].kfp);
+		}
+
+		FREE(wof);
+	}
+
+	//
+	// Keep the matches, in list order
+	//
+	j = 0;
+	for(i=0; i < n; i++) {
+		if( match[i] ) {
+			list[j++] = list[i];
+		}
 	}
 
+	FREE(match);
+
+	if( of->lineage != NULL ) {
+		Lineage_Index_Delete(of->lineage);
+		of->lineage = NULL;
+	}
+
+	*nmatch = j;
+	return list;
+}
+
+void OrganismFinder_execute(ORGANISM_FINDER *of, UNIVERSE *u)
+{
+	ORGANISM **list;
+	int n, i;
+
+	ASSERT( of != NULL );
+	ASSERT( u != NULL );
+	ASSERT( ! of->error );
+
+	if( of->reset_tracers ) {
+		Universe_ClearTracers(u);
+	}
+
+	list = OrganismFinder_select(of, u, &n);
+
+	for(i=0; i < n; i++) {
+		list[i]->oflags |= ORGANISM_FLAG_RADIOACTIVE;
+	}
+
+	FREE(list);
+}
+
+//
+// Evaluate the expression once for the whole universe. Returns true
+// if it left a single non-zero value on the stack.
+//
+int OrganismFinder_test(ORGANISM_FINDER *of, UNIVERSE *u)
+{
+	static ORGANISM no_organism;
+	ORGANISM **list;
+	KFORTH_MACHINE *kfm;
+	int n, result;
+
+	ASSERT( of != NULL );
+	ASSERT( u != NULL );
+	ASSERT( ! of->error );
+
+	list = finder_prepare(of, u, &n);
+	FREE(list);
+
 	kfm = kforth_machine_make();
 	ASSERT( kfm != NULL );
 
-	for(o=u->organisms; o != NULL; o=o->next) {
-		if( evalute(of, kfm, o) ) {
-			o->oflags |= ORGANISM_FLAG_RADIOACTIVE;
-		}
-	}
+	result = evalute(FindOperations(), of, kfm, &no_organism);
 
 	kforth_machine_delete(kfm);
+
+	return result;
+}
+
+//
+// Return the last 4 digits of 'id' (all of it, when it is shorter)
+//
+static KFORTH_INTEGER last_4_digits(LONG_LONG id)
+{
+	char buf[50];
+	int len;
+
+	snprintf(buf, sizeof(buf), "%lld", (long long) id);
+	len = (int) strlen(buf);
+
+	return atoi( (len > 4) ? buf + len-4 : buf );
 }
 
 // last 4 digits of the id...
@@ -224,14 +449,12 @@ static void FindOpcode_ID(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_
 {
 	ORGANISM_FINDER *ofc;
 	ORGANISM *o;
-	char buf[50];
 	KFORTH_INTEGER val;
 
 	ofc = (ORGANISM_FINDER*) client_data;
 	o = ofc->organism;
 
-	snprintf(buf, sizeof(buf), "%lld", o->id);
-	val = atoi(buf + strlen(buf)-4 );
+	val = last_4_digits(o->id);
 
 	kforth_data_stack_push(kfm, val);
 }
@@ -241,14 +464,12 @@ static void FindOpcode_PARENT1(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KF
 {
 	ORGANISM_FINDER *ofc;
 	ORGANISM *o;
-	char buf[50];
 	KFORTH_INTEGER val;
 
 	ofc = (ORGANISM_FINDER*) client_data;
 	o = ofc->organism;
 
-	snprintf(buf, sizeof(buf), "%lld", o->parent1);
-	val = atoi(buf + strlen(buf)-4 );
+	val = last_4_digits(o->parent1);
 
 	kforth_data_stack_push(kfm, val);
 }
@@ -258,14 +479,12 @@ static void FindOpcode_PARENT2(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KF
 {
 	ORGANISM_FINDER *ofc;
 	ORGANISM *o;
-	char buf[50];
 	KFORTH_INTEGER val;
 
 	ofc = (ORGANISM_FINDER*) client_data;
 	o = ofc->organism;
 
-	snprintf(buf, sizeof(buf), "%lld", o->parent2);
-	val = atoi(buf + strlen(buf)-4 );
+	val = last_4_digits(o->parent2);
 
 	kforth_data_stack_push(kfm, val);
 }
@@ -333,28 +552,30 @@ static void FindOpcode_AGE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH
 	kforth_data_stack_push(kfm, val);
 }
 
+//
+// The children are counted with a lineage index, made by select()
+// when the expression uses NCHILDREN, so that a find is not O(N^2).
+// There is no index (and no organism) for OrganismFinder_test().
+//
 static void FindOpcode_NCHILDREN(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
 {
 	ORGANISM_FINDER *ofc;
-	ORGANISM *organism, *o;
-	UNIVERSE *u;
+	ORGANISM *organism;
 	KFORTH_INTEGER val;
 	int num_living_children;
 
 	ofc = (ORGANISM_FINDER*) client_data;
 	organism = ofc->organism;
-	u = ofc->u;
 
-	num_living_children = 0;
-	for(o = u->organisms; o; o=o->next) {
-		if( o->parent1 == organism->id || o->parent2 == organism->id ) {
-			num_living_children += 1;
-		}
+	if( ofc->lineage != NULL ) {
+		num_living_children = Lineage_Index_NChildren(ofc->lineage, organism->id);
+	} else {
+		num_living_children = 0;
 	}
 
 	val = (num_living_children < TOO_BIG) ? num_living_children : TOO_BIG;
 
-	kforth_data_stack_push(kfm, num_living_children);
+	kforth_data_stack_push(kfm, val);
 }
 
 static void FindOpcode_EXECUTING(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
@@ -503,6 +724,102 @@ static void FindOpcode_MAX_NUM_CELLS(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *k
 	kforth_data_stack_push(kfm, val);
 }
 
+// scaled 1 : 1000 steps
+static void FindOpcode_STEP(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
+{
+	ORGANISM_FINDER *ofc;
+	LONG_LONG scaled_step;
+	KFORTH_INTEGER val;
+
+	ofc = (ORGANISM_FINDER*) client_data;
+	scaled_step = ofc->u->step / 1000;
+	val = (scaled_step < TOO_BIG) ? scaled_step : TOO_BIG;
+	kforth_data_stack_push(kfm, val);
+}
+
+// scaled 1 : 1000000 steps, for long runs
+static void FindOpcode_MEGA_STEP(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
+{
+	ORGANISM_FINDER *ofc;
+	LONG_LONG scaled_step;
+	KFORTH_INTEGER val;
+
+	ofc = (ORGANISM_FINDER*) client_data;
+	scaled_step = ofc->u->step / 1000000;
+	val = (scaled_step < TOO_BIG) ? scaled_step : TOO_BIG;
+	kforth_data_stack_push(kfm, val);
+}
+
+// scaled 1 : 1000 age
+static void FindOpcode_UNIVERSE_AGE(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
+{
+	ORGANISM_FINDER *ofc;
+	LONG_LONG scaled_age;
+	KFORTH_INTEGER val;
+
+	ofc = (ORGANISM_FINDER*) client_data;
+	scaled_age = ofc->u->age / 1000;
+	val = (scaled_age < TOO_BIG) ? scaled_age : TOO_BIG;
+	kforth_data_stack_push(kfm, val);
+}
+
+static void FindOpcode_NUM_ORGANISMS(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
+{
+	ORGANISM_FINDER *ofc;
+	KFORTH_INTEGER val;
+
+	ofc = (ORGANISM_FINDER*) client_data;
+	val = (ofc->u->norganism < TOO_BIG) ? ofc->u->norganism : TOO_BIG;
+	kforth_data_stack_push(kfm, val);
+}
+
+// ( s -- n ) population of strain 's', 0 for a bad strain
+static void FindOpcode_STRAIN_POP(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
+{
+	ORGANISM_FINDER *ofc;
+	KFORTH_INTEGER strain, val;
+
+	ofc = (ORGANISM_FINDER*) client_data;
+	strain = kforth_data_stack_pop(kfm);
+
+	if( strain >= 0 && strain < EVOLVE_MAX_STRAINS ) {
+		val = (ofc->u->strpop[strain] < TOO_BIG) ? ofc->u->strpop[strain] : TOO_BIG;
+	} else {
+		val = 0;
+	}
+	kforth_data_stack_push(kfm, val);
+}
+
+// number of strains that have living organisms
+static void FindOpcode_NUM_STRAINS(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
+{
+	ORGANISM_FINDER *ofc;
+	KFORTH_INTEGER val;
+	int strain;
+
+	ofc = (ORGANISM_FINDER*) client_data;
+
+	val = 0;
+	for(strain=0; strain < EVOLVE_MAX_STRAINS; strain++) {
+		if( ofc->u->strpop[strain] > 0 )
+			val++;
+	}
+	kforth_data_stack_push(kfm, val);
+}
+
+// scaled 1 : 1000 energy, the energy of all organisms
+static void FindOpcode_TOTAL_ENERGY(KFORTH_OPERATIONS *kfops, KFORTH_PROGRAM *kfp, KFORTH_MACHINE *kfm, void *client_data)
+{
+	ORGANISM_FINDER *ofc;
+	LONG_LONG scaled_energy;
+	KFORTH_INTEGER val;
+
+	ofc = (ORGANISM_FINDER*) client_data;
+	scaled_energy = ofc->total_energy / 1000;
+	val = (scaled_energy < TOO_BIG) ? scaled_energy : TOO_BIG;
+	kforth_data_stack_push(kfm, val);
+}
+
 //
 // A "once" function, always returns pointer to same static table
 // for all instances and all callers.
@@ -537,6 +854,13 @@ static KFORTH_OPERATIONS *FindOperations(void)
 		kforth_ops_add(&kfops,	"MIN-AGE",			0, 1, FindOpcode_MIN_AGE);
 		kforth_ops_add(&kfops,	"AVG-AGE",			0, 1, FindOpcode_AVG_AGE);
 		kforth_ops_add(&kfops,	"MAX-NUM-CELLS",	0, 1, FindOpcode_MAX_NUM_CELLS);
+		kforth_ops_add(&kfops,	"STEP",				0, 1, FindOpcode_STEP);
+		kforth_ops_add(&kfops,	"MEGA-STEP",		0, 1, FindOpcode_MEGA_STEP);
+		kforth_ops_add(&kfops,	"UNIVERSE-AGE",		0, 1, FindOpcode_UNIVERSE_AGE);
+		kforth_ops_add(&kfops,	"NUM-ORGANISMS",	0, 1, FindOpcode_NUM_ORGANISMS);
+		kforth_ops_add(&kfops,	"STRAIN-POP",		1, 1, FindOpcode_STRAIN_POP);
+		kforth_ops_add(&kfops,	"NUM-STRAINS",		0, 1, FindOpcode_NUM_STRAINS);
+		kforth_ops_add(&kfops,	"TOTAL-ENERGY",		0, 1, FindOpcode_TOTAL_ENERGY);
 	}
 
 	return &kfops;
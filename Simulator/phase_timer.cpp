@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2022 Ken Stauffer
+ */
+
+/***********************************************************************
+ * PHASE TIMER
+ *
+ * Attribute the time spent simulating to a few coarse phases
+ * (see PHASE_EXECUTE, etc... in evolve_simulator.h).
+ *
+ * A client makes a PHASE_TIMER, stores it in u->phase_timer, and
+ * brackets the code it wants measured with Phase_Timer_Begin() and
+ * Phase_Timer_End(). The simulator marks its own phases with the
+ * PHASE_BEGIN()/PHASE_END() macros, which do nothing when
+ * u->phase_timer is NULL.
+ *
+ * Phases form a stack. Whenever a phase begins or ends, the time since
+ * the last sample is charged to the phase on top of the stack, so each
+ * phase only gets its own (exclusive) time. For example evolve_batch
+ * wraps its simulate loop in PHASE_EXECUTE, and the time that remains
+ * after Kill_Dead_Cells(), Kill_Organism(), etc... have taken their share
+ * is the time spent executing instructions.
+ *
+ * On Linux, the timer also samples cpu cycles, last level cache misses
+ * and branch misses with perf_event_open(). If the kernel will not
+ * give us the counters (no PMU, or perf_event_paranoid is too strict)
+ * 'have_counters' is 0 and only wall time is recorded.
+ *
+ * Phases are only marked around infrequent work (never per instruction)
+ * because each sample costs a clock read, and a read() system call when
+ * counters are on.
+ *
+ */
+#include "evolve_simulator.h"
+#include "evolve_simulator_private.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+static const char *phase_names[PHASE_COUNT] = {
+	"execute",
+	"kill_dead_cells",
+	"kill_organism",
+	"mutate",
+	"checkpoint",
+};
+
+static const char *counter_names[PHASE_NCOUNTERS] = {
+	"cycles",
+	"llc_misses",
+	"branch_misses",
+};
+
+#ifdef __linux__
+
+static int perf_event_open(struct perf_event_attr *pe, int group_fd)
+{
+	return (int) syscall(__NR_perf_event_open, pe, 0, -1, group_fd, 0);
+}
+
+/*
+ * Open one group of counters for this thread: cycles (the group leader),
+ * cache misses and branch misses. User space only, so this works with
+ * the default perf_event_paranoid setting.
+ */
+static int open_counters(PHASE_TIMER *pt)
+{
+	static const LONG_LONG config[PHASE_NCOUNTERS] = {
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_CACHE_MISSES,
+		PERF_COUNT_HW_BRANCH_MISSES,
+	};
+	struct perf_event_attr pe;
+	int i, j;
+
+	for(i=0; i < PHASE_NCOUNTERS; i++) {
+		memset(&pe, 0, sizeof(pe));
+		pe.type				= PERF_TYPE_HARDWARE;
+		pe.size				= sizeof(pe);
+		pe.config			= config[i];
+		pe.disabled			= (i == 0);
+		pe.exclude_kernel	= 1;
+		pe.exclude_hv		= 1;
+		pe.read_format		= PERF_FORMAT_GROUP;
+
+		pt->fd[i] = perf_event_open(&pe, (i == 0) ? -1 : pt->fd[0]);
+		if( pt->fd[i] < 0 ) {
+			for(j=0; j < i; j++) {
+				close(pt->fd[j]);
+				pt->fd[j] = -1;
+			}
+			return 0;
+		}
+	}
+
+	ioctl(pt->fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(pt->fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+	return 1;
+}
+
+static void close_counters(PHASE_TIMER *pt)
+{
+	int i;
+
+	for(i=PHASE_NCOUNTERS-1; i >= 0; i--) {
+		if( pt->fd[i] >= 0 )
+			close(pt->fd[i]);
+		pt->fd[i] = -1;
+	}
+}
+
+static void read_counters(PHASE_TIMER *pt, LONG_LONG *values)
+{
+	struct {
+		uint64_t	nr;
+		uint64_t	value[PHASE_NCOUNTERS];
+	} group;
+	int i;
+
+	if( read(pt->fd[0], &group, sizeof(group)) != sizeof(group) ) {
+		memcpy(values, pt->last_counter, sizeof(pt->last_counter));
+		return;
+	}
+
+	for(i=0; i < PHASE_NCOUNTERS; i++)
+		values[i] = (LONG_LONG) group.value[i];
+}
+
+#else
+
+static int open_counters(PHASE_TIMER *pt)
+{
+	return 0;
+}
+
+static void close_counters(PHASE_TIMER *pt)
+{
+}
+
+static void read_counters(PHASE_TIMER *pt, LONG_LONG *values)
+{
+}
+
+#endif
+
+/*
+ * Charge everything since the last sample to the phase on top of the stack.
+ */
+static void phase_sample(PHASE_TIMER *pt)
+{
+	LONG_LONG now, values[PHASE_NCOUNTERS];
+	int i, phase;
+
+	now = kforth_profile_ticks();
+
+	if( pt->have_counters )
+		read_counters(pt, values);
+
+	if( pt->depth > 0 ) {
+		phase = pt->stack[pt->depth-1];
+		pt->nsec[phase] += now - pt->last_nsec;
+
+		if( pt->have_counters ) {
+			for(i=0; i < PHASE_NCOUNTERS; i++)
+				pt->counter[phase][i] += values[i] - pt->last_counter[i];
+		}
+	}
+
+	pt->last_nsec = now;
+	if( pt->have_counters )
+		memcpy(pt->last_counter, values, sizeof(pt->last_counter));
+}
+
+/***********************************************************************
+ * Make a phase timer. If 'want_counters' is true, try to sample
+ * hardware counters as well (check 'have_counters' to see if it worked).
+ *
+ * Counters are opened for the calling thread.
+ *
+ */
+PHASE_TIMER *Phase_Timer_Make(int want_counters)
+{
+	PHASE_TIMER *pt;
+	int i;
+
+	pt = (PHASE_TIMER *) CALLOC(1, sizeof(PHASE_TIMER));
+	ASSERT( pt != NULL );
+
+	for(i=0; i < PHASE_NCOUNTERS; i++)
+		pt->fd[i] = -1;
+
+	if( want_counters )
+		pt->have_counters = open_counters(pt);
+
+	return pt;
+}
+
+void Phase_Timer_Delete(PHASE_TIMER *pt)
+{
+	ASSERT( pt != NULL );
+
+	close_counters(pt);
+	FREE(pt);
+}
+
+void Phase_Timer_Begin(PHASE_TIMER *pt, int phase)
+{
+	ASSERT( pt != NULL );
+	ASSERT( phase >= 0 && phase < PHASE_COUNT );
+	ASSERT( pt->depth < PHASE_MAX_DEPTH );
+
+	phase_sample(pt);
+
+	pt->stack[ pt->depth++ ] = phase;
+}
+
+void Phase_Timer_End(PHASE_TIMER *pt)
+{
+	ASSERT( pt != NULL );
+	ASSERT( pt->depth > 0 );
+
+	phase_sample(pt);
+
+	pt->depth -= 1;
+	pt->calls[ pt->stack[pt->depth] ] += 1;
+}
+
+const char *Phase_Timer_Name(int phase)
+{
+	ASSERT( phase >= 0 && phase < PHASE_COUNT );
+
+	return phase_names[phase];
+}
+
+const char *Phase_Timer_Counter_Name(int counter)
+{
+	ASSERT( counter >= 0 && counter < PHASE_NCOUNTERS );
+
+	return counter_names[counter];
+}
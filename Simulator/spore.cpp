@@ -58,8 +58,9 @@ void Spore_fertilize(UNIVERSE *u, ORGANISM *o, SPORE *spore,
 	kforth_program_init(&np);
 	kfops = &u->kfops[o->strain];
 	kfmo = &u->kfmo[o->strain];
-	kforth_merge2(&u->er, kfmo, &o->program, &spore->program, &np);
-	kforth_mutate(kfops, kfmo, &u->er, &np);
+	PHASE_BEGIN(u, PHASE_MUTATE);
+	kforth_merge_mutate(kfops, kfmo, &u->er, &u->kfms, &o->program, &spore->program, &np);
+	PHASE_END(u);
 
 	no = (ORGANISM *) CALLOC(1, sizeof(ORGANISM));
 	ASSERT( no != NULL );
@@ -73,12 +74,7 @@ void Spore_fertilize(UNIVERSE *u, ORGANISM *o, SPORE *spore,
 	nc->organism	= no;
 	nc->next	= NULL;
 
-	nc->u_next = u->cells;
-	nc->u_prev = NULL;
-	if( u->cells ) {
-		u->cells->u_prev = nc;
-	}
-	u->cells = nc;
+	Schedule_Insert(u, nc);
 
 	no->strain	= spore->strain;
 	no->id		= u->next_id++;
@@ -113,6 +113,7 @@ void Universe_set_ith_kfops(UNIVERSE *u, int i, KFORTH_OPERATIONS* kfops)
 	ASSERT( kfops != NULL );
 
 	u->kfops[i] = *kfops;
+	EvolveOperations_Specialize(&u->kfops[i], &u->strop[i]);
 }
 
 void Universe_set_ith_strop(UNIVERSE *u, int i, STRAIN_OPTIONS* strop)
@@ -122,6 +123,7 @@ void Universe_set_ith_strop(UNIVERSE *u, int i, STRAIN_OPTIONS* strop)
 	ASSERT( strop != NULL );
 
 	u->strop[i] = *strop;
+	EvolveOperations_Specialize(&u->kfops[i], &u->strop[i]);
 }
 
 void StrainOptions_Set_Name(STRAIN_OPTIONS *so, const char *name)
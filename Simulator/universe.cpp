@@ -87,6 +87,44 @@ GRID_TYPE Grid_Get(UNIVERSE *u, int x, int y, UNIVERSE_GRID *ugrid)
 	return (GRID_TYPE) grid->type;
 }
 
+/*
+ * Add (sign=1) or remove (sign=-1) the contents of 'grid' from the
+ * running totals in u->totals.
+ */
+static void grid_count(UNIVERSE *u, UNIVERSE_GRID *grid, int sign)
+{
+	GRID_TOTALS *t;
+	CELL *cell;
+	SPORE *spore;
+
+	t = &u->totals;
+
+	switch( grid->type ) {
+	case GT_CELL:
+		cell = grid->u.cell;
+		t->num_cells			+= sign;
+		t->call_stack_nodes		+= sign * cell->kfm.csp;
+		t->data_stack_nodes		+= sign * cell->kfm.dsp;
+		break;
+
+	case GT_ORGANIC:
+		t->num_organic			+= sign;
+		t->organic_energy		+= sign * grid->u.energy;
+		break;
+
+	case GT_SPORE:
+		spore = grid->u.spore;
+		t->num_spores			+= sign;
+		t->spore_energy			+= sign * spore->energy;
+		t->spore_instructions	+= sign * kforth_program_length(&spore->program);
+		t->spore_program_memory	+= sign * kforth_program_size(&spore->program);
+		break;
+
+	default:
+		break;
+	}
+}
+
 void Grid_Clear(UNIVERSE *u, int x, int y)
 {
 	UNIVERSE_GRID *grid;
@@ -96,6 +134,9 @@ void Grid_Clear(UNIVERSE *u, int x, int y)
 	ASSERT( y >= 0 && y < u->height );
 
 	grid		= GET_GRID(u, x, y);
+	if( GRID_STATIC(grid->type) )
+		GRID_DIRTY(u, x, y);
+	grid_count(u, grid, -1);
 	grid->type	= GT_BLANK;
 	grid->u.energy	= 0;
 }
@@ -109,6 +150,8 @@ void Grid_SetBarrier(UNIVERSE *u, int x, int y)
 	ASSERT( y >= 0 && y < u->height );
 
 	grid		= GET_GRID(u, x, y);
+	GRID_DIRTY(u, x, y);
+	grid_count(u, grid, -1);
 	grid->type	= GT_BARRIER;
 	grid->u.energy	= 0;
 }
@@ -122,6 +165,8 @@ void Grid_SetOdor(UNIVERSE *u, int x, int y, KFORTH_INTEGER odor)
 	ASSERT( y >= 0 && y < u->height );
 
 	grid		= GET_GRID(u, x, y);
+	if( grid->odor != odor )
+		GRID_DIRTY(u, x, y);
 	grid->odor	= odor;
 }
 
@@ -139,8 +184,12 @@ void Grid_SetCell(UNIVERSE *u, CELL *cell)
 	y = cell->y;
 
 	grid		= GET_GRID(u, x, y);
+	if( GRID_STATIC(grid->type) )
+		GRID_DIRTY(u, x, y);
+	grid_count(u, grid, -1);
 	grid->type	= GT_CELL;
 	grid->u.cell	= cell;
+	grid_count(u, grid, 1);
 }
 
 void Grid_SetOrganic(UNIVERSE *u, int x, int y, int energy)
@@ -153,8 +202,11 @@ void Grid_SetOrganic(UNIVERSE *u, int x, int y, int energy)
 	ASSERT( energy >= 0 );
 
 	grid		= GET_GRID(u, x, y);
+	GRID_DIRTY(u, x, y);
+	grid_count(u, grid, -1);
 	grid->type	= GT_ORGANIC;
 	grid->u.energy	= energy;
+	grid_count(u, grid, 1);
 }
 
 void Grid_SetSpore(UNIVERSE *u, int x, int y, SPORE *spore)
@@ -167,8 +219,12 @@ void Grid_SetSpore(UNIVERSE *u, int x, int y, SPORE *spore)
 	ASSERT( spore != NULL );
 
 	grid		= GET_GRID(u, x, y);
+	if( GRID_STATIC(grid->type) )
+		GRID_DIRTY(u, x, y);
+	grid_count(u, grid, -1);
 	grid->type	= GT_SPORE;
 	grid->u.spore	= spore;
+	grid_count(u, grid, 1);
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -226,13 +282,13 @@ UNIVERSE *Universe_Make(uint32_t seed, int width, int height)
 	{
 		StrainOptions_Init(&u->strop[i]);
 		u->kfops[i] = *EvolveOperations();
+		EvolveOperations_Specialize(&u->kfops[i], &u->strop[i]);
 		kforth_mutate_options_copy2(&kfmo, &u->kfmo[i]);
 	}
 
 	u->step = 0;
 	u->age = 0;
 	u->current_cell = NULL;
-	u->cells = NULL;
 	u->G0 = 0;
 	u->key = 0;
 	u->mouse_x = -1;
@@ -260,6 +316,21 @@ static void complete_organism_free(ORGANISM *o)
 	Organism_delete(o);
 }
 
+static void delete_spore_rows(UNIVERSE *u, int y1, int y2, void *acc, void *arg)
+{
+	UNIVERSE_GRID *ugp;
+	int x, y;
+
+	for(y=y1; y < y2; y++) {
+		for(x=0; x < u->width; x++) {
+			ugp = GET_GRID(u, x, y);
+			if( ugp->type == GT_SPORE ) {
+				Spore_delete(ugp->u.spore);
+			}
+		}
+	}
+}
+
 /***********************************************************************
  * Free all memory associated with a universe 'u' object.
  *
@@ -267,8 +338,6 @@ static void complete_organism_free(ORGANISM *o)
 void Universe_Delete(UNIVERSE *u)
 {
 	ORGANISM *curr, *nxt;
-	UNIVERSE_GRID *ugp;
-	int x, y;
 
 	ASSERT( u != NULL );
 
@@ -277,19 +346,65 @@ void Universe_Delete(UNIVERSE *u)
 		complete_organism_free(curr);
 	}
 
-	for(x=0; x < u->width; x++) {
-		for(y=0; y < u->height; y++) {
-			ugp = GET_GRID(u, x, y);
-			if( ugp->type == GT_SPORE ) {
-				Spore_delete(ugp->u.spore);
-			}
-		}
-	}
+	Grid_Reduce(u, delete_spore_rows, NULL, NULL, 0, NULL);
+
+	Schedule_Deinit(u);
+
+	kforth_mutate_scratch_deinit(&u->kfms);
+
+	if( u->dirty_tiles != NULL )
+		FREE(u->dirty_tiles);
 
 	FREE(u->grid);
 	FREE(u);
 }
 
+/***********************************************************************
+ * Start (on=1) or stop (on=0) tracking which tiles (see UNIVERSE_TILE_SIZE)
+ * have had their organic, barriers or odor changed. Tracking starts
+ * with every tile marked dirty.
+ *
+ * This is used to write delta checkpoints (Universe_WriteDelta).
+ *
+ */
+void Universe_Track_Dirty_Tiles(UNIVERSE *u, int on)
+{
+	int nty;
+
+	ASSERT( u != NULL );
+
+	if( u->dirty_tiles != NULL ) {
+		FREE(u->dirty_tiles);
+		u->dirty_tiles = NULL;
+		u->dirty_ntx = 0;
+	}
+
+	if( on ) {
+		u->dirty_ntx = (u->width + UNIVERSE_TILE_SIZE - 1) / UNIVERSE_TILE_SIZE;
+		nty = (u->height + UNIVERSE_TILE_SIZE - 1) / UNIVERSE_TILE_SIZE;
+
+		u->dirty_tiles = (unsigned char *) MALLOC(u->dirty_ntx * nty);
+		ASSERT( u->dirty_tiles != NULL );
+
+		memset(u->dirty_tiles, 1, u->dirty_ntx * nty);
+	}
+}
+
+/***********************************************************************
+ * Mark every tile clean, after a checkpoint has been written.
+ *
+ */
+void Universe_Clear_Dirty_Tiles(UNIVERSE *u)
+{
+	int nty;
+
+	ASSERT( u != NULL );
+	ASSERT( u->dirty_tiles != NULL );
+
+	nty = (u->height + UNIVERSE_TILE_SIZE - 1) / UNIVERSE_TILE_SIZE;
+	memset(u->dirty_tiles, 0, u->dirty_ntx * nty);
+}
+
 //
 // Use the coordinates (ex,ey) to place energy, if our organism
 // now has no cells.
@@ -303,6 +418,8 @@ static int Kill_Organism_And_Remove_From_Universe(UNIVERSE *u, ORGANISM *o, int
 	ASSERT( ex >= 0 && ex < u->width );
 	ASSERT( ey >= 0 && ey < u->height );
 
+	PHASE_BEGIN(u, PHASE_KILL_ORGANISM);
+
 	cc = Kill_Organism(u, o, ex, ey);
 
 	if( o->next ) {
@@ -331,13 +448,70 @@ static int Kill_Organism_And_Remove_From_Universe(UNIVERSE *u, ORGANISM *o, int
 
 	Organism_delete(o);
 
+	PHASE_END(u);
+
 	return cc;
 }
 
-void Universe_Simulate(UNIVERSE *u)
+/*
+ * Run one instruction of cell 'c', and keep the grid totals
+ * up to date with its new stack depths.
+ */
+static inline void execute_cell(UNIVERSE *u, CELL *c)
 {
 	CELL_CLIENT_DATA client_data;
 	KFORTH_OPERATIONS *kfops;
+	ORGANISM *o;
+	int csp, dsp;
+
+	o = c->organism;
+
+	client_data.universe = u;
+	client_data.cell = c;
+	kfops = &u->kfops[o->strain];
+
+	csp = c->kfm.csp;
+	dsp = c->kfm.dsp;
+
+	kforth_machine_execute(kfops, &o->program, &c->kfm, &client_data);
+	u->ninstructions += 1;
+
+	u->totals.call_stack_nodes += c->kfm.csp - csp;
+	u->totals.data_stack_nodes += c->kfm.dsp - dsp;
+}
+
+/***********************************************************************
+ * Run one instruction of 'cell' and nothing else. None of the organism
+ * or universe processing that Universe_Simulate() does (killing dead
+ * cells, aging, advancing u->current_cell) happens.
+ *
+ * If the instruction terminates the cell, it is counted in the organism's
+ * 'ndead', like Universe_Simulate() does, so the next Kill_Dead_Cells()
+ * removes it.
+ *
+ * For tools that need to time or trace single instructions
+ * against a real universe. 'cell' must not be terminated.
+ *
+ */
+void Universe_Execute_Cell(UNIVERSE *u, CELL *cell)
+{
+	ORGANISM *o;
+
+	ASSERT( u != NULL );
+	ASSERT( cell != NULL );
+	ASSERT( ! Kforth_Machine_Terminated(&cell->kfm) );
+
+	o = cell->organism;
+
+	execute_cell(u, cell);
+
+	if( Kforth_Machine_Terminated(&cell->kfm) ) {
+		o->ndead += 1;
+	}
+}
+
+void Universe_Simulate(UNIVERSE *u)
+{
 	CELL *c;
 	ORGANISM *o;
 	int cc1, cc2;				// flags to indicate the u->current_cell was moved to the next cell because its current reference was removed
@@ -366,11 +540,11 @@ void Universe_Simulate(UNIVERSE *u)
 
 	if( ! Kforth_Machine_Terminated(&c->kfm) )
 	{
-		client_data.universe = u;
-		client_data.cell = c;
-		kfops = &u->kfops[o->strain];
+		execute_cell(u, c);
 
-		kforth_machine_execute(kfops, &o->program, &c->kfm, &client_data);
+		if( Kforth_Machine_Terminated(&c->kfm) ) {
+			o->ndead += 1;
+		}
 	}
 
 	//////////////////////////////////////////////////////////////////////
@@ -401,36 +575,68 @@ void Universe_Simulate(UNIVERSE *u)
 	//	
 
 	if( cc1 == 0 && cc2 == 0 ) {
-		u->current_cell = c->u_next;
+		u->current_cell = Schedule_Next(u, c);
 	}
 
 	if( u->current_cell == NULL ) {
 		u->age += 1;
-		u->current_cell = u->cells;
+		Schedule_Compact(u);
+		u->current_cell = Schedule_First(u);
+	}
+
+	if( u->current_cell != NULL ) {
+		Schedule_Prefetch(u, u->current_cell);
 	}
 }
 
-/***********************************************************************
- * Calculate infomration about the universe
- *
+/*
+ * Add up the information that comes from the organism list. The
+ * strain populations are not counted here, they are in u->strpop[].
  */
-void Universe_Information(UNIVERSE *u, UNIVERSE_INFORMATION *uinfo)
+static void organism_information(UNIVERSE *u, UNIVERSE_INFORMATION *uinfo)
 {
+	ORGANISM *o;
+	KFORTH_PROGRAM *kfp;
+
+	for(o=u->organisms; o; o=o->next) {
+		kfp = &o->program;
+		uinfo->num_instructions += kforth_program_length(kfp);
+
+		uinfo->energy += o->energy;
+
+		uinfo->organism_memory += sizeof(ORGANISM);
+		uinfo->organism_memory += o->ncells * (sizeof(CELL) + sizeof(KFORTH_MACHINE));
+		uinfo->program_memory += kforth_program_size(kfp);
+
+		if( o->parent1 != o->parent2 )
+			uinfo->num_sexual += 1;
+
+		ASSERT( o->strain >= 0 && o->strain < EVOLVE_MAX_STRAINS );
+
+		if( o->oflags & ORGANISM_FLAG_RADIOACTIVE ) {
+			uinfo->radioactive_population[o->strain] += 1;
+		}
+	}
+
+	uinfo->cstack_memory = uinfo->call_stack_nodes * sizeof(KFORTH_LOC);
+	uinfo->dstack_memory = uinfo->data_stack_nodes * sizeof(KFORTH_INTEGER);
+}
+
+#ifdef EVOLVE_DEBUG
+static void information_rows(UNIVERSE *u, int y1, int y2, void *acc, void *arg)
+{
+	UNIVERSE_INFORMATION *uinfo;
 	UNIVERSE_GRID ugrid;
 	GRID_TYPE type;
 	CELL *cell;
-	ORGANISM *o;
 	SPORE *spore;
 	KFORTH_PROGRAM *kfp;
 	int x, y;
 
-	ASSERT( u != NULL );
-	ASSERT( uinfo != NULL );
+	uinfo = (UNIVERSE_INFORMATION *) acc;
 
-	memset(uinfo, 0, sizeof(UNIVERSE_INFORMATION));
-
-	for(x=0; x < u->width; x++) {
-		for(y=0; y < u->height; y++) {
+	for(y=y1; y < y2; y++) {
+		for(x=0; x < u->width; x++) {
 			type = Universe_Query(u, x, y, &ugrid);
 
 			if( type == GT_ORGANIC ) {
@@ -460,31 +666,96 @@ void Universe_Information(UNIVERSE *u, UNIVERSE_INFORMATION *uinfo)
 			uinfo->grid_memory += sizeof(UNIVERSE_GRID);
 		}
 	}
+}
 
-	for(o=u->organisms; o; o=o->next) {
-		kfp = &o->program;
-		uinfo->num_instructions += kforth_program_length(kfp);
+static void information_merge(void *acc, void *part, void *arg)
+{
+	UNIVERSE_INFORMATION *uinfo, *p;
+
+	uinfo = (UNIVERSE_INFORMATION *) acc;
+	p = (UNIVERSE_INFORMATION *) part;
+
+	uinfo->energy			+= p->energy;
+	uinfo->num_instructions	+= p->num_instructions;
+	uinfo->num_organic		+= p->num_organic;
+	uinfo->organic_energy	+= p->organic_energy;
+	uinfo->num_spores		+= p->num_spores;
+	uinfo->spore_energy		+= p->spore_energy;
+	uinfo->spore_memory		+= p->spore_memory;
+	uinfo->program_memory	+= p->program_memory;
+	uinfo->call_stack_nodes	+= p->call_stack_nodes;
+	uinfo->data_stack_nodes	+= p->data_stack_nodes;
+	uinfo->num_cells		+= p->num_cells;
+	uinfo->grid_memory		+= p->grid_memory;
+}
 
-		uinfo->energy += o->energy;
+/*
+ * Compute the information by visiting every grid square. Used
+ * to check the running totals in u->totals and u->strpop[].
+ */
+static void universe_information_scan(UNIVERSE *u, UNIVERSE_INFORMATION *uinfo)
+{
+	ORGANISM *o;
 
-		uinfo->organism_memory += sizeof(ORGANISM);
-		uinfo->organism_memory += o->ncells * (sizeof(CELL) + sizeof(KFORTH_MACHINE));
-		uinfo->program_memory += kforth_program_size(kfp);
+	memset(uinfo, 0, sizeof(UNIVERSE_INFORMATION));
 
-		if( o->parent1 != o->parent2 )
-			uinfo->num_sexual += 1;
+	Grid_Reduce(u, information_rows, information_merge, uinfo, sizeof(UNIVERSE_INFORMATION), NULL);
 
-		ASSERT( o->strain >= 0 && o->strain < EVOLVE_MAX_STRAINS );
+	organism_information(u, uinfo);
 
+	for(o=u->organisms; o; o=o->next) {
 		uinfo->strain_population[o->strain] += 1;
+	}
+}
+#endif
 
-		if( o->oflags & ORGANISM_FLAG_RADIOACTIVE ) {
-			uinfo->radioactive_population[o->strain] += 1;
-		}
+/***********************************************************************
+ * Calculate infomration about the universe
+ *
+ * The grid part comes from the running totals in u->totals, and
+ * the strain populations from u->strpop[]. The organism list is
+ * still walked for the energy, program and memory totals.
+ *
+ */
+void Universe_Information(UNIVERSE *u, UNIVERSE_INFORMATION *uinfo)
+{
+	GRID_TOTALS *t;
+	int i;
+
+	ASSERT( u != NULL );
+	ASSERT( uinfo != NULL );
+
+	memset(uinfo, 0, sizeof(UNIVERSE_INFORMATION));
+
+	t = &u->totals;
+
+	uinfo->energy			= t->organic_energy + t->spore_energy;
+	uinfo->num_cells		= t->num_cells;
+	uinfo->num_instructions	= t->spore_instructions;
+	uinfo->call_stack_nodes	= t->call_stack_nodes;
+	uinfo->data_stack_nodes	= t->data_stack_nodes;
+	uinfo->num_organic		= t->num_organic;
+	uinfo->num_spores		= t->num_spores;
+	uinfo->spore_energy		= t->spore_energy;
+	uinfo->organic_energy	= t->organic_energy;
+	uinfo->grid_memory		= u->width * u->height * sizeof(UNIVERSE_GRID);
+	uinfo->program_memory	= t->spore_program_memory;
+	uinfo->spore_memory		= t->num_spores * sizeof(SPORE);
+
+	for(i=0; i < EVOLVE_MAX_STRAINS; i++) {
+		uinfo->strain_population[i] = u->strpop[i];
 	}
 
-	uinfo->cstack_memory = uinfo->call_stack_nodes * sizeof(KFORTH_LOC);
-	uinfo->dstack_memory = uinfo->data_stack_nodes * sizeof(KFORTH_INTEGER);
+	organism_information(u, uinfo);
+
+#ifdef EVOLVE_DEBUG
+	{
+		UNIVERSE_INFORMATION scan;
+
+		universe_information_scan(u, &scan);
+		ASSERT( memcmp(&scan, uinfo, sizeof(UNIVERSE_INFORMATION)) == 0 );
+	}
+#endif
 }
 
 /***********************************************************************
@@ -502,6 +773,7 @@ void Universe_SetBarrier(UNIVERSE *u, int x, int y)
 	g = GET_GRID(u, x, y);
 
 	if( g->type == GT_BLANK ) {
+		GRID_DIRTY(u, x, y);
 		g->type = GT_BARRIER;
 	}
 }
@@ -521,6 +793,7 @@ void Universe_ClearBarrier(UNIVERSE *u, int x, int y)
 	g = GET_GRID(u, x, y);
 
 	if( g->type == GT_BARRIER ) {
+		GRID_DIRTY(u, x, y);
 		g->type = GT_BLANK;
 	}
 
@@ -668,8 +941,7 @@ ORGANISM *Universe_DuplicateOrganism(ORGANISM *osrc)
 
 		kforth_machine_copy2(&csrc->kfm, &cdst->kfm);
 		cdst->next = NULL;
-		cdst->u_next = NULL;
-		cdst->u_prev = NULL;
+		cdst->sidx = -1;
 		cdst->organism = odst;
 
 		if( cprev == NULL ) {
@@ -711,7 +983,7 @@ ORGANISM *Universe_CopyOrganism(UNIVERSE *u)
 ORGANISM *Universe_CutOrganism(UNIVERSE *u)
 {
 	ORGANISM *o;
-	CELL *cell, *nxt;
+	CELL *cell, *nxt, *snext;
 
 	ASSERT( u != NULL );
 	ASSERT( u->selected_organism != NULL );
@@ -744,29 +1016,19 @@ ORGANISM *Universe_CutOrganism(UNIVERSE *u)
 	 */
 	for(cell=o->cells; cell; cell=nxt) {
 		nxt = cell->next;
+		snext = Schedule_Next(u, cell);
+
+		Schedule_Remove(u, cell);
+
 		if( cell == u->current_cell )
 		{
-			u->current_cell = cell->u_next;
+			u->current_cell = snext;
 			if( u->current_cell == NULL ) {
-				u->current_cell = u->cells;
+				u->current_cell = Schedule_First(u);
 			}
 		}
 
-		if( u->cells == cell ) {
-			u->cells = cell->u_next;
-		}
-
-		if( cell->u_prev != NULL ) {
-			cell->u_prev->u_next = cell->u_next;
-		}
-
-		if( cell->u_next != NULL ) {
-			cell->u_next->u_prev = cell->u_prev;
-		}
-
 		Grid_Clear(u, cell->x, cell->y);
-		cell->u_next = NULL;
-		cell->u_prev = NULL;
 	}
 	
 	return o;
@@ -815,12 +1077,7 @@ void Universe_PasteOrganism(UNIVERSE *u, ORGANISM *o)
 		if( u->current_cell == NULL ) {
 			u->current_cell = cell;
 		}
-		cell->u_next = u->cells;
-		cell->u_prev = NULL;
-		if( u->cells != NULL ) {
-			u->cells->u_prev = cell;
-		}
-		u->cells = cell;
+		Schedule_Insert(u, cell);
 	}
 
 #if 0
@@ -1027,6 +1284,7 @@ void Universe_PasteOrganismCo(UNIVERSE *u, COPIED_ORGANISM *co)
 	u->strop[strain] = co->strop;
 	u->kfmo[strain] = co->kfmo;
 	Universe_update_protections(u, strain, &co->kfops, co->kfmo.protected_codeblocks);
+	EvolveOperations_Specialize(&u->kfops[strain], &u->strop[strain]);
 
 	no = Universe_DuplicateOrganism(o);
 
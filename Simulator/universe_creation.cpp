@@ -395,6 +395,21 @@ STRAIN_PROFILE *NewUniverse_Get_StrainProfile(NEW_UNIVERSE_OPTIONS *nuo, int i)
  *
  */
 UNIVERSE *CreateUniverse(NEW_UNIVERSE_OPTIONS *nuo, char *errbuf)
+{
+	return CreateUniverse_Programs(nuo, NULL, errbuf);
+}
+
+/*
+ * Same as CreateUniverse(), but 'programs[i]' (if 'programs' and
+ * 'programs[i]' are not NULL) is used for strain 'i' instead of reading
+ * and compiling its seed file. This is for callers that create many
+ * universes from the same seeds (evolve_batch tournaments).
+ *
+ * The programs must have been compiled with the strain's kfops, and are
+ * copied.
+ *
+ */
+UNIVERSE *CreateUniverse_Programs(NEW_UNIVERSE_OPTIONS *nuo, KFORTH_PROGRAM **programs, char *errbuf)
 {
 	int i, xpos, ypos;
 	ORGANISM *o[8];
@@ -486,6 +501,16 @@ UNIVERSE *CreateUniverse(NEW_UNIVERSE_OPTIONS *nuo, char *errbuf)
 		xpos = x[posi];
 		ypos = y[posi];
 
+		if( programs != NULL && programs[i] != NULL ) {
+			o[i] = Organism_Make_Program(
+						xpos, ypos,
+						i, sp->energy,
+						sp->kfmo.protected_codeblocks,
+						programs[i] );
+			posi++;
+			continue;
+		}
+
 		fp = fopen(sp->seed_file, "r");
 		if( fp == NULL ) {
 			snprintf(errbuf, 1000, "Strain %d, %s: %s", i, sp->seed_file, strerror(errno));
@@ -584,6 +609,8 @@ UNIVERSE *CreateUniverse(NEW_UNIVERSE_OPTIONS *nuo, char *errbuf)
 		}
 	}
 
+	Universe_Specialize_Operations(u);
+
 	return u;
 }
 
@@ -0,0 +1,474 @@
+/*
+ * Copyright (c) 2022 Ken Stauffer
+ */
+
+/***********************************************************************
+ * UNIVERSE HASH
+ *
+ * A 64-bit hash of everything that gets written to a simulation file:
+ * the universe fields, random number generator, strain settings,
+ * organisms and their programs, the cell schedule, every cell machine
+ * (registers, call stack, data stack), spores and their programs,
+ * organic, barriers and odor.
+ *
+ * Two universes that would write the same simulation file have the
+ * same hash. So a universe that was saved and loaded again hashes the
+ * same as the universe that saved it. Things that are not saved
+ * (ninstructions, totals, phase_timer, barrier_flag, ...) are left out.
+ *
+ * The grid is hashed in parallel with Grid_Reduce(). Each square is
+ * hashed on its own (seeded with its position) and the square hashes
+ * are added together. Addition doesn't care about order, so the result
+ * is the same no matter how the rows were split into bands.
+ *
+ * The organism list and the cell schedule are hashed in order, because
+ * their order is part of the saved state.
+ *
+ * TILE HASHES:
+ * Universe_Tile_Hash_Make() keeps the square hashes apart by tile
+ * (UNIVERSE_TILE_SIZE x UNIVERSE_TILE_SIZE squares), plus one 'state'
+ * hash for everything that isn't on the grid. Two universes with the
+ * same tile hashes only differ inside the tiles whose hashes differ.
+ * These hashes are written as the TILE_HASH trailer of simulation
+ * files (see evolve_io_ascii.cpp), so two files can be compared without
+ * loading them.
+ *
+ */
+#include "evolve_simulator.h"
+#include "evolve_simulator_private.h"
+
+#define HASH_GOLDEN		0x9e3779b97f4a7c15ULL
+
+/*
+ * Finalizer from SplitMix64. Every input bit affects every output bit.
+ */
+static inline uint64_t hash_mix(uint64_t z)
+{
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+/*
+ * Fold the value 'v' into the running hash 'h'.
+ */
+static inline uint64_t hash_add(uint64_t h, uint64_t v)
+{
+	h ^= hash_mix(v + HASH_GOLDEN);
+	h = (h << 27) | (h >> 37);
+	return h * HASH_GOLDEN;
+}
+
+static uint64_t hash_string(uint64_t h, const char *s)
+{
+	ASSERT( s != NULL );
+
+	while( *s != '\0' ) {
+		h = hash_add(h, (unsigned char) *s++);
+	}
+	return hash_add(h, 0);
+}
+
+static uint64_t hash_program(uint64_t h, KFORTH_PROGRAM *kfp)
+{
+	KFORTH_INTEGER *block;
+	int cb, pc, len;
+
+	ASSERT( kfp != NULL );
+
+	h = hash_add(h, kfp->nblocks);
+	h = hash_add(h, kfp->nprotected);
+
+	for(cb=0; cb < kfp->nblocks; cb++) {
+		block = kfp->block[cb];
+		len = block[-1];
+		h = hash_add(h, len);
+		for(pc=0; pc < len; pc++) {
+			h = hash_add(h, (uint16_t) block[pc]);
+		}
+	}
+	return h;
+}
+
+static uint64_t hash_cell(uint64_t h, CELL *c)
+{
+	KFORTH_MACHINE *kfm;
+	int i;
+
+	ASSERT( c != NULL );
+
+	kfm = &c->kfm;
+
+	h = hash_add(h, c->organism->id);
+	h = hash_add(h, (uint16_t) c->mood);
+	h = hash_add(h, (uint16_t) c->message);
+	h = hash_add(h, (uint16_t) kfm->loc.cb);
+	h = hash_add(h, (uint16_t) kfm->loc.pc);
+
+	for(i=0; i < 10; i++) {
+		h = hash_add(h, (uint16_t) kfm->R[i]);
+	}
+
+	h = hash_add(h, kfm->csp);
+	for(i=0; i < kfm->csp; i++) {
+		h = hash_add(h, (uint16_t) kfm->call_stack[i].cb);
+		h = hash_add(h, (uint16_t) kfm->call_stack[i].pc);
+	}
+
+	h = hash_add(h, kfm->dsp);
+	for(i=0; i < kfm->dsp; i++) {
+		h = hash_add(h, (uint16_t) kfm->data_stack[i]);
+	}
+	return h;
+}
+
+static uint64_t hash_spore(uint64_t h, SPORE *spore)
+{
+	ASSERT( spore != NULL );
+
+	h = hash_add(h, spore->energy);
+	h = hash_add(h, spore->strain);
+	h = hash_add(h, spore->sflags);
+	h = hash_add(h, spore->parent);
+	return hash_program(h, &spore->program);
+}
+
+/*
+ * Hash of the square at (x, y). Empty squares hash to 0, so
+ * they don't cost anything to sum.
+ */
+static inline uint64_t hash_square(UNIVERSE *u, int x, int y, UNIVERSE_GRID *ugrid)
+{
+	uint64_t h;
+
+	if( ugrid->type == GT_BLANK && ugrid->odor == 0 )
+		return 0;
+
+	h = hash_add(0, (uint64_t) y * u->width + x);
+	h = hash_add(h, ugrid->type);
+	h = hash_add(h, (uint16_t) ugrid->odor);
+
+	switch( ugrid->type ) {
+	case GT_ORGANIC:
+		h = hash_add(h, ugrid->u.energy);
+		break;
+
+	case GT_CELL:
+		h = hash_cell(h, ugrid->u.cell);
+		break;
+
+	case GT_SPORE:
+		h = hash_spore(h, ugrid->u.spore);
+		break;
+
+	default:
+		break;
+	}
+
+	return hash_mix(h);
+}
+
+static void hash_rows(UNIVERSE *u, int y1, int y2, void *acc, void *arg)
+{
+	UNIVERSE_GRID *ugrid;
+	uint64_t sum;
+	int x, y;
+
+	sum = 0;
+	for(y=y1; y < y2; y++) {
+		ugrid = &u->grid[ y * u->width ];
+		for(x=0; x < u->width; x++, ugrid++) {
+			sum += hash_square(u, x, y, ugrid);
+		}
+	}
+
+	*(uint64_t*)acc += sum;
+}
+
+static void hash_merge(void *acc, void *part, void *arg)
+{
+	*(uint64_t*)acc += *(uint64_t*)part;
+}
+
+/*
+ * 'acc' is an array of tile sums, 'arg' points to the number of tiles across.
+ */
+static void tile_rows(UNIVERSE *u, int y1, int y2, void *acc, void *arg)
+{
+	UNIVERSE_GRID *ugrid;
+	uint64_t *tile;
+	int x, y, ntx;
+
+	tile = (uint64_t *) acc;
+	ntx = *(int *) arg;
+
+	for(y=y1; y < y2; y++) {
+		ugrid = &u->grid[ y * u->width ];
+		for(x=0; x < u->width; x++, ugrid++) {
+			tile[ (y / UNIVERSE_TILE_SIZE) * ntx + (x / UNIVERSE_TILE_SIZE) ] += hash_square(u, x, y, ugrid);
+		}
+	}
+}
+
+static void tile_merge(void *acc, void *part, void *arg)
+{
+	uint64_t *tile, *ptile;
+	int i, ntiles;
+
+	tile = (uint64_t *) acc;
+	ptile = (uint64_t *) part;
+	ntiles = ((int *) arg)[1];
+
+	for(i=0; i < ntiles; i++) {
+		tile[i] += ptile[i];
+	}
+}
+
+static uint64_t hash_strain(uint64_t h, UNIVERSE *u, int strain)
+{
+	STRAIN_OPTIONS *strop;
+	KFORTH_MUTATE_OPTIONS *kfmo;
+	KFORTH_OPERATIONS *kfops;
+	int i;
+
+	strop = &u->strop[strain];
+	h = hash_add(h, strop->enabled);
+	h = hash_string(h, strop->name);
+	h = hash_add(h, strop->look_mode);
+	h = hash_add(h, strop->eat_mode);
+	h = hash_add(h, strop->make_spore_mode);
+	h = hash_add(h, strop->make_spore_energy);
+	h = hash_add(h, strop->cmove_mode);
+	h = hash_add(h, strop->omove_mode);
+	h = hash_add(h, strop->grow_mode);
+	h = hash_add(h, strop->grow_energy);
+	h = hash_add(h, strop->grow_size);
+	h = hash_add(h, strop->rotate_mode);
+	h = hash_add(h, strop->cshift_mode);
+	h = hash_add(h, strop->make_organic_mode);
+	h = hash_add(h, strop->make_barrier_mode);
+	h = hash_add(h, strop->exude_mode);
+	h = hash_add(h, strop->shout_mode);
+	h = hash_add(h, strop->spawn_mode);
+	h = hash_add(h, strop->listen_mode);
+	h = hash_add(h, strop->broadcast_mode);
+	h = hash_add(h, strop->say_mode);
+	h = hash_add(h, strop->send_energy_mode);
+	h = hash_add(h, strop->read_mode);
+	h = hash_add(h, strop->write_mode);
+	h = hash_add(h, strop->key_press_mode);
+	h = hash_add(h, strop->send_mode);
+
+	kfmo = &u->kfmo[strain];
+	h = hash_add(h, kfmo->prob_mutate_codeblock);
+	h = hash_add(h, kfmo->prob_duplicate);
+	h = hash_add(h, kfmo->prob_delete);
+	h = hash_add(h, kfmo->prob_insert);
+	h = hash_add(h, kfmo->prob_transpose);
+	h = hash_add(h, kfmo->prob_modify);
+	h = hash_add(h, kfmo->max_code_blocks);
+	h = hash_add(h, kfmo->max_apply);
+	h = hash_add(h, kfmo->merge_mode);
+	h = hash_add(h, kfmo->xlen);
+	h = hash_add(h, kfmo->protected_codeblocks);
+
+	kfops = &u->kfops[strain];
+	h = hash_add(h, kfops->count);
+	h = hash_add(h, kfops->nprotected);
+	for(i=0; i < kfops->count; i++) {
+		h = hash_string(h, kfops->table[i].name);
+	}
+
+	h = hash_add(h, (uint16_t) u->S0[strain]);
+	return h;
+}
+
+/*
+ * Hash everything that isn't stored in a grid square.
+ */
+static uint64_t hash_state(UNIVERSE *u)
+{
+	uint64_t h;
+	ORGANISM *o;
+	CELL *c;
+	int i;
+
+	ASSERT( u != NULL );
+
+	h = hash_add(0, u->width);
+	h = hash_add(h, u->height);
+	h = hash_add(h, u->seed);
+	h = hash_add(h, u->step);
+	h = hash_add(h, u->age);
+	h = hash_add(h, u->next_id);
+	h = hash_add(h, u->norganism);
+	h = hash_add(h, u->nborn);
+	h = hash_add(h, u->ndie);
+	h = hash_add(h, (uint16_t) u->G0);
+	h = hash_add(h, u->key);
+	h = hash_add(h, u->mouse_x);
+	h = hash_add(h, u->mouse_y);
+	h = hash_add(h, u->so.mode);
+
+	h = hash_add(h, u->er.fidx);
+	h = hash_add(h, u->er.ridx);
+	for(i=0; i < EVOLVE_DEG4; i++) {
+		h = hash_add(h, u->er.state[i]);
+	}
+
+	for(i=0; i < EVOLVE_MAX_STRAINS; i++) {
+		h = hash_add(h, u->strpop[i]);
+		h = hash_strain(h, u, i);
+	}
+
+	if( u->current_cell != NULL ) {
+		h = hash_add(h, u->current_cell->x);
+		h = hash_add(h, u->current_cell->y);
+	}
+
+	for(o=u->organisms; o != NULL; o=o->next) {
+		h = hash_add(h, o->id);
+		h = hash_add(h, o->parent1);
+		h = hash_add(h, o->parent2);
+		h = hash_add(h, o->generation);
+		h = hash_add(h, o->energy);
+		h = hash_add(h, o->age);
+		h = hash_add(h, o->strain);
+		h = hash_add(h, o->oflags);
+		h = hash_add(h, o->sim_count);
+		h = hash_add(h, o->ncells);
+		h = hash_program(h, &o->program);
+
+		for(c=o->cells; c != NULL; c=c->next) {
+			h = hash_add(h, c->x);
+			h = hash_add(h, c->y);
+		}
+	}
+
+	/*
+	 * The schedule runs from the last slot down to slot 0,
+	 * skip the tombstones (they are not saved).
+	 */
+	for(i=u->sched.len-1; i >= 0; i--) {
+		c = u->sched.slot[i];
+		if( c != NULL ) {
+			h = hash_add(h, c->x);
+			h = hash_add(h, c->y);
+		}
+	}
+
+	return h;
+}
+
+/***********************************************************************
+ * Compute the hash of 'u'.
+ *
+ */
+uint64_t Universe_Hash(UNIVERSE *u)
+{
+	uint64_t h, grid_sum;
+
+	ASSERT( u != NULL );
+
+	h = hash_state(u);
+
+	grid_sum = 0;
+	Grid_Reduce(u, hash_rows, hash_merge, &grid_sum, sizeof(grid_sum), NULL);
+
+	h = hash_add(h, grid_sum);
+
+	return hash_mix(h);
+}
+
+/***********************************************************************
+ * Allocate an empty tile hash with 'ntx' x 'nty' tiles.
+ *
+ */
+UNIVERSE_TILE_HASH *Universe_Tile_Hash_Alloc(int ntx, int nty)
+{
+	UNIVERSE_TILE_HASH *th;
+
+	ASSERT( ntx > 0 );
+	ASSERT( nty > 0 );
+
+	th = (UNIVERSE_TILE_HASH *) CALLOC(1, sizeof(UNIVERSE_TILE_HASH));
+	ASSERT( th != NULL );
+
+	th->tile_size = UNIVERSE_TILE_SIZE;
+	th->ntx = ntx;
+	th->nty = nty;
+
+	th->tile = (uint64_t *) CALLOC(th->ntx * th->nty, sizeof(uint64_t));
+	ASSERT( th->tile != NULL );
+
+	return th;
+}
+
+/***********************************************************************
+ * Compute the tile hashes of 'u'.
+ *
+ */
+UNIVERSE_TILE_HASH *Universe_Tile_Hash_Make(UNIVERSE *u)
+{
+	UNIVERSE_TILE_HASH *th;
+	int arg[2];
+
+	ASSERT( u != NULL );
+
+	th = Universe_Tile_Hash_Alloc((u->width + UNIVERSE_TILE_SIZE - 1) / UNIVERSE_TILE_SIZE,
+									(u->height + UNIVERSE_TILE_SIZE - 1) / UNIVERSE_TILE_SIZE);
+
+	th->state = hash_mix(hash_state(u));
+
+	arg[0] = th->ntx;
+	arg[1] = th->ntx * th->nty;
+	Grid_Reduce(u, tile_rows, tile_merge, th->tile, arg[1] * sizeof(uint64_t), arg);
+
+	return th;
+}
+
+void Universe_Tile_Hash_Delete(UNIVERSE_TILE_HASH *th)
+{
+	ASSERT( th != NULL );
+
+	FREE(th->tile);
+	FREE(th);
+}
+
+/***********************************************************************
+ * Compare two tile hashes. Returns 0 if they can't be compared (different
+ * dimensions). Otherwise 'diff[i]' is set to 1 for every tile that differs
+ * ('diff' can be NULL), '*ndiff' to the number of those tiles and
+ * '*state_diff' to 1 if the non-grid state differs.
+ *
+ */
+int Universe_Tile_Hash_Compare(UNIVERSE_TILE_HASH *th1, UNIVERSE_TILE_HASH *th2,
+								char *diff, int *ndiff, int *state_diff)
+{
+	int i, n;
+
+	ASSERT( th1 != NULL );
+	ASSERT( th2 != NULL );
+	ASSERT( ndiff != NULL );
+	ASSERT( state_diff != NULL );
+
+	if( th1->tile_size != th2->tile_size || th1->ntx != th2->ntx || th1->nty != th2->nty )
+		return 0;
+
+	n = 0;
+	for(i=0; i < th1->ntx * th1->nty; i++) {
+		if( th1->tile[i] != th2->tile[i] ) {
+			n++;
+			if( diff != NULL )
+				diff[i] = 1;
+		} else {
+			if( diff != NULL )
+				diff[i] = 0;
+		}
+	}
+
+	*ndiff = n;
+	*state_diff = (th1->state != th2->state);
+
+	return 1;
+}